@@ -0,0 +1,620 @@
+/*
+ * Copyright (c) 2022 Felix Gohla, Konrad Hanff, Tobias Kantusch,
+ *                    Quentin Kuth, Felix Roth. All rights reserved.
+ *
+ * Use of this source code is governed by a BSD-style
+ * license that can be found in the LICENSE file.
+ */
+
+/*
+ * Host benchmarks of the hot paths of the library against a simulated authenticator.
+ *
+ * Usage: microfido2_bench [iterations] [name filter]
+ *
+ * The results are printed as JSON to stdout. For every benchmark, the time per operation,
+ * the throughput and the number of heap allocations during all iterations are reported.
+ * For the stateless RP flow, the time the simulated NFC link would take at the different
+ * data rates is reported as well.
+ *
+ * If the library is built with tracing, one stateless RP assertion with many large-blob entries
+ * is traced afterwards and written to bench_trace.json in the Chrome trace event format.
+ */
+
+#include "bench_data.h"
+
+#include <fido.h>
+#include <simulator.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define BENCH_DEFAULT_ITERATIONS 1000
+#define BENCH_DATA_SIZE          1024
+#define BENCH_LARGE_BLOB_SIZE    8192
+#define BENCH_MANY_ENTRIES       32
+#define BENCH_SIGN_COUNT_CREDENTIALS 256
+#define BENCH_SIGN_COUNT_PAGE_SIZE   8192
+
+// Throughput is measured by the bytes transferred to and from the simulated authenticator.
+#define BENCH_TRAFFIC SIZE_MAX
+
+static const char bench_rp_id[] = "example.com";
+
+/*
+ * Allocation counting. The benchmark is linked with -Wl,--wrap=malloc etc., so that every
+ * allocation of the library, the crypto backends and the benchmark itself passes through here.
+ */
+
+static size_t bench_allocations = 0;
+
+void *__real_malloc(size_t size);
+void *__real_calloc(size_t count, size_t size);
+void *__real_realloc(void *ptr, size_t size);
+
+void *__wrap_malloc(size_t size) {
+    bench_allocations++;
+    return __real_malloc(size);
+}
+
+void *__wrap_calloc(size_t count, size_t size) {
+    bench_allocations++;
+    return __real_calloc(count, size);
+}
+
+void *__wrap_realloc(void *ptr, size_t size) {
+    bench_allocations++;
+    return __real_realloc(ptr, size);
+}
+
+
+/*
+ * Benchmark state and operations.
+ */
+
+typedef struct bench_ctx {
+    fido_sim_t sim;
+    uint8_t large_blob[BENCH_LARGE_BLOB_SIZE];
+    uint8_t largeblob_prefetch[BENCH_LARGE_BLOB_SIZE];
+    uint8_t stateless_rp_blob[FIDO_SIM_KEY_SIZE + 64];
+    fido_dev_t dev;
+    fido_assert_t assert;
+    fido_assert_request_t assert_request;
+    uint8_t assert_request_buffer[256];
+    uint8_t client_data_hash[ASSERTION_CLIENT_DATA_HASH_LEN];
+    uint8_t blob_buffer[1024];
+    uint8_t window[1024];
+    uint8_t inflated[BENCH_INFLATE_UNCOMPRESSED_LEN];
+    uint8_t data[BENCH_DATA_SIZE];
+    uint8_t ciphertext[BENCH_DATA_SIZE];
+    uint8_t tag[AES_GCM_TAG_SIZE];
+    uint8_t iv[LARGEBLOB_NONCE_SIZE];
+    uint8_t hash[64];
+    uint8_t signature[64];
+#ifndef FIDO_NO_VERIFY_CACHE
+    fido_verify_cache_t verify_cache;
+#endif
+#if !defined(FIDO_NO_RP_REGISTRY) && !defined(FIDO_NO_ASSERT_VERIFY)
+    fido_rp_registry_t rp_registry;
+    fido_rp_t rps[BENCH_MANY_ENTRIES];
+    uint16_t rp_slots[2 * BENCH_MANY_ENTRIES];
+    char rp_ids[BENCH_MANY_ENTRIES][16];
+#endif
+#ifndef FIDO_NO_SIGN_COUNT
+    uint8_t sign_count_flash_pages[2 * BENCH_SIGN_COUNT_PAGE_SIZE];
+    fido_sign_count_flash_t sign_count_flash;
+    fido_sign_count_store_t sign_count_store;
+    fido_sign_count_entry_t sign_count_entries[BENCH_SIGN_COUNT_CREDENTIALS];
+    uint16_t sign_count_slots[2 * BENCH_SIGN_COUNT_CREDENTIALS];
+    uint32_t sign_count;
+#endif
+} bench_ctx_t;
+
+typedef int (*bench_fn_t)(bench_ctx_t *ctx);
+
+typedef struct bench {
+    const char *name;
+    bench_fn_t setup; // Optional, called once before the benchmark.
+    bench_fn_t fn;
+    size_t bytes;     // Bytes processed per operation, BENCH_TRAFFIC or 0 if throughput is meaningless.
+} bench_t;
+
+static void bench_prepare_assert(bench_ctx_t *ctx) {
+    fido_assert_ext_t extensions = FIDO_ASSERT_EXTENSION_LARGE_BLOB_KEY;
+    if (fido_dev_supports_cred_blob(&ctx->dev, sizeof(ctx->stateless_rp_blob))) {
+        extensions |= FIDO_ASSERT_EXTENSION_CRED_BLOB;
+    }
+    fido_assert_reset(&ctx->assert);
+    fido_assert_set_rp(&ctx->assert, bench_rp_id);
+    fido_assert_set_extensions(&ctx->assert, extensions);
+    fido_assert_set_client_data_hash(&ctx->assert, ctx->client_data_hash);
+}
+
+static int bench_discard(const uint8_t *data, size_t data_len, void *ctx) {
+    return FIDO_OK;
+}
+
+static int bench_single_entry(bench_ctx_t *ctx) {
+    return fido_sim_set_large_blobs(&ctx->sim, 1, 0, ctx->stateless_rp_blob, sizeof(ctx->stateless_rp_blob));
+}
+
+static int bench_many_entries(bench_ctx_t *ctx) {
+    // The entry of the credential comes last, so that all entries have to be tried.
+    return fido_sim_set_large_blobs(&ctx->sim, BENCH_MANY_ENTRIES, BENCH_MANY_ENTRIES - 1, ctx->stateless_rp_blob, sizeof(ctx->stateless_rp_blob));
+}
+
+static int bench_get_info(bench_ctx_t *ctx) {
+    int r;
+    if ((r = fido_dev_open(&ctx->dev)) != FIDO_OK) {
+        return r;
+    }
+    return fido_dev_close(&ctx->dev);
+}
+
+static int bench_get_assert(bench_ctx_t *ctx) {
+    bench_prepare_assert(ctx);
+    return fido_dev_get_assert(&ctx->dev, &ctx->assert);
+}
+
+static int bench_prepare_assert_request(bench_ctx_t *ctx) {
+    bench_prepare_assert(ctx);
+    return fido_assert_prepare_request(&ctx->assert_request, &ctx->assert, ctx->assert_request_buffer, sizeof(ctx->assert_request_buffer));
+}
+
+static int bench_get_assert_request(bench_ctx_t *ctx) {
+    // The client data hash would change for every tap.
+    fido_assert_set_client_data_hash(&ctx->assert, ctx->client_data_hash);
+    return fido_dev_get_assert_request(&ctx->dev, &ctx->assert, &ctx->assert_request);
+}
+
+static int bench_assert_verify(bench_ctx_t *ctx) {
+    return fido_assert_verify(&ctx->assert, COSE_ALGORITHM_EdDSA, ctx->sim.credential.public_key);
+}
+
+#if !defined(FIDO_NO_RP_REGISTRY) && !defined(FIDO_NO_ASSERT_VERIFY)
+static int bench_rp_registry(bench_ctx_t *ctx) {
+    // The RP of the assertion among others, which all trust the key of the credential.
+    int r = fido_rp_registry_init(&ctx->rp_registry, ctx->rps, BENCH_MANY_ENTRIES, ctx->rp_slots, 2 * BENCH_MANY_ENTRIES);
+    if (r != FIDO_OK) {
+        return r;
+    }
+    for (size_t i = 0; i < BENCH_MANY_ENTRIES; i++) {
+        if (i == 0) {
+            strcpy(ctx->rp_ids[i], bench_rp_id);
+        } else {
+            snprintf(ctx->rp_ids[i], sizeof(ctx->rp_ids[i]), "rp%zu.example", i);
+        }
+        if (fido_rp_registry_add(&ctx->rp_registry, ctx->rp_ids[i], COSE_ALGORITHM_EdDSA, ctx->sim.credential.public_key, 1) == NULL) {
+            return FIDO_ERR_INTERNAL;
+        }
+    }
+    return FIDO_OK;
+}
+
+static int bench_assert_verify_rp_registry(bench_ctx_t *ctx) {
+    return fido_assert_verify_rp_registry(&ctx->assert, &ctx->rp_registry, NULL);
+}
+#endif
+
+static int bench_largeblob_get(bench_ctx_t *ctx) {
+    fido_blob_t blob;
+    fido_blob_reset(&blob, ctx->blob_buffer, sizeof(ctx->blob_buffer));
+    return fido_dev_largeblob_get(&ctx->dev, ctx->sim.credential.large_blob_key, LARGEBLOB_KEY_SIZE, &blob);
+}
+
+static int bench_largeblob_get_stream(bench_ctx_t *ctx) {
+    return fido_dev_largeblob_get_stream(
+        &ctx->dev, ctx->sim.credential.large_blob_key, LARGEBLOB_KEY_SIZE,
+        ctx->window, sizeof(ctx->window), bench_discard, NULL
+    );
+}
+
+static int bench_stateless_assert(bench_ctx_t *ctx) {
+    int r;
+    fido_blob_t blob;
+    const uint8_t *stateless_rp_blob;
+
+    if ((r = fido_dev_open(&ctx->dev)) != FIDO_OK) {
+        return r;
+    }
+    bench_prepare_assert(ctx);
+    if ((r = fido_dev_get_assert(&ctx->dev, &ctx->assert)) != FIDO_OK) {
+        return r;
+    }
+    if (fido_assert_cred_blob_len(&ctx->assert) == sizeof(ctx->stateless_rp_blob)) {
+        stateless_rp_blob = fido_assert_cred_blob_ptr(&ctx->assert);
+    } else {
+        fido_blob_reset(&blob, ctx->blob_buffer, sizeof(ctx->blob_buffer));
+        if ((r = fido_dev_largeblob_get(&ctx->dev, ctx->assert.reply.large_blob_key, LARGEBLOB_KEY_SIZE, &blob)) != FIDO_OK) {
+            return r;
+        }
+        stateless_rp_blob = blob.buffer;
+    }
+    if (fido_dev_ed25519_verify(&ctx->dev, stateless_rp_blob + 32, ctx->sim.updater_public_key, stateless_rp_blob, 32) != 0) {
+        return FIDO_ERR_INVALID_SIG;
+    }
+    if ((r = fido_assert_verify(&ctx->assert, COSE_ALGORITHM_EdDSA, stateless_rp_blob)) != FIDO_OK) {
+        return r;
+    }
+    return fido_dev_close(&ctx->dev);
+}
+
+static int bench_stateless_assert_cred_blob(bench_ctx_t *ctx) {
+    // The simulated authenticator supports credBlob only for this benchmark, so the blob comes with the assertion.
+    ctx->sim.config.max_cred_blob = FIDO_SIM_MAX_CRED_BLOB_LEN;
+    int r = bench_stateless_assert(ctx);
+    ctx->sim.config.max_cred_blob = 0;
+    // Without the blob in the reply, the large blob would have been read instead.
+    if (r == FIDO_OK && fido_assert_cred_blob_len(&ctx->assert) != sizeof(ctx->stateless_rp_blob)) {
+        return FIDO_ERR_UNSUPPORTED_EXTENSION;
+    }
+    return r;
+}
+
+static int bench_stateless_assert_prefetch(bench_ctx_t *ctx) {
+    // The large-blob array is read before the assertion and decrypted from the prefetch buffer.
+    fido_dev_set_largeblob_prefetch(&ctx->dev, ctx->largeblob_prefetch, sizeof(ctx->largeblob_prefetch));
+    int r = bench_stateless_assert(ctx);
+    fido_dev_set_largeblob_prefetch(&ctx->dev, NULL, 0);
+    return r;
+}
+
+#ifndef FIDO_NO_VERIFY_CACHE
+static int bench_verify_cache(bench_ctx_t *ctx) {
+    fido_verify_cache_init(&ctx->verify_cache, NULL, NULL, NULL);
+    return bench_single_entry(ctx);
+}
+
+static int bench_stateless_assert_cached(bench_ctx_t *ctx) {
+    // Only the first iteration verifies the signature of the updater, the others hit the cache.
+    fido_dev_set_verify_cache(&ctx->dev, &ctx->verify_cache);
+    int r = bench_stateless_assert(ctx);
+    fido_dev_set_verify_cache(&ctx->dev, NULL);
+    return r;
+}
+#endif
+
+static int bench_inflate(bench_ctx_t *ctx) {
+    fido_inflate_t inflate;
+    int r;
+    fido_inflate_init(&inflate, ctx->inflated, sizeof(ctx->inflated), NULL, NULL);
+    if ((r = fido_inflate(&inflate, bench_inflate_compressed, sizeof(bench_inflate_compressed))) != FIDO_OK) {
+        return r;
+    }
+    return inflate.total_out == BENCH_INFLATE_UNCOMPRESSED_LEN ? FIDO_OK : FIDO_ERR_DECOMPRESS;
+}
+
+#ifndef FIDO_NO_SIGN_COUNT
+// Flash in RAM, which programs bits to 0 like NOR flash.
+static int bench_flash_read(void *ctx, size_t address, uint8_t *data, size_t len) {
+    memcpy(data, ((bench_ctx_t *)ctx)->sign_count_flash_pages + address, len);
+    return 0;
+}
+
+static int bench_flash_write(void *ctx, size_t address, const uint8_t *data, size_t len) {
+    uint8_t *flash = ((bench_ctx_t *)ctx)->sign_count_flash_pages + address;
+    for (size_t i = 0; i < len; i++) {
+        flash[i] &= data[i];
+    }
+    return 0;
+}
+
+static int bench_flash_erase(void *ctx, size_t address) {
+    memset(((bench_ctx_t *)ctx)->sign_count_flash_pages + address, 0xff, BENCH_SIGN_COUNT_PAGE_SIZE);
+    return 0;
+}
+
+static int bench_sign_count_store(bench_ctx_t *ctx) {
+    int r;
+    ctx->sign_count_flash = (fido_sign_count_flash_t) {
+        bench_flash_read, bench_flash_write, bench_flash_erase, ctx, BENCH_SIGN_COUNT_PAGE_SIZE, 2
+    };
+    memset(ctx->sign_count_flash_pages, 0xff, sizeof(ctx->sign_count_flash_pages));
+    if ((r = fido_sign_count_store_init(
+        &ctx->sign_count_store, &ctx->sign_count_flash, ctx->sign_count_entries, BENCH_SIGN_COUNT_CREDENTIALS,
+        ctx->sign_count_slots, 2 * BENCH_SIGN_COUNT_CREDENTIALS
+    )) != FIDO_OK) {
+        return r;
+    }
+    // Enroll all credentials, the benchmark then updates them in turn.
+    ctx->sign_count = 1;
+    for (uint16_t i = 0; i < BENCH_SIGN_COUNT_CREDENTIALS; i++) {
+        if ((r = fido_sign_count_store_update(&ctx->sign_count_store, (const uint8_t *)&i, sizeof(i), ctx->sign_count)) != FIDO_OK) {
+            return r;
+        }
+    }
+    return FIDO_OK;
+}
+
+static int bench_sign_count_update(bench_ctx_t *ctx) {
+    // Includes the compactions, one every (page size / 16 - credentials) updates.
+    const uint16_t credential = ctx->sign_count % BENCH_SIGN_COUNT_CREDENTIALS;
+    return fido_sign_count_store_update(&ctx->sign_count_store, (const uint8_t *)&credential, sizeof(credential), ++ctx->sign_count);
+}
+#endif
+
+static int bench_sha256(bench_ctx_t *ctx) {
+    fido_sha256(ctx->data, sizeof(ctx->data), ctx->hash);
+    return FIDO_OK;
+}
+
+static int bench_client_data_json(bench_ctx_t *ctx) {
+    return fido_assert_set_client_data_json(&ctx->assert, ctx->data, 32, "https://example.com", false);
+}
+
+static int bench_sha512(bench_ctx_t *ctx) {
+    fido_sha512(ctx->data, sizeof(ctx->data), ctx->hash);
+    return FIDO_OK;
+}
+
+static int bench_aes_gcm_encrypt(bench_ctx_t *ctx) {
+    return fido_aes_gcm_encrypt(
+        ctx->sim.credential.large_blob_key, LARGEBLOB_KEY_SIZE,
+        ctx->iv, sizeof(ctx->iv),
+        ctx->data, sizeof(ctx->data),
+        NULL, 0,
+        ctx->ciphertext, ctx->tag
+    ) == 0 ? FIDO_OK : FIDO_ERR_INTERNAL;
+}
+
+static int bench_aes_gcm_decrypt(bench_ctx_t *ctx) {
+    return fido_aes_gcm_decrypt(
+        ctx->sim.credential.large_blob_key, LARGEBLOB_KEY_SIZE,
+        ctx->iv, sizeof(ctx->iv),
+        ctx->ciphertext, sizeof(ctx->ciphertext),
+        NULL, 0,
+        ctx->tag,
+        ctx->data
+    ) == 0 ? FIDO_OK : FIDO_ERR_INVALID_SIG;
+}
+
+static int bench_ed25519_sign(bench_ctx_t *ctx) {
+    fido_ed25519_sign(ctx->signature, ctx->sim.credential.secret_key, ctx->data, 32);
+    return FIDO_OK;
+}
+
+static int bench_ed25519_verify(bench_ctx_t *ctx) {
+    return fido_ed25519_verify(ctx->stateless_rp_blob + 32, ctx->sim.updater_public_key, ctx->stateless_rp_blob, 32) == 0
+        ? FIDO_OK : FIDO_ERR_INVALID_SIG;
+}
+
+static int bench_es256_verify(bench_ctx_t *ctx) {
+    return fido_es256_verify(bench_es256_signature, bench_es256_public_key, bench_es256_hash) == 0
+        ? FIDO_OK : FIDO_ERR_INVALID_SIG;
+}
+
+/*
+ * Runner.
+ */
+
+static uint64_t bench_now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+static int bench_run(bench_ctx_t *ctx, const bench_t *bench, size_t iterations, bool first) {
+    int r;
+
+    if (bench->setup != NULL && (r = bench->setup(ctx)) != FIDO_OK) {
+        fprintf(stderr, "%s setup failed: %d\n", bench->name, r);
+        return r;
+    }
+
+    // Warm up and check that the operation works at all, a failing operation is not worth timing.
+    if ((r = bench->fn(ctx)) != FIDO_OK) {
+        fprintf(stderr, "%s failed: %d\n", bench->name, r);
+        return r;
+    }
+
+    fido_sim_reset_clock(&ctx->sim);
+    bench_allocations = 0;
+    uint64_t start = bench_now_ns();
+    for (size_t i = 0; i < iterations; i++) {
+        if ((r = bench->fn(ctx)) != FIDO_OK) {
+            fprintf(stderr, "%s failed in iteration %zu: %d\n", bench->name, i, r);
+            return r;
+        }
+    }
+    uint64_t elapsed = bench_now_ns() - start;
+    size_t allocations = bench_allocations;
+
+    double ns_per_op = (double)elapsed / (double)iterations;
+    double bytes = bench->bytes == BENCH_TRAFFIC
+        ? (double)(ctx->sim.stats.bytes_in + ctx->sim.stats.bytes_out) / (double)iterations
+        : (double)bench->bytes;
+    double bytes_per_s = elapsed > 0 ? bytes * 1e9 / ns_per_op : 0.0;
+
+    printf(
+        "%s    {\"name\": \"%s\", \"iterations\": %zu, \"ns_per_op\": %.1f, \"bytes_per_s\": %.0f, \"allocations\": %zu}",
+        first ? "" : ",\n", bench->name, iterations, ns_per_op, bytes_per_s, allocations
+    );
+    return FIDO_OK;
+}
+
+/**
+ * @brief Report the time a stateless RP assertion spends on the simulated link at the different data rates.
+ *        The CPU time of the library comes on top, see the stateless_assert benchmarks.
+ */
+static int bench_links(bench_ctx_t *ctx) {
+    static const uint32_t rates[] = { FIDO_SIM_LINK_106K, FIDO_SIM_LINK_212K, FIDO_SIM_LINK_424K, FIDO_SIM_LINK_848K };
+    static const bench_fn_t setups[] = { bench_single_entry, bench_many_entries };
+    static const unsigned entries[] = { 1, BENCH_MANY_ENTRIES };
+    uint32_t link_kbps = ctx->sim.config.link_kbps;
+    bool first = true;
+    int r;
+
+    printf("  \"links\": [\n");
+    for (size_t s = 0; s < sizeof(setups) / sizeof(setups[0]); s++) {
+        if ((r = setups[s](ctx)) != FIDO_OK) {
+            return r;
+        }
+        for (size_t i = 0; i < sizeof(rates) / sizeof(rates[0]); i++) {
+            ctx->sim.config.link_kbps = rates[i];
+            fido_sim_reset_clock(&ctx->sim);
+            if ((r = bench_stateless_assert(ctx)) != FIDO_OK) {
+                fprintf(stderr, "stateless_assert at %u kbit/s failed: %d\n", rates[i], r);
+                return r;
+            }
+            printf(
+                "%s    {\"link_kbps\": %u, \"large_blob_entries\": %u, \"link_ns\": %llu, \"apdus\": %zu, \"frames\": %zu, \"bytes_in\": %zu, \"bytes_out\": %zu}",
+                first ? "" : ",\n", rates[i], entries[s], (unsigned long long)ctx->sim.clock_ns,
+                ctx->sim.stats.apdus, ctx->sim.stats.frames, ctx->sim.stats.bytes_in, ctx->sim.stats.bytes_out
+            );
+            first = false;
+        }
+    }
+    printf("\n  ]\n");
+
+    ctx->sim.config.link_kbps = link_kbps;
+    return FIDO_OK;
+}
+
+#ifdef FIDO_TRACING
+static uint64_t bench_trace_clock(void) {
+    return bench_now_ns();
+}
+
+static int bench_trace_write(const char *data, size_t data_len, void *ctx) {
+    return fwrite(data, 1, data_len, (FILE *)ctx) == data_len ? FIDO_OK : FIDO_ERR_INTERNAL;
+}
+
+/**
+ * @brief Trace a stateless RP assertion with many large-blob entries and export it to bench_trace.json.
+ */
+static int bench_trace(bench_ctx_t *ctx) {
+    FILE *file;
+    int r;
+
+    if ((r = bench_many_entries(ctx)) != FIDO_OK) {
+        return r;
+    }
+
+    // Only this run is traced, the clock is not set during the timed benchmarks.
+    fido_trace_reset();
+    fido_trace_set_clock(bench_trace_clock, 1000);
+    r = bench_stateless_assert(ctx);
+    fido_trace_set_clock(NULL, 0);
+    if (r != FIDO_OK) {
+        return r;
+    }
+
+    if ((file = fopen("bench_trace.json", "w")) == NULL) {
+        return FIDO_ERR_INTERNAL;
+    }
+    r = fido_trace_export_chrome(bench_trace_write, file);
+    if (fclose(file) != 0 && r == FIDO_OK) {
+        r = FIDO_ERR_INTERNAL;
+    }
+    return r;
+}
+#endif
+
+int main(int argc, char **argv) {
+    static bench_ctx_t ctx;
+    size_t iterations = BENCH_DEFAULT_ITERATIONS;
+    const char *filter = argc > 2 ? argv[2] : NULL;
+    fido_sim_config_t config;
+    int r;
+
+    if (argc > 1 && (iterations = strtoul(argv[1], NULL, 10)) == 0) {
+        fprintf(stderr, "usage: %s [iterations] [name filter]\n", argv[0]);
+        return 1;
+    }
+
+    memset(ctx.client_data_hash, 42, sizeof(ctx.client_data_hash));
+    for (size_t i = 0; i < sizeof(ctx.data); i++) {
+        ctx.data[i] = (uint8_t)i;
+    }
+
+    fido_sim_config_default(&config);
+    config.max_large_blob = sizeof(ctx.large_blob);
+    if (
+        (r = fido_sim_init(&ctx.sim, &config, NULL, ctx.large_blob, sizeof(ctx.large_blob))) != FIDO_OK ||
+        (r = fido_sim_prepare_device(&ctx.sim, &ctx.dev)) != FIDO_OK
+    ) {
+        fprintf(stderr, "cannot prepare the simulated authenticator: %d\n", r);
+        return 1;
+    }
+    fido_sim_stateless_rp_blob(&ctx.sim, ctx.stateless_rp_blob);
+    fido_sim_set_cred_blob(&ctx.sim, ctx.stateless_rp_blob, sizeof(ctx.stateless_rp_blob));
+
+    // The device stays open for the benchmarks of single commands. assert_verify needs an assertion.
+    if (
+        (r = bench_single_entry(&ctx)) != FIDO_OK ||
+        (r = fido_dev_open(&ctx.dev)) != FIDO_OK ||
+        (r = bench_get_assert(&ctx)) != FIDO_OK
+    ) {
+        fprintf(stderr, "cannot set up the simulated authenticator: %d\n", r);
+        return 1;
+    }
+    if (fido_aes_gcm_encrypt != NULL && bench_aes_gcm_encrypt(&ctx) != FIDO_OK) {
+        fprintf(stderr, "cannot encrypt the data for aes_gcm_decrypt\n");
+        return 1;
+    }
+
+    const bench_t benches[] = {
+        // Commands against the simulated authenticator, including the transport.
+        { "get_assert",             NULL,               bench_get_assert,           BENCH_TRAFFIC },
+        { "get_assert_request",     bench_prepare_assert_request, bench_get_assert_request, BENCH_TRAFFIC },
+        { "assert_verify",          NULL,               bench_assert_verify,        0 },
+#if !defined(FIDO_NO_RP_REGISTRY) && !defined(FIDO_NO_ASSERT_VERIFY)
+        { "assert_verify_rp_registry", bench_rp_registry, bench_assert_verify_rp_registry, 0 },
+#endif
+        { "largeblob_get",          bench_single_entry, bench_largeblob_get,        BENCH_TRAFFIC },
+        { "largeblob_get_stream",   bench_single_entry, bench_largeblob_get_stream, BENCH_TRAFFIC },
+        { "largeblob_get_32",       bench_many_entries, bench_largeblob_get,        BENCH_TRAFFIC },
+        // These open and close the device.
+        { "get_info",               NULL,               bench_get_info,             BENCH_TRAFFIC },
+        { "stateless_assert",       bench_single_entry, bench_stateless_assert,     BENCH_TRAFFIC },
+        { "stateless_assert_32",    bench_many_entries, bench_stateless_assert,     BENCH_TRAFFIC },
+        { "stateless_assert_cred_blob", NULL,           bench_stateless_assert_cred_blob, BENCH_TRAFFIC },
+        { "stateless_assert_prefetch",  bench_single_entry, bench_stateless_assert_prefetch, BENCH_TRAFFIC },
+#ifndef FIDO_NO_VERIFY_CACHE
+        { "stateless_assert_cached", bench_verify_cache, bench_stateless_assert_cached, BENCH_TRAFFIC },
+#endif
+#ifndef FIDO_NO_SIGN_COUNT
+        { "sign_count_update_256",  bench_sign_count_store, bench_sign_count_update, 0 },
+#endif
+        // Primitives.
+        { "inflate",                NULL, bench_inflate,                                        BENCH_INFLATE_UNCOMPRESSED_LEN },
+        { "sha256",                 NULL, fido_sha256 ? bench_sha256 : NULL,                   BENCH_DATA_SIZE },
+        { "client_data_json",       NULL, fido_sha256_init ? bench_client_data_json : NULL,    0 },
+        { "sha512",                 NULL, fido_sha512 ? bench_sha512 : NULL,                   BENCH_DATA_SIZE },
+        { "aes_gcm_encrypt",        NULL, fido_aes_gcm_encrypt ? bench_aes_gcm_encrypt : NULL, BENCH_DATA_SIZE },
+        // Decrypts what was encrypted during the setup.
+        { "aes_gcm_decrypt",        NULL, fido_aes_gcm_encrypt && fido_aes_gcm_decrypt ? bench_aes_gcm_decrypt : NULL, BENCH_DATA_SIZE },
+        { "ed25519_sign",           NULL, fido_ed25519_sign ? bench_ed25519_sign : NULL,       32 },
+        { "ed25519_verify",         NULL, fido_ed25519_verify ? bench_ed25519_verify : NULL,   32 },
+        { "es256_verify",           NULL, fido_es256_verify ? bench_es256_verify : NULL,       32 },
+    };
+
+    bool first = true;
+    printf("{\n  \"iterations\": %zu,\n  \"benchmarks\": [\n", iterations);
+    for (size_t i = 0; i < sizeof(benches) / sizeof(benches[0]); i++) {
+        const bench_t *bench = &benches[i];
+        // Benchmarks of hooks without an implementation are skipped.
+        if (bench->fn == NULL || (filter != NULL && strstr(bench->name, filter) == NULL)) {
+            continue;
+        }
+        if (bench_run(&ctx, bench, iterations, first) != FIDO_OK) {
+            return 1;
+        }
+        first = false;
+    }
+    printf("\n  ],\n");
+    if (bench_links(&ctx) != FIDO_OK) {
+        return 1;
+    }
+    printf("}\n");
+
+#ifdef FIDO_TRACING
+    if ((r = bench_trace(&ctx)) != FIDO_OK) {
+        fprintf(stderr, "cannot write bench_trace.json: %d\n", r);
+        return 1;
+    }
+#endif
+
+    return 0;
+}
@@ -0,0 +1,11 @@
+// Generated by gen_bench_data.py, do not edit.
+#pragma once
+
+#include <stdint.h>
+
+#define BENCH_INFLATE_UNCOMPRESSED_LEN 4096
+static const uint8_t bench_inflate_compressed[] = { 0x8d, 0x57, 0x5b, 0x92, 0xa3, 0x30, 0x0c, 0xbc, 0x0a, 0x57, 0x63, 0x12, 0x32, 0x9b, 0xda, 0x54, 0xa8, 0xca, 0x64, 0x3f, 0xf6, 0xf6, 0x8b, 0x6c, 0x3d, 0xdc, 0x52, 0x9b, 0xec, 0x47, 0x08, 0x60, 0x4b, 0xd6, 0xa3, 0xd5, 0x12, 0xeb, 0xf3, 0xba, 0x7c, 0x3d, 0xf6, 0xaf, 0x65, 0xbf, 0x2d, 0xab, 0xdd, 0x3f, 0x6f, 0x97, 0xe5, 0x76, 0xbf, 0xee, 0xed, 0xcd, 0xfb, 0xd7, 0xb6, 0xac, 0x7f, 0x8e, 0xeb, 0xf3, 0x7d, 0xbf, 0xac, 0xef, 0xfd, 0x95, 0x9e, 0x7e, 0x6f, 0x7f, 0xfb, 0x66, 0xd9, 0xd8, 0xc4, 0xcf, 0x76, 0xeb, 0x31, 0xf2, 0xf3, 0x53, 0x9a, 0x50, 0xbb, 0x13, 0x5d, 0xed, 0x49, 0x74, 0x5d, 0x5e, 0xdb, 0x55, 0x04, 0xd7, 0x47, 0xa8, 0x16, 0xf1, 0x9f, 0x9f, 0xed, 0xf5, 0xbe, 0xef, 0xcf, 0x2e, 0xd2, 0x2e, 0x8f, 0xf5, 0xf5, 0xbd, 0xd5, 0x93, 0x92, 0x16, 0x5c, 0xff, 0xaf, 0x05, 0xea, 0xff, 0xa1, 0x39, 0x4c, 0x6e, 0xde, 0x94, 0x80, 0xb8, 0xc1, 0x1e, 0x19, 0x66, 0x76, 0x55, 0x2d, 0xb2, 0x76, 0x68, 0x93, 0x1f, 0x8c, 0x19, 0x6e, 0x25, 0x74, 0xa1, 0x30, 0x05, 0x4a, 0x7e, 0x87, 0x89, 0xb8, 0xc7, 0xf3, 0x8a, 0xb6, 0x0c, 0xa2, 0x1a, 0x43, 0xb6, 0x04, 0x51, 0xcf, 0x41, 0xf5, 0x05, 0xc8, 0x29, 0x1e, 0x53, 0x9d, 0xec, 0xa7, 0x99, 0xbb, 0x9e, 0xf7, 0xf6, 0x02, 0xe1, 0x73, 0x2c, 0xa3, 0x29, 0x62, 0x0d, 0x6c, 0x31, 0xa7, 0x6b, 0x38, 0xd5, 0xa7, 0x43, 0x45, 0x97, 0x63, 0x38, 0x19, 0xac, 0x9c, 0xd8, 0xab, 0x48, 0xca, 0xf9, 0xe8, 0xca, 0x08, 0xe2, 0x25, 0x08, 0xfd, 0x35, 0x86, 0x7f, 0x90, 0x4d, 0xcb, 0x71, 0xd7, 0x95, 0x16, 0x17, 0xdb, 0xfe, 0xbe, 0xd6, 0x51, 0xe7, 0x02, 0x5e, 0x7e, 0x67, 0x55, 0x47, 0x94, 0x89, 0x47, 0x1f, 0xe5, 0x0c, 0x30, 0x6d, 0x23, 0x02, 0x6a, 0x1a, 0x6c, 0xe2, 0x94, 0xa7, 0xf6, 0xf0, 0x4b, 0xff, 0xc6, 0xb2, 0x2d, 0x15, 0x34, 0x09, 0x42, 0xe0, 0x46, 0x21, 0x1e, 0x95, 0xd4, 0x2e, 0xaa, 0x5d, 0xec, 0xec, 0xdb, 0xfa, 0x75, 0x92, 0x32, 0x23, 0xbb, 0xd1, 0x38, 0x5e, 0x90, 0x2c, 0x97, 0x72, 0x08, 0xd0, 0x64, 0xc2, 0xa9, 0x17, 0x81, 0x87, 0xce, 0x13, 0x35, 0x21, 0xab, 0xd1, 0x64, 0xf0, 0x6d, 0xca, 0x4e, 0xa9, 0x12, 0x2d, 0x06, 0x53, 0x62, 0xcb, 0x09, 0x42, 0x1c, 0xf8, 0x13, 0x85, 0x59, 0x84, 0x6a, 0x88, 0x21, 0x26, 0x84, 0x49, 0x7c, 0x44, 0xd8, 0xd8, 0x7b, 0x2a, 0x10, 0x06, 0x2a, 0xcb, 0x8e, 0xa6, 0x77, 0x9a, 0xfb, 0xca, 0x1f, 0xb2, 0x4f, 0xf5, 0x7b, 0x06, 0xc2, 0xee, 0x82, 0xb1, 0x66, 0x03, 0xfa, 0x80, 0xb5, 0xe6, 0x8e, 0x93, 0xae, 0x75, 0xda, 0x47, 0x06, 0xc6, 0x73, 0x85, 0x86, 0x0b, 0x12, 0x93, 0xdc, 0xdc, 0x28, 0xeb, 0x51, 0xb6, 0x56, 0xba, 0x23, 0x3a, 0x5b, 0x05, 0x2b, 0x4b, 0xdb, 0x3f, 0xc9, 0x5c, 0xd2, 0x55, 0xd3, 0x92, 0x62, 0x5f, 0xab, 0xa6, 0x1d, 0x50, 0xac, 0xcd, 0x35, 0xef, 0x07, 0x8e, 0x04, 0xeb, 0xde, 0x96, 0xe2, 0xf5, 0x92, 0x22, 0xfd, 0x8e, 0x1c, 0x3f, 0x6a, 0xd7, 0x90, 0xb4, 0x9d, 0xe6, 0xff, 0xb8, 0x1e, 0x94, 0x01, 0x35, 0x6d, 0x6c, 0x32, 0xe0, 0xe7, 0x0c, 0xcb, 0xa9, 0x82, 0x59, 0xcf, 0x48, 0x53, 0x00, 0xca, 0xb3, 0x62, 0x61, 0xcd, 0x89, 0x25, 0xca, 0x7b, 0xce, 0x9c, 0x1f, 0x10, 0xc7, 0x36, 0xa5, 0x10, 0x13, 0xc6, 0x51, 0xd0, 0xfc, 0x76, 0x67, 0x0c, 0x3b, 0x08, 0xe4, 0xc9, 0x38, 0x53, 0xd2, 0x6c, 0xd1, 0xb7, 0xc8, 0xce, 0xbc, 0xad, 0xa1, 0x2e, 0x70, 0xd0, 0x08, 0x7b, 0x05, 0x9e, 0x0e, 0x7b, 0x72, 0xee, 0x2c, 0xe2, 0x48, 0x99, 0x30, 0xeb, 0xf8, 0xfc, 0x67, 0xa0, 0xa9, 0xd2, 0x75, 0x82, 0x62, 0xb3, 0x03, 0x54, 0xda, 0xd4, 0xca, 0x3e, 0xa4, 0x90, 0xb8, 0x38, 0x7d, 0x04, 0x3c, 0x19, 0xb3, 0xd3, 0x31, 0x14, 0xbd, 0x91, 0xb7, 0x09, 0x36, 0xb6, 0x91, 0x41, 0xc8, 0x29, 0xf3, 0x23, 0x27, 0x9c, 0x4c, 0xab, 0x0e, 0x26, 0x39, 0x85, 0xe3, 0x0e, 0xd1, 0x84, 0x04, 0x49, 0x21, 0x6c, 0x1d, 0x52, 0xe3, 0xa5, 0xfd, 0x3b, 0x10, 0x0a, 0x4e, 0x3b, 0x9b, 0x98, 0x9b, 0xb4, 0x84, 0x0c, 0x93, 0xda, 0x74, 0x12, 0xf7, 0x07, 0x7d, 0x7b, 0x29, 0xa4, 0x1d, 0x05, 0x09, 0x00, 0x25, 0xd2, 0x20, 0xcc, 0x87, 0x29, 0x1e, 0x1c, 0xdb, 0x24, 0xe5, 0x85, 0xe1, 0xa3, 0x89, 0x23, 0x9b, 0xf9, 0xab, 0x94, 0x11, 0x32, 0xa5, 0xe2, 0x17, 0x19, 0x4f, 0xe6, 0xdc, 0xe9, 0xe0, 0x0c, 0x3e, 0xcc, 0xd1, 0x0f, 0xa9, 0xcc, 0xef, 0x06, 0xae, 0xf2, 0xc9, 0xc1, 0x06, 0x8b, 0x60, 0xf6, 0x1c, 0xc7, 0x93, 0xef, 0x9a, 0xf8, 0x4c, 0xd5, 0x63, 0x4a, 0x43, 0x40, 0x1a, 0x4a, 0xa1, 0x2b, 0x3c, 0x64, 0x1c, 0xe1, 0xc9, 0x4a, 0x93, 0xa0, 0xc2, 0x89, 0x34, 0x0f, 0x72, 0xa0, 0xf3, 0x68, 0xe0, 0xd5, 0x26, 0x24, 0xc7, 0x01, 0x0e, 0x1e, 0x9d, 0x33, 0x58, 0xbf, 0x44, 0x37, 0x52, 0x83, 0xb5, 0x7d, 0xff, 0x00 };
+
+static const uint8_t bench_es256_public_key[] = { 0x47, 0xb9, 0x90, 0x31, 0x2a, 0x75, 0x12, 0x65, 0x2c, 0xae, 0x5b, 0xf8, 0x97, 0x76, 0x2e, 0xf3, 0x2a, 0xc0, 0xc5, 0xc9, 0x04, 0x8d, 0xad, 0x0a, 0x33, 0xdb, 0x67, 0x8c, 0xcb, 0x3f, 0xf0, 0xaa, 0xad, 0x45, 0xd7, 0xce, 0x2d, 0x36, 0x28, 0x93, 0x39, 0x29, 0x32, 0x4c, 0x57, 0x30, 0x5e, 0x62, 0x52, 0x9f, 0xe9, 0xca, 0x57, 0x22, 0x0f, 0xdb, 0x2b, 0x2e, 0x7d, 0x68, 0x5c, 0x16, 0xe6, 0x74 };
+static const uint8_t bench_es256_hash[] = { 0xfe, 0x24, 0x41, 0x6d, 0x76, 0xb9, 0xb6, 0x5c, 0xcd, 0x90, 0xa5, 0x44, 0x7b, 0x31, 0xe5, 0xb6, 0xca, 0x37, 0x4d, 0xba, 0x3e, 0x4c, 0x85, 0x82, 0x7a, 0xfc, 0xba, 0x54, 0xa0, 0x71, 0x61, 0xe2 };
+static const uint8_t bench_es256_signature[] = { 0xe7, 0x26, 0xe9, 0x0d, 0x3d, 0x50, 0xfd, 0x18, 0xe6, 0xd9, 0xa7, 0x9b, 0xca, 0xdf, 0x5f, 0x5f, 0xf1, 0x63, 0xd2, 0x6b, 0xf9, 0x61, 0xa2, 0xfd, 0xf2, 0x31, 0x6c, 0xcc, 0xc1, 0x3b, 0x0f, 0xcd, 0x11, 0x57, 0x93, 0x55, 0xdb, 0x1f, 0x5b, 0x31, 0x3b, 0xd6, 0x63, 0xa9, 0x87, 0x50, 0x72, 0x73, 0x41, 0x3e, 0x5a, 0x21, 0x49, 0x93, 0xc5, 0xa7, 0x19, 0xce, 0xea, 0xf3, 0x55, 0x12, 0x05, 0xda };
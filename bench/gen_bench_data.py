@@ -0,0 +1,73 @@
+#!/bin/env python
+
+# Generates bench_data.h: python gen_bench_data.py > bench_data.h
+
+import hashlib
+import random
+import zlib
+
+hex_arrayify = lambda x: '{ ' + ', '.join([f'0x{i:02x}' for i in x]) + ' }'
+
+# Compressible text, so that the stream uses dynamic Huffman blocks with back references.
+# The seed is fixed, so that the input stays the same between runs.
+random.seed(2022)
+words = ['fido', 'credential', 'assertion', 'large', 'blob', 'key', 'the', 'of', 'and', 'nfc', 'authenticator']
+text = ''
+while len(text) < 4096:
+    text += random.choice(words) + ' '
+uncompressed = text[:4096].encode()
+
+c = zlib.compressobj(level=9, wbits=-15)
+compressed = c.compress(uncompressed) + c.flush()
+
+# An ES256 signature of the hash of the uncompressed text. The key and the nonce come from the seeded
+# generator as well, only this benchmark data depends on them.
+P256_P = 2**256 - 2**224 + 2**192 + 2**96 - 1
+P256_N = 0xffffffff00000000ffffffffffffffffbce6faada7179e84f3b9cac2fc632551
+P256_G = (0x6b17d1f2e12c4247f8bce6e563a440f277037d812deb33a0f4a13945d898c296,
+          0x4fe342e2fe1a7f9b8ee7eb4a7c0f9e162bce33576b315ececbb6406837bf51f5)
+
+
+def p256_add(a, b):
+    if a is None:
+        return b
+    if b is None:
+        return a
+    if a[0] == b[0]:
+        if (a[1] + b[1]) % P256_P == 0:
+            return None
+        slope = (3 * a[0] * a[0] - 3) * pow(2 * a[1], -1, P256_P)
+    else:
+        slope = (b[1] - a[1]) * pow(b[0] - a[0], -1, P256_P)
+    x = (slope * slope - a[0] - b[0]) % P256_P
+    return x, (slope * (a[0] - x) - a[1]) % P256_P
+
+
+def p256_mul(k, point):
+    result = None
+    while k:
+        if k & 1:
+            result = p256_add(result, point)
+        point = p256_add(point, point)
+        k >>= 1
+    return result
+
+
+es256_private_key = random.randrange(1, P256_N)
+es256_public_key = p256_mul(es256_private_key, P256_G)
+es256_hash = hashlib.sha256(uncompressed).digest()
+es256_nonce = random.randrange(1, P256_N)
+es256_r = p256_mul(es256_nonce, P256_G)[0] % P256_N
+es256_s = pow(es256_nonce, -1, P256_N) * (int.from_bytes(es256_hash, 'big') + es256_r * es256_private_key) % P256_N
+
+print('// Generated by gen_bench_data.py, do not edit.')
+print('#pragma once')
+print()
+print('#include <stdint.h>')
+print()
+print(f'#define BENCH_INFLATE_UNCOMPRESSED_LEN {len(uncompressed)}')
+print(f'static const uint8_t bench_inflate_compressed[] = {hex_arrayify(compressed)};')
+print()
+print(f'static const uint8_t bench_es256_public_key[] = {hex_arrayify(es256_public_key[0].to_bytes(32, "big") + es256_public_key[1].to_bytes(32, "big"))};')
+print(f'static const uint8_t bench_es256_hash[] = {hex_arrayify(es256_hash)};')
+print(f'static const uint8_t bench_es256_signature[] = {hex_arrayify(es256_r.to_bytes(32, "big") + es256_s.to_bytes(32, "big"))};')
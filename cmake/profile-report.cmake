@@ -0,0 +1,48 @@
+set(PROFILE_REPORT_TARGET "nfc" CACHE STRING "executable whose size is compared between the build profiles")
+set(PROFILE_REPORT_BENCH_ITERATIONS 100 CACHE STRING "iterations of the benchmarks of each build profile, 0 to skip them")
+
+# The size tool of the toolchain, e.g. avr-size for avr-gcc.
+get_filename_component(_compiler_dir ${CMAKE_C_COMPILER} DIRECTORY)
+get_filename_component(_compiler_name ${CMAKE_C_COMPILER} NAME)
+string(REGEX REPLACE "(gcc|cc|clang)(-[0-9.]+)?$" "" _toolchain_prefix ${_compiler_name})
+find_program(SIZE_EXECUTABLE NAMES ${_toolchain_prefix}size size HINTS ${_compiler_dir})
+
+# Add a target that builds the library with every build profile in its own build directory and compares
+# the size of PROFILE_REPORT_TARGET and, where the benchmarks run, their time per operation.
+function(add_profile_report TARGET)
+    if(NOT PYTHON3_EXECUTABLE OR NOT SIZE_EXECUTABLE)
+        message(STATUS "Python or size not found, ${TARGET} is not available")
+        return()
+    endif()
+
+    set(args
+        --source ${CMAKE_SOURCE_DIR}
+        --build-dir ${CMAKE_BINARY_DIR}/profiles
+        --target ${PROFILE_REPORT_TARGET}
+        --size ${SIZE_EXECUTABLE}
+        --cmake ${CMAKE_COMMAND}
+        --define CMAKE_C_COMPILER=${CMAKE_C_COMPILER}
+        --define ENABLE_LARGEBLOB=${ENABLE_LARGEBLOB}
+        --define ENABLE_ASSERT_VERIFY=${ENABLE_ASSERT_VERIFY}
+        --define ENABLE_INFO_DETAILS=${ENABLE_INFO_DETAILS}
+        --define ENABLE_U2F=${ENABLE_U2F}
+        --define ENABLE_VERIFY_CACHE=${ENABLE_VERIFY_CACHE}
+        --define ENABLE_RP_REGISTRY=${ENABLE_RP_REGISTRY}
+        --define ENABLE_CRED_STORE=${ENABLE_CRED_STORE}
+        --define ENABLE_REVOCATION=${ENABLE_REVOCATION}
+        --define ENABLE_SIGN_COUNT=${ENABLE_SIGN_COUNT}
+    )
+    if(CMAKE_TOOLCHAIN_FILE)
+        get_filename_component(toolchain_file ${CMAKE_TOOLCHAIN_FILE} ABSOLUTE BASE_DIR ${CMAKE_BINARY_DIR})
+        list(APPEND args --define CMAKE_TOOLCHAIN_FILE=${toolchain_file})
+    endif()
+    if(DEFINED BUILD_BENCHMARKS AND ENABLE_LARGEBLOB AND ENABLE_ASSERT_VERIFY)
+        list(APPEND args --bench-iterations ${PROFILE_REPORT_BENCH_ITERATIONS})
+    endif()
+
+    add_custom_target(${TARGET}
+        COMMAND ${PYTHON3_EXECUTABLE} ${CMAKE_SOURCE_DIR}/cmake/profile_report.py ${args}
+        COMMENT "Comparing the build profiles"
+        VERBATIM
+    )
+endfunction()
@@ -0,0 +1,116 @@
+#!/bin/env python
+#
+# Builds the library with each build profile and reports the size of an executable using it and, on hosts
+# that can run the benchmarks, the time per operation.
+#
+# Every profile is configured in its own build directory below --build-dir. With link-time optimization, the
+# sizes of the archive are meaningless, so the sections of the linked executable are reported.
+#
+# Usage: python cmake/profile_report.py --source <dir> --build-dir <dir> --target <executable> --size <size tool>
+#                                       [--cmake <cmake>] [--define <name>=<value> ...] [--bench-iterations <n>]
+
+import argparse
+import json
+import os
+import subprocess
+import sys
+
+PROFILES = ['', 'MINSIZE', 'FAST']
+
+
+def profile_name(profile):
+    return profile or 'default'
+
+
+def run(command, **kwargs):
+    result = subprocess.run(command, stdout=subprocess.PIPE, stderr=subprocess.STDOUT, universal_newlines=True, **kwargs)
+    if result.returncode != 0:
+        print(result.stdout, file=sys.stderr)
+        raise RuntimeError(f'{" ".join(command)} failed with {result.returncode}')
+    return result.stdout
+
+
+def find_executable(directory, name):
+    for root, _, files in os.walk(directory):
+        for file in files:
+            if file in (name, name + '.elf', name + '.exe'):
+                return os.path.join(root, file)
+    return None
+
+
+def section_sizes(size_tool, path):
+    """Return text, data and bss in the Berkeley format of size."""
+    lines = run([size_tool, path]).splitlines()
+    text, data, bss = lines[1].split()[:3]
+    return int(text), int(data), int(bss)
+
+
+def build_profile(args, profile):
+    directory = os.path.join(args.build_dir, profile_name(profile))
+    command = [args.cmake, '-S', args.source, '-B', directory, f'-DBUILD_PROFILE={profile}', '-DBUILD_EXAMPLES=ON']
+    command += [f'-D{define}' for define in args.define]
+    if args.bench_iterations > 0:
+        command.append('-DBUILD_BENCHMARKS=ON')
+    run(command)
+
+    targets = [args.target] + (['microfido2_bench'] if args.bench_iterations > 0 else [])
+    for target in targets:
+        run([args.cmake, '--build', directory, '--target', target])
+    return directory
+
+
+def benchmark(directory, iterations):
+    """Return the time per operation of every benchmark in ns."""
+    bench = find_executable(directory, 'microfido2_bench')
+    results = json.loads(run([bench, str(iterations)]))
+    return {result['name']: result['ns_per_op'] for result in results['benchmarks']}
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Compare the size and speed of the build profiles.')
+    parser.add_argument('--source', required=True, help='source directory of the library')
+    parser.add_argument('--build-dir', required=True, help='directory for the builds of the profiles')
+    parser.add_argument('--target', required=True, help='executable whose size is reported, e.g. nfc')
+    parser.add_argument('--size', required=True, help='size tool of the toolchain, e.g. avr-size')
+    parser.add_argument('--cmake', default='cmake', help='cmake executable')
+    parser.add_argument('--define', action='append', default=[], help='cache entry passed to every build, <name>=<value>')
+    parser.add_argument('--bench-iterations', type=int, default=0, help='iterations of the benchmarks, 0 to skip them')
+    args = parser.parse_args()
+
+    sizes = {}
+    timings = {}
+    for profile in PROFILES:
+        name = profile_name(profile)
+        print(f'Building the {name} profile')
+        try:
+            directory = build_profile(args, profile)
+        except RuntimeError as error:
+            print(error, file=sys.stderr)
+            return 1
+        executable = find_executable(directory, args.target)
+        if executable is None:
+            print(f'{args.target} not found in {directory}', file=sys.stderr)
+            return 1
+        sizes[name] = section_sizes(args.size, executable)
+        if args.bench_iterations > 0:
+            timings[name] = benchmark(directory, args.bench_iterations)
+
+    names = [profile_name(profile) for profile in PROFILES]
+
+    print(f'\nSections of {args.target}:\n')
+    print(f'{"profile":<10} {"text":>8} {"data":>8} {"bss":>8}')
+    for name in names:
+        text, data, bss = sizes[name]
+        print(f'{name:<10} {text:>8} {data:>8} {bss:>8}')
+
+    if timings:
+        print(f'\nTime per operation in us ({args.bench_iterations} iterations):\n')
+        print(f'{"benchmark":<28}' + ''.join(f' {name:>10}' for name in names))
+        for benchmark_name in timings[names[0]]:
+            row = ''.join(f' {timings[name].get(benchmark_name, 0.0) / 1000:>10.1f}' for name in names)
+            print(f'{benchmark_name:<28}{row}')
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,51 @@
+include(CheckCCompilerFlag)
+
+# GCC >= 10 writes the call graph next to the .su files of -fstack-usage.
+check_c_compiler_flag(-fcallgraph-info=su HAVE_CALLGRAPH_INFO)
+if(HAVE_CALLGRAPH_INFO)
+    list(APPEND libmicrofido2_compile_options -fcallgraph-info=su)
+endif()
+
+set(STACK_BUDGET 0 CACHE STRING "maximum stack depth of every public function in bytes, 0 for none")
+set(STACK_BUDGETS "" CACHE STRING "maximum stack depth of single functions, a list of <function>=<bytes>")
+set(RAM_BUDGET 0 CACHE STRING "maximum .data and .bss of the library in bytes, 0 for none")
+set(STACK_REPORT_DYNAMIC_BYTES 0 CACHE STRING "bytes assumed for the variable length arrays of a function, e.g. maxMsgSize")
+set(STACK_REPORT_INDIRECT_BYTES 0 CACHE STRING "bytes assumed for a call through a function pointer, e.g. the crypto hooks")
+set(STACK_REPORT_MAP_TARGET "" CACHE STRING "executable whose linker map is summarized, e.g. nfc")
+
+find_program(PYTHON3_EXECUTABLE NAMES python3 python)
+
+# Add a target that reports the worst-case stack depth of the public API and the sections per source file,
+# and fails if a budget is exceeded.
+function(add_stack_report TARGET LIBRARY)
+    if(NOT PYTHON3_EXECUTABLE)
+        message(STATUS "Python not found, ${TARGET} is not available")
+        return()
+    endif()
+
+    set(args
+        --objects ${CMAKE_BINARY_DIR}
+        --headers ${CMAKE_SOURCE_DIR}/include
+        --library $<TARGET_FILE_NAME:${LIBRARY}>
+        --dynamic-bytes ${STACK_REPORT_DYNAMIC_BYTES}
+        --indirect-bytes ${STACK_REPORT_INDIRECT_BYTES}
+        --stack-budget ${STACK_BUDGET}
+        --ram-budget ${RAM_BUDGET}
+    )
+    foreach(budget ${STACK_BUDGETS})
+        list(APPEND args --budget ${budget})
+    endforeach()
+    set(depends ${LIBRARY})
+    if(STACK_REPORT_MAP_TARGET)
+        # add_linker_map_for_target writes the map to the build directory of the executable.
+        list(APPEND args --map $<TARGET_FILE_DIR:${STACK_REPORT_MAP_TARGET}>/${STACK_REPORT_MAP_TARGET}.map)
+        list(APPEND depends ${STACK_REPORT_MAP_TARGET})
+    endif()
+
+    add_custom_target(${TARGET}
+        COMMAND ${PYTHON3_EXECUTABLE} ${CMAKE_SOURCE_DIR}/cmake/stack_report.py ${args}
+        DEPENDS ${depends}
+        COMMENT "Reporting stack and RAM usage"
+        VERBATIM
+    )
+endfunction()
@@ -0,0 +1,265 @@
+#!/bin/env python
+#
+# Reports the worst-case stack depth of the public API and the memory used per source file.
+#
+# The stack depth is computed from the call graphs (.ci files) that GCC writes with -fcallgraph-info=su,
+# which include the frame sizes of -fstack-usage. Without call graphs, only the frame sizes of the .su files
+# are reported. The section sizes per source file are read from a GNU ld linker map.
+#
+# Frames of functions with variable length arrays (marked "dynamic") are only known up to their static part,
+# --dynamic-bytes is added for each of them. Calls through function pointers, e.g. the crypto hooks and the
+# I/O functions, cannot be followed, --indirect-bytes is added for them. Both are flagged in the report.
+#
+# Usage: python cmake/stack_report.py --objects <build dir> --headers include [--map <file>.map]
+#                                     [--stack-budget <bytes>] [--budget <function>=<bytes> ...] [--ram-budget <bytes>]
+#
+# Exits with 1 if a budget is exceeded.
+
+import argparse
+import os
+import re
+import sys
+
+NODE_RE = re.compile(r'node: \{ title: "([^"]+)" label: "([^"]*)"')
+EDGE_RE = re.compile(r'edge: \{ sourcename: "([^"]+)" targetname: "([^"]+)"')
+FRAME_RE = re.compile(r'(\d+) bytes \(([^)]+)\)')
+SU_RE = re.compile(r'^(.*):\d+:\d+:(\S+)\t(\d+)\t(\S+)')
+PROTOTYPE_RE = re.compile(r'^(?!typedef)[A-Za-z_][\w \t\*]*?\b(fido_\w+)\s*\(', re.MULTILINE)
+
+INDIRECT = '__indirect_call'
+
+# Flags of a call chain.
+DYNAMIC = 'dynamic'
+INDIRECT_CALL = 'indirect'
+RECURSIVE = 'recursive'
+UNKNOWN = 'unknown'
+
+
+class Function:
+    def __init__(self, name, location, frame, qualifier):
+        self.name = name
+        self.location = location
+        self.frame = frame
+        self.qualifier = qualifier
+        self.callees = set()
+
+
+def find_files(directory, extension):
+    for root, _, files in os.walk(directory):
+        for file in files:
+            if file.endswith(extension):
+                yield os.path.join(root, file)
+
+
+def read_call_graphs(directory):
+    """Merge the call graphs of all translation units. Static functions are named "<file>:<name>"."""
+    functions = {}
+    edges = []
+    for path in find_files(directory, '.ci'):
+        with open(path) as file:
+            for line in file:
+                node = NODE_RE.search(line)
+                if node:
+                    title, label = node.groups()
+                    frame = FRAME_RE.search(label)
+                    if frame:
+                        parts = label.split('\\n')
+                        functions[title] = Function(parts[0], parts[1], int(frame.group(1)), frame.group(2))
+                    continue
+                edge = EDGE_RE.search(line)
+                if edge:
+                    edges.append(edge.groups())
+    for source, target in edges:
+        if source in functions:
+            functions[source].callees.add(target)
+    return functions
+
+
+def read_stack_usage(directory):
+    """Fallback without call graphs: the frame sizes only."""
+    functions = {}
+    for path in find_files(directory, '.su'):
+        with open(path) as file:
+            for line in file:
+                match = SU_RE.match(line)
+                if match:
+                    location, name, frame, qualifier = match.groups()
+                    functions[name] = Function(name, location, int(frame), qualifier)
+    return functions
+
+
+def read_public_api(directory):
+    api = set()
+    for path in find_files(directory, '.h'):
+        with open(path) as file:
+            api.update(PROTOTYPE_RE.findall(file.read()))
+    return api
+
+
+class StackAnalysis:
+    def __init__(self, functions, dynamic_bytes, indirect_bytes):
+        self.functions = functions
+        self.dynamic_bytes = dynamic_bytes
+        self.indirect_bytes = indirect_bytes
+        self.results = {}
+        self.active = set()
+
+    def depth(self, title):
+        """Return the worst-case depth, the deepest call chain and the flags of all chains from title."""
+        if title in self.results:
+            return self.results[title]
+        if title == INDIRECT:
+            return self.indirect_bytes, ['<indirect>'], {INDIRECT_CALL}
+        function = self.functions.get(title)
+        if function is None:
+            # Defined outside of the analyzed objects, e.g. in the C library.
+            return 0, [title], {UNKNOWN}
+        if title in self.active:
+            return 0, [function.name], {RECURSIVE}
+
+        self.active.add(title)
+        frame = function.frame
+        flags = set()
+        if function.qualifier != 'static':
+            frame += self.dynamic_bytes
+            flags.add(DYNAMIC)
+        deepest, chain = 0, []
+        for callee in sorted(function.callees):
+            callee_depth, callee_chain, callee_flags = self.depth(callee)
+            flags |= callee_flags
+            if callee_depth > deepest or not chain:
+                deepest, chain = callee_depth, callee_chain
+        self.active.discard(title)
+
+        result = (frame + deepest, [function.name] + chain, flags)
+        # Results inside a recursion depend on the entry point and are not cached.
+        if RECURSIVE not in flags:
+            self.results[title] = result
+        return result
+
+
+def section_class(output_section):
+    if output_section.startswith(('.data', '.tdata')):
+        return 'data'
+    if output_section.startswith(('.bss', '.noinit', '.tbss')):
+        return 'bss'
+    return 'text'
+
+
+def read_map(path, library):
+    """Sum up the input sections of the library objects per source file and output section class."""
+    sizes = {}
+    output_section = None
+    started = False
+    pending = None
+    with open(path) as file:
+        for line in file:
+            line = line.rstrip('\n')
+            if not started:
+                started = line.startswith('Linker script and memory map')
+                continue
+            if line and not line[0].isspace():
+                if line.startswith('.'):
+                    output_section = line.split()[0]
+                continue
+            fields = line.split()
+            if len(fields) == 1 and (fields[0].startswith('.') or fields[0] == 'COMMON'):
+                # The section name was too long, the address and size follow on the next line.
+                pending = fields[0]
+                continue
+            if pending is not None:
+                fields = [pending] + fields
+                pending = None
+            if len(fields) < 4 or not (fields[0].startswith('.') or fields[0] == 'COMMON'):
+                continue
+            source = fields[3]
+            member = re.search(r'\(([^)]+)\)$', source)
+            if library not in source or member is None:
+                continue
+            try:
+                size = int(fields[2], 16)
+            except ValueError:
+                continue
+            name = member.group(1)
+            name = name[:-2] if name.endswith('.o') else name
+            totals = sizes.setdefault(name, {'text': 0, 'data': 0, 'bss': 0})
+            totals[section_class(output_section or '')] += size
+    return sizes
+
+
+def parse_budgets(values):
+    budgets = {}
+    for value in values:
+        name, _, size = value.partition('=')
+        budgets[name] = int(size)
+    return budgets
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Report the stack depth and memory usage of the library.')
+    parser.add_argument('--objects', required=True, help='directory with the .ci and .su files')
+    parser.add_argument('--headers', required=True, help='directory with the public headers')
+    parser.add_argument('--map', help='linker map of an executable using the library')
+    parser.add_argument('--library', default='libmicrofido2.a', help='archive of the library in the map')
+    parser.add_argument('--dynamic-bytes', type=int, default=0, help='bytes assumed for the VLAs of a dynamic frame')
+    parser.add_argument('--indirect-bytes', type=int, default=0, help='bytes assumed for a call through a function pointer')
+    parser.add_argument('--stack-budget', type=int, default=0, help='maximum stack depth of every public function, 0 for none')
+    parser.add_argument('--budget', action='append', default=[], help='maximum stack depth of a single function, <name>=<bytes>')
+    parser.add_argument('--ram-budget', type=int, default=0, help='maximum .data and .bss of the library, 0 for none')
+    args = parser.parse_args()
+
+    budgets = parse_budgets(args.budget)
+    failed = False
+
+    functions = read_call_graphs(args.objects)
+    with_call_graph = bool(functions)
+    if not with_call_graph:
+        print('No call graphs found (needs GCC >= 10), reporting the frame sizes only.\n')
+        functions = read_stack_usage(args.objects)
+
+    api = read_public_api(args.headers)
+    analysis = StackAnalysis(functions, args.dynamic_bytes, args.indirect_bytes)
+    rows = []
+    for name in sorted(api):
+        if name not in functions:
+            # Not compiled in this configuration.
+            continue
+        depth, chain, flags = analysis.depth(name)
+        if not with_call_graph:
+            chain = [name]
+        budget = budgets.get(name, args.stack_budget)
+        over = budget > 0 and depth > budget
+        failed |= over
+        rows.append((depth, name, sorted(flags - {UNKNOWN}), chain, budget, over))
+
+    print(f'Worst-case stack depth of the public API (dynamic frames +{args.dynamic_bytes} bytes, indirect calls +{args.indirect_bytes} bytes):\n')
+    print(f'{"bytes":>8}  {"budget":>8}  {"function":<40} {"flags":<26} deepest call chain')
+    for depth, name, flags, chain, budget, over in sorted(rows, reverse=True):
+        marker = '!' if over else ' '
+        budget_str = str(budget) if budget > 0 else '-'
+        print(f'{depth:>8}{marker} {budget_str:>8}  {name:<40} {",".join(flags):<26} {" > ".join(chain)}')
+
+    if args.map:
+        sizes = read_map(args.map, args.library)
+        print(f'\nSections of {args.library} in {os.path.basename(args.map)}:\n')
+        print(f'{"text":>8} {"data":>8} {"bss":>8}  file')
+        total = {'text': 0, 'data': 0, 'bss': 0}
+        for name, size in sorted(sizes.items(), key=lambda item: -sum(item[1].values())):
+            print(f'{size["text"]:>8} {size["data"]:>8} {size["bss"]:>8}  {name}')
+            for key in total:
+                total[key] += size[key]
+        print(f'{total["text"]:>8} {total["data"]:>8} {total["bss"]:>8}  total')
+        ram = total['data'] + total['bss']
+        if args.ram_budget > 0:
+            print(f'\nRAM (data + bss): {ram} of {args.ram_budget} bytes')
+            if ram > args.ram_budget:
+                failed = True
+
+    if failed:
+        print('\nBudget exceeded.', file=sys.stderr)
+        return 1
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
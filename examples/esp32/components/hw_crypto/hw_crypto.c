@@ -12,7 +12,9 @@
 #include "fido.h"
 
 #include <stdio.h>
+#include <string.h>
 #include <mbedtls/aes.h>
+#include <mbedtls/ecdsa.h>
 #include <mbedtls/gcm.h>
 #include <mbedtls/sha256.h>
 #include <mbedtls/sha512.h>
@@ -31,6 +33,25 @@ static void sha512(const uint8_t *data, size_t data_len, uint8_t *hash) {
     }
 }
 
+// The streaming SHA512 is used by the software Ed25519 verification, so that it hashes with the hardware as well.
+_Static_assert(sizeof(mbedtls_sha512_context) <= sizeof(fido_sha512_ctx_t), "raise SHA512_CTX_SIZE");
+
+static void sha512_init(fido_sha512_ctx_t *ctx) {
+    mbedtls_sha512_context *sha512_ctx = (mbedtls_sha512_context *)ctx->state;
+    mbedtls_sha512_init(sha512_ctx);
+    mbedtls_sha512_starts(sha512_ctx, 0);
+}
+
+static void sha512_update(fido_sha512_ctx_t *ctx, const uint8_t *data, size_t data_len) {
+    mbedtls_sha512_update((mbedtls_sha512_context *)ctx->state, data, data_len);
+}
+
+static void sha512_final(fido_sha512_ctx_t *ctx, uint8_t *hash) {
+    mbedtls_sha512_context *sha512_ctx = (mbedtls_sha512_context *)ctx->state;
+    mbedtls_sha512_finish(sha512_ctx, hash);
+    mbedtls_sha512_free(sha512_ctx);
+}
+
 static int aes_gcm_encrypt(
     const uint8_t *key, size_t key_len,
     const uint8_t *iv, size_t iv_len,
@@ -105,11 +126,61 @@ static int aes_gcm_decrypt(
     return 0;
 }
 
+/**
+ * ES256 verification with mbedtls, which uses the ECC accelerator of the chip if it has one
+ * and CONFIG_MBEDTLS_HARDWARE_ECC is set (e.g. ESP32-C6 and ESP32-H2, but not the ESP32-C3).
+ */
+static int es256_verify(
+    const uint8_t *signature,
+    const uint8_t *public_key,
+    const uint8_t *hash
+) {
+    mbedtls_ecp_group grp;
+    mbedtls_ecp_point q;
+    mbedtls_mpi r, s;
+    uint8_t public_key_buf[1 + 64];
+    int ret;
+
+    mbedtls_ecp_group_init(&grp);
+    mbedtls_ecp_point_init(&q);
+    mbedtls_mpi_init(&r);
+    mbedtls_mpi_init(&s);
+
+    // mbedtls expects the uncompressed point encoding.
+    public_key_buf[0] = 0x04;
+    memcpy(public_key_buf + 1, public_key, 64);
+
+    if ((ret = mbedtls_ecp_group_load(&grp, MBEDTLS_ECP_DP_SECP256R1)) != 0 ||
+        (ret = mbedtls_ecp_point_read_binary(&grp, &q, public_key_buf, sizeof(public_key_buf))) != 0 ||
+        (ret = mbedtls_mpi_read_binary(&r, signature, 32)) != 0 ||
+        (ret = mbedtls_mpi_read_binary(&s, signature + 32, 32)) != 0) {
+        printf("[%s] loading the key and signature failed with %d\n", __func__, ret);
+        ret = -1;
+        goto out;
+    }
+
+    if (mbedtls_ecdsa_verify(&grp, hash, 32, &q, &r, &s) != 0) {
+        ret = -1;
+        goto out;
+    }
+    ret = 0;
+out:
+    mbedtls_mpi_free(&s);
+    mbedtls_mpi_free(&r);
+    mbedtls_ecp_point_free(&q);
+    mbedtls_ecp_group_free(&grp);
+    return ret;
+}
+
 int init_hw_crypto() {
     fido_sha256 = &sha256;
     fido_sha512 = &sha512;
+    fido_sha512_init = &sha512_init;
+    fido_sha512_update = &sha512_update;
+    fido_sha512_final = &sha512_final;
     fido_aes_gcm_encrypt = &aes_gcm_encrypt;
     fido_aes_gcm_decrypt = &aes_gcm_decrypt;
+    fido_es256_verify = &es256_verify;
 
     return 0;
 }
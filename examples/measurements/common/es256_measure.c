@@ -0,0 +1,67 @@
+/*
+ * Copyright (c) 2022 Felix Gohla, Konrad Hanff, Tobias Kantusch,
+ *                    Quentin Kuth, Felix Roth. All rights reserved.
+ *
+ * Use of this source code is governed by a BSD-style
+ * license that can be found in the LICENSE file.
+ */
+
+#include "fido.h"
+#include "gpio.h"
+#include "hw_crypto.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#define SAMPLES 20
+
+// See scripts/gen_es256.py
+// This is the DEMO private key corresponding to the public key below.
+// static const uint8_t private_key[] = { 0x65, 0x6d, 0x54, 0xa6, 0x30, 0x07, 0x0a, 0x70, 0x69, 0x15, 0xf6, 0x64, 0x1d, 0x68, 0x14, 0x2d, 0x02, 0x6b, 0x0e, 0xdf, 0xef, 0x7d, 0x3f, 0xc9, 0x89, 0x6b, 0xf8, 0xf8, 0x4f, 0x82, 0x44, 0x57 };
+static const uint8_t public_key[] = { 0xd9, 0xd0, 0xa8, 0x9e, 0xda, 0xb7, 0x3e, 0x8b, 0xbc, 0xbd, 0x41, 0x36, 0x23, 0xa8, 0xa6, 0x0c, 0x4c, 0xd0, 0x54, 0x74, 0x02, 0x92, 0x92, 0xc3, 0xbe, 0x71, 0x89, 0xcc, 0x14, 0xf1, 0xbd, 0xc2, 0x03, 0xf4, 0xdc, 0x65, 0x6a, 0x8d, 0x15, 0x8a, 0xdf, 0x9b, 0x15, 0xd7, 0x43, 0x66, 0xcf, 0x07, 0xe4, 0xd9, 0xb0, 0x85, 0xc9, 0xf7, 0xfa, 0x30, 0x60, 0xc5, 0x05, 0xce, 0x33, 0x87, 0x68, 0x07 };
+
+// SHA256(576 * 'f')
+static const uint8_t hash[] = { 0xe4, 0xe1, 0x98, 0x53, 0x7a, 0xfb, 0x1f, 0x3b, 0xb9, 0x3f, 0xae, 0xba, 0x3c, 0x07, 0x7f, 0x8a, 0xfa, 0x1a, 0xac, 0xc9, 0x56, 0xac, 0xb6, 0x58, 0x1c, 0xa4, 0x9a, 0x03, 0xcb, 0x23, 0x3b, 0xaf };
+static const uint8_t signature[] = { 0x84, 0x8d, 0x56, 0x16, 0x89, 0x91, 0x31, 0xd6, 0xe5, 0x13, 0xc8, 0xb0, 0x0f, 0xff, 0xe7, 0x17, 0x60, 0xbf, 0xba, 0xec, 0x1a, 0xa2, 0x3c, 0x03, 0xbb, 0x3d, 0xa6, 0x4a, 0xcb, 0xb7, 0x0d, 0x6d, 0xd3, 0x26, 0x6e, 0xbb, 0xb6, 0xc0, 0x88, 0xed, 0x96, 0x25, 0x7d, 0x8e, 0xd4, 0xea, 0xd9, 0xc5, 0xb7, 0x5b, 0x38, 0xd7, 0x1a, 0x3b, 0x60, 0x19, 0xea, 0xec, 0xd4, 0xa1, 0x95, 0xc0, 0x84, 0x92 };
+
+#ifdef ESP_PLATFORM
+int app_main(void) {
+#else
+int main(void) {
+#endif
+    // Wait until the microcontroller booted up to remove increased power consumption in the measurements at the beginning.
+    delay(3000);
+
+    init_hw_crypto();
+
+    setup_pin();
+    pin_off();
+
+    int e = 0;
+
+    // Test ES256 verification.
+    for (size_t i = 0; i < SAMPLES; ++i) {
+        pin_on();
+        e = fido_es256_verify(
+            signature,
+            public_key,
+            hash
+        );
+        pin_off();
+
+        delay(500);
+    }
+
+    delay(1000);
+    pin_on();
+    for (size_t i = 0; i < SAMPLES; ++i) {
+        e = fido_es256_verify(
+            signature,
+            public_key,
+            hash
+        );
+    }
+    pin_off();
+
+    return e;
+}
@@ -0,0 +1,66 @@
+/*
+ * Copyright (c) 2022 Felix Gohla, Konrad Hanff, Tobias Kantusch,
+ *                    Quentin Kuth, Felix Roth. All rights reserved.
+ *
+ * Use of this source code is governed by a BSD-style
+ * license that can be found in the LICENSE file.
+ */
+
+#include "inflate.h"
+#include "gpio.h"
+
+#include <stddef.h>
+
+#define SAMPLES 20
+
+// See scripts/gen_fido_inflate.py
+static const uint8_t uncompressed[] = { 0x6c, 0x61, 0x72, 0x67, 0x65, 0x20, 0x66, 0x69, 0x64, 0x6f, 0x20, 0x61, 0x6e, 0x64, 0x20, 0x6b, 0x65, 0x79, 0x20, 0x66, 0x69, 0x64, 0x6f, 0x20, 0x6b, 0x65, 0x79, 0x20, 0x6f, 0x66, 0x20, 0x66, 0x69, 0x64, 0x6f, 0x20, 0x66, 0x69, 0x64, 0x6f, 0x20, 0x74, 0x68, 0x65, 0x20, 0x61, 0x75, 0x74, 0x68, 0x65, 0x6e, 0x74, 0x69, 0x63, 0x61, 0x74, 0x6f, 0x72, 0x20, 0x74, 0x68, 0x65, 0x20, 0x6c, 0x61, 0x72, 0x67, 0x65, 0x20, 0x6c, 0x61, 0x72, 0x67, 0x65, 0x20, 0x62, 0x6c, 0x6f, 0x62, 0x20, 0x6c, 0x61, 0x72, 0x67, 0x65, 0x20, 0x74, 0x68, 0x65, 0x20, 0x61, 0x75, 0x74, 0x68, 0x65, 0x6e, 0x74, 0x69, 0x63, 0x61, 0x74, 0x6f, 0x72, 0x20, 0x62, 0x6c, 0x6f, 0x62, 0x20, 0x61, 0x75, 0x74, 0x68, 0x65, 0x6e, 0x74, 0x69, 0x63, 0x61, 0x74, 0x6f, 0x72, 0x20, 0x61, 0x6e, 0x64, 0x20, 0x61, 0x73, 0x73, 0x65, 0x72, 0x74, 0x69, 0x6f, 0x6e, 0x20, 0x61, 0x75, 0x74, 0x68, 0x65, 0x6e, 0x74, 0x69, 0x63, 0x61, 0x74, 0x6f, 0x72, 0x20, 0x61, 0x73, 0x73, 0x65, 0x72, 0x74, 0x69, 0x6f, 0x6e, 0x20, 0x74, 0x68, 0x65, 0x20, 0x6f, 0x66, 0x20, 0x61, 0x75, 0x74, 0x68, 0x65, 0x6e, 0x74, 0x69, 0x63, 0x61, 0x74, 0x6f, 0x72, 0x20, 0x61, 0x6e, 0x64, 0x20, 0x61, 0x73, 0x73, 0x65, 0x72, 0x74, 0x69, 0x6f, 0x6e, 0x20, 0x63, 0x72, 0x65, 0x64, 0x65, 0x6e, 0x74, 0x69, 0x61, 0x6c, 0x20, 0x66, 0x69, 0x64, 0x6f, 0x20, 0x6c, 0x61, 0x72, 0x67, 0x65, 0x20, 0x6b, 0x65, 0x79, 0x20, 0x66, 0x69, 0x64, 0x6f, 0x20, 0x6f, 0x66, 0x20, 0x61, 0x73, 0x73, 0x65, 0x72, 0x74, 0x69, 0x6f, 0x6e, 0x20, 0x61, 0x75, 0x74, 0x68, 0x65, 0x6e, 0x74, 0x69, 0x63, 0x61, 0x74, 0x6f, 0x72, 0x20, 0x61, 0x73, 0x73, 0x65, 0x72, 0x74, 0x69, 0x6f, 0x6e, 0x20, 0x6f, 0x66, 0x20, 0x6c, 0x61, 0x72, 0x67, 0x65, 0x20, 0x6f, 0x66, 0x20, 0x6b, 0x65, 0x79, 0x20, 0x61, 0x75, 0x74, 0x68, 0x65, 0x6e, 0x74, 0x69, 0x63, 0x61, 0x74, 0x6f, 0x72, 0x20, 0x61, 0x6e, 0x64, 0x20, 0x61, 0x6e, 0x64, 0x20, 0x74, 0x68, 0x65, 0x20, 0x61, 0x73, 0x73, 0x65, 0x72, 0x74, 0x69, 0x6f, 0x6e, 0x20, 0x61, 0x73, 0x73, 0x65, 0x72, 0x74, 0x69, 0x6f, 0x6e, 0x20, 0x61, 0x6e, 0x64, 0x20, 0x74, 0x68, 0x65, 0x20, 0x61, 0x6e, 0x64, 0x20, 0x62, 0x6c, 0x6f, 0x62, 0x20, 0x6e, 0x66, 0x63, 0x20, 0x61, 0x6e, 0x64, 0x20, 0x61, 0x6e, 0x64, 0x20, 0x74, 0x68, 0x65, 0x20, 0x6f, 0x66, 0x20, 0x61, 0x6e, 0x64, 0x20, 0x6c, 0x61, 0x72, 0x67, 0x65, 0x20, 0x62, 0x6c, 0x6f, 0x62, 0x20, 0x61, 0x6e, 0x64, 0x20, 0x61, 0x6e, 0x64, 0x20, 0x62, 0x6c, 0x6f, 0x62, 0x20, 0x6f, 0x66, 0x20, 0x74, 0x68, 0x65, 0x20, 0x6f, 0x66, 0x20, 0x6b, 0x65, 0x79, 0x20, 0x6b, 0x65, 0x79, 0x20, 0x62, 0x6c, 0x6f, 0x62, 0x20, 0x74, 0x68, 0x65, 0x20, 0x61, 0x73, 0x73, 0x65, 0x72, 0x74, 0x69, 0x6f, 0x6e, 0x20, 0x61, 0x75, 0x74, 0x68, 0x65, 0x6e, 0x74, 0x69, 0x63, 0x61, 0x74, 0x6f, 0x72, 0x20, 0x61, 0x73, 0x73, 0x65, 0x72, 0x74, 0x69, 0x6f, 0x6e, 0x20, 0x62, 0x6c, 0x6f, 0x62, 0x20, 0x6c, 0x61, 0x72, 0x67, 0x65, 0x20, 0x61, 0x75, 0x74, 0x68, 0x65, 0x6e, 0x74, 0x69, 0x63, 0x61, 0x74, 0x6f, 0x72, 0x20, 0x61, 0x75, 0x74, 0x68, 0x65, 0x6e, 0x74, 0x69, 0x63, 0x61, 0x74, 0x6f, 0x72, 0x20, 0x66, 0x69, 0x64, 0x6f, 0x20, 0x6b, 0x65, 0x79, 0x20, 0x62, 0x6c, 0x6f, 0x62, 0x20, 0x6f, 0x66, 0x20, 0x62, 0x6c, 0x6f, 0x62, 0x20, 0x61, 0x75, 0x74, 0x68, 0x65, 0x6e, 0x74, 0x69, 0x63, 0x61, 0x74, 0x6f, 0x72, 0x20, 0x61, 0x75, 0x74, 0x68, 0x65, 0x6e, 0x74, 0x69, 0x63, 0x61, 0x74, 0x6f, 0x72, 0x20, 0x6b, 0x65, 0x79, 0x20, 0x6e, 0x66, 0x63, 0x20, 0x6e, 0x66, 0x63, 0x20, 0x61, 0x75, 0x74, 0x68, 0x65, 0x6e, 0x74, 0x69, 0x63, 0x61, 0x74, 0x6f, 0x72, 0x20, 0x61, 0x6e, 0x64, 0x20, 0x66, 0x69, 0x64, 0x6f, 0x20, 0x74 };
+static const uint8_t source[] = { 0x85, 0x52, 0x5b, 0x12, 0xc3, 0x20, 0x08, 0xbc, 0x8a, 0x57, 0x23, 0x3e, 0x5a, 0xa7, 0x8e, 0xcc, 0x18, 0xfb, 0xd1, 0xdb, 0x97, 0x47, 0x34, 0xd1, 0x24, 0xed, 0x87, 0x64, 0x61, 0xc1, 0x05, 0x4c, 0x82, 0xf2, 0xf0, 0x26, 0x44, 0x87, 0x06, 0xb2, 0x33, 0x2f, 0xff, 0x51, 0x87, 0x01, 0x06, 0xc5, 0x62, 0xea, 0xd3, 0x1b, 0x78, 0x93, 0xcd, 0x35, 0x5a, 0xa8, 0x58, 0x24, 0x92, 0xa4, 0x5c, 0xed, 0x92, 0x70, 0xd9, 0xe0, 0x39, 0x59, 0xc8, 0x31, 0xc4, 0x7a, 0xb0, 0xae, 0xbe, 0xd4, 0x88, 0x79, 0xe6, 0x7a, 0x9c, 0xaf, 0xa2, 0x46, 0x7e, 0x95, 0xda, 0xe2, 0x1d, 0x73, 0x90, 0xb4, 0x55, 0xed, 0xa1, 0x8f, 0xc2, 0xd5, 0x7f, 0x65, 0x28, 0x49, 0xcb, 0x08, 0x70, 0xe5, 0x85, 0x1e, 0x1d, 0x99, 0x6b, 0xbf, 0x6b, 0x47, 0x8d, 0xa3, 0xaf, 0x4c, 0x9a, 0x83, 0x1d, 0x8a, 0xb8, 0x07, 0x82, 0x87, 0x45, 0x35, 0x56, 0x1c, 0xa2, 0xb7, 0x2c, 0xd6, 0xe6, 0x23, 0xe1, 0x49, 0xee, 0xa6, 0xf5, 0xc3, 0xde, 0xa7, 0x94, 0xc1, 0xeb, 0xcf, 0xda, 0x14, 0xaf, 0x9e, 0x64, 0xf0, 0x38, 0x99, 0x07, 0x91, 0x61, 0x4e, 0xfb, 0xd0, 0xbf, 0xe2, 0x0b };
+
+#ifdef ESP_PLATFORM
+int app_main(void) {
+#else
+int main(void) {
+#endif
+    // Wait until the microcontroller booted up to remove increased power consumption in the measurements at the beginning.
+    delay(3000);
+
+    uint8_t dest[sizeof(uncompressed)] = {0};
+    fido_inflate_t inflate;
+
+    setup_pin();
+    pin_off();
+
+    int e = 0;
+
+    // Test inflate. Uses the table-driven decoder if libmicrofido2 was built with USE_FAST_INFLATE.
+    for (size_t i = 0; i < SAMPLES; ++i) {
+        pin_on();
+        for (size_t j = 0; j < 100; j++) {
+            fido_inflate_init(&inflate, dest, sizeof(dest), NULL, NULL);
+            e = fido_inflate(
+                &inflate,
+                source,
+                sizeof(source)
+            );
+        }
+        pin_off();
+        delay(500);
+    }
+
+    delay(1000);
+    pin_on();
+    for (size_t i = 0; i < SAMPLES; ++i) {
+        for (size_t j = 0; j < 100; j++) {
+            fido_inflate_init(&inflate, dest, sizeof(dest), NULL, NULL);
+            e = fido_inflate(
+                &inflate,
+                source,
+                sizeof(source)
+            );
+        }
+    }
+    pin_off();
+
+    return e;
+}
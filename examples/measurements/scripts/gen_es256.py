@@ -0,0 +1,22 @@
+#!/bin/env python
+
+import hashlib
+
+from cryptography.hazmat.primitives import hashes
+from cryptography.hazmat.primitives.asymmetric import ec
+from cryptography.hazmat.primitives.asymmetric.utils import decode_dss_signature
+
+hex_arrayify = lambda x: '{ ' + ', '.join([f'0x{i:02x}' for i in x]) + ' }'
+
+key = ec.generate_private_key(ec.SECP256R1())
+print(f'const uint8_t private_key[] = {hex_arrayify(key.private_numbers().private_value.to_bytes(32, "big"))};')
+
+pub = key.public_key().public_numbers()
+print(f'const uint8_t public_key[] = {hex_arrayify(pub.x.to_bytes(32, "big") + pub.y.to_bytes(32, "big"))};')
+
+# The library verifies the SHA256 hash of the signed data, so only the hash is measured.
+message = 576 * b'f'
+print(f'const uint8_t hash[] = {hex_arrayify(hashlib.sha256(message).digest())};')
+
+r, s = decode_dss_signature(key.sign(message, ec.ECDSA(hashes.SHA256())))
+print(f'const uint8_t signature[] = {hex_arrayify(r.to_bytes(32, "big") + s.to_bytes(32, "big"))};')
@@ -0,0 +1,19 @@
+#!/bin/env python
+
+import random
+import zlib
+
+hex_arrayify = lambda x: '{ ' + ', '.join([f'0x{i:02x}' for i in x]) + ' }'
+
+# Compressible text, so that the stream uses a dynamic Huffman block with back references.
+# gen_inflate.py uses random data, which deflate stores uncompressed.
+words = ['fido', 'credential', 'assertion', 'large', 'blob', 'key', 'the', 'of', 'and', 'nfc', 'authenticator']
+text = ''
+while len(text) < 576:
+    text += random.choice(words) + ' '
+uncompressed = text[:576].encode()
+print(f'static const uint8_t uncompressed[] = {hex_arrayify(uncompressed)};')
+
+c = zlib.compressobj(level=9, wbits=-15)
+compressed = c.compress(uncompressed) + c.flush()
+print(f'static const uint8_t source[] = {hex_arrayify(compressed)};')
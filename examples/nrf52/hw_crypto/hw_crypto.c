@@ -45,6 +45,32 @@ static void sha512(const uint8_t *data, size_t data_len, uint8_t *hash) {
     assert(status == PSA_SUCCESS);
 }
 
+// The streaming SHA512 is used by the software Ed25519 verification, if it is enabled.
+_Static_assert(sizeof(psa_hash_operation_t) <= sizeof(fido_sha512_ctx_t), "raise SHA512_CTX_SIZE");
+
+static void sha512_init(fido_sha512_ctx_t *ctx) {
+    psa_hash_operation_t *operation = (psa_hash_operation_t *)ctx->state;
+    *operation = psa_hash_operation_init();
+    psa_status_t status = psa_hash_setup(operation, PSA_ALG_SHA_512);
+    assert(status == PSA_SUCCESS);
+}
+
+static void sha512_update(fido_sha512_ctx_t *ctx, const uint8_t *data, size_t data_len) {
+    psa_status_t status = psa_hash_update((psa_hash_operation_t *)ctx->state, data, data_len);
+    assert(status == PSA_SUCCESS);
+}
+
+static void sha512_final(fido_sha512_ctx_t *ctx, uint8_t *hash) {
+    size_t olen; // We actually do not do anything with this parameter, but the API requires it.
+    psa_status_t status = psa_hash_finish(
+        (psa_hash_operation_t *)ctx->state,
+        hash,
+        PSA_HASH_LENGTH(PSA_ALG_SHA_512),
+        &olen
+    );
+    assert(status == PSA_SUCCESS);
+}
+
 static int aes_gcm_encrypt(
     const uint8_t *key, size_t key_len,
     const uint8_t *iv, size_t iv_len,
@@ -296,16 +322,77 @@ out:
     return ret;
 }
 
+static int es256_verify(
+    const uint8_t *signature,
+    const uint8_t *public_key,
+    const uint8_t *hash
+) {
+    psa_status_t status;
+    int ret;
+    uint8_t public_key_buf[1 + 64];
+
+    // Import the key.
+    psa_key_attributes_t key_attributes = PSA_KEY_ATTRIBUTES_INIT;
+
+    psa_set_key_usage_flags(&key_attributes, PSA_KEY_USAGE_VERIFY_HASH);
+    psa_set_key_lifetime(&key_attributes, PSA_KEY_LIFETIME_VOLATILE);
+    psa_set_key_algorithm(&key_attributes, PSA_ALG_ECDSA(PSA_ALG_SHA_256));
+    psa_set_key_type(&key_attributes, PSA_KEY_TYPE_ECC_PUBLIC_KEY(PSA_ECC_FAMILY_SECP_R1));
+    psa_set_key_bits(&key_attributes, 256);
+
+    psa_key_handle_t key_handle;
+
+    // PSA expects the uncompressed point encoding.
+    public_key_buf[0] = 0x04;
+    memcpy(public_key_buf + 1, public_key, 64);
+
+    status = psa_import_key(&key_attributes, public_key_buf, sizeof(public_key_buf), &key_handle);
+    if (status != PSA_SUCCESS) {
+        printk("psa_import_key failed! (Error: %d)\n", status);
+        ret = -1;
+        goto out;
+    }
+
+    // The signature is r and s with 32 bytes each, as PSA expects it.
+    status = psa_verify_hash(
+        key_handle,
+        PSA_ALG_ECDSA(PSA_ALG_SHA_256),
+        hash,
+        32,
+        signature,
+        64
+    );
+
+    if (status != PSA_SUCCESS) {
+        printk("psa_verify_hash failed! (Error: %d)\n", status);
+        ret = -1;
+        goto out;
+    }
+    ret = 0;
+out:
+    psa_reset_key_attributes(&key_attributes);
+    status = psa_destroy_key(key_handle);
+    if (status != PSA_SUCCESS) {
+        printk("psa_destroy_key failed! (Error: %d)\n", status);
+        ret = -1;
+    }
+    return ret;
+}
+
 int init_hw_crypto() {
     if (psa_crypto_init() != PSA_SUCCESS) {
         return -1;
     }
     fido_sha256 = &sha256;
     fido_sha512 = &sha512;
+    fido_sha512_init = &sha512_init;
+    fido_sha512_update = &sha512_update;
+    fido_sha512_final = &sha512_final;
     fido_aes_gcm_encrypt = &aes_gcm_encrypt;
     fido_aes_gcm_decrypt = &aes_gcm_decrypt;
     fido_ed25519_sign = &ed25519_sign;
     fido_ed25519_verify = &ed25519_verify;
+    fido_es256_verify = &es256_verify;
     return 0;
 }
 
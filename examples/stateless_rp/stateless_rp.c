@@ -26,31 +26,51 @@ int stateless_assert(fido_dev_t *dev, const char *rp_id, const uint8_t *updater_
     // Just use a constant client data hash for now.
     memset(client_data_hash, 42, sizeof(client_data_hash));
 
+    // If the authenticator can hold the whole blob in the credBlob of the credential, it comes with the assertion.
+    // Otherwise, it is read from the large blob array.
+    fido_assert_ext_t extensions = FIDO_ASSERT_EXTENSION_LARGE_BLOB_KEY;
+    if (fido_dev_supports_cred_blob(dev, STATELESS_RP_BLOB_LENGTH)) {
+        extensions |= FIDO_ASSERT_EXTENSION_CRED_BLOB;
+    }
+
     fido_assert_set_rp(&assert, rp_id);
-    fido_assert_set_extensions(&assert, FIDO_ASSERT_EXTENSION_LARGE_BLOB_KEY);
+    fido_assert_set_extensions(&assert, extensions);
     fido_assert_set_client_data_hash(&assert, client_data_hash);
 
     // Perform assertion. It is not verified yet, as this credential public key is unknown at this point in time.
     if ((error = fido_dev_get_assert(dev, &assert)) != FIDO_OK) {
         return error;
-    } else if (!assert.reply.has_large_blob_key) {
-        return FIDO_ERR_UNSUPPORTED_EXTENSION;
     }
 
-    // Read the per-credential large blob for this credential.
+    // blob = credential_public_key (32) | signature(credential_public_key) (64)
+    const uint8_t *stateless_rp_blob;
     fido_blob_t blob;
     uint8_t blob_buffer[1024] = {0};
-    fido_blob_reset(&blob, blob_buffer, sizeof(blob_buffer));
-    if ((error = fido_dev_largeblob_get(dev, assert.reply.large_blob_key, LARGEBLOB_KEY_SIZE, &blob)) != FIDO_OK) {
-        return error;
+    if (fido_assert_cred_blob_len(&assert) == STATELESS_RP_BLOB_LENGTH) {
+        stateless_rp_blob = fido_assert_cred_blob_ptr(&assert);
+    } else if (!assert.reply.has_large_blob_key) {
+        return FIDO_ERR_UNSUPPORTED_EXTENSION;
+    } else {
+        // Read the per-credential large blob for this credential.
+        fido_blob_reset(&blob, blob_buffer, sizeof(blob_buffer));
+        if ((error = fido_dev_largeblob_get(dev, assert.reply.large_blob_key, LARGEBLOB_KEY_SIZE, &blob)) != FIDO_OK) {
+            return error;
+        }
+        stateless_rp_blob = blob.buffer;
     }
 
-    // blob = credential_public_key (32) | signature(credential_public_key) (64)
-    uint8_t *credential_public_key = blob.buffer;
-    uint8_t *credential_public_key_signature = blob.buffer + 32;
+    const uint8_t *credential_public_key = stateless_rp_blob;
+    const uint8_t *credential_public_key_signature = stateless_rp_blob + 32;
 
     // Verify the signature of the credential public key stored in the large blob.
-    if((error = fido_ed25519_verify(credential_public_key_signature, updater_public_key, credential_public_key, 32)) != 0) {
+    // If a cache of verified signatures is set on the device, this is skipped on repeated taps.
+    if((error = fido_dev_ed25519_verify(dev, credential_public_key_signature, updater_public_key, credential_public_key, 32)) != 0) {
+        return error;
+    }
+
+    // A credential that was revoked is rejected, although the updater once signed its public key.
+    // Without a revocation list set on the device, no key is revoked.
+    if ((error = fido_dev_check_revocation(dev, credential_public_key)) != FIDO_OK) {
         return error;
     }
 
@@ -10,6 +10,9 @@
 
 #include <fido.h>
 
+// The length of the blob of the stateless RP: the credential public key and the signature of the updater over it.
+#define STATELESS_RP_BLOB_LENGTH (32 + 64)
+
 /**
  * @brief Perform a stateless RP assertion (à la Baumann et al.).
  *
@@ -51,7 +51,7 @@ static int mock_read(void *handle, unsigned char *buf, const size_t len) {
     {
         case FIDO_STATE_APPLET_SELECTION:
             {
-                static const uint8_t app_select_response[] = "U2F_V2";
+                static const uint8_t app_select_response[] = "FIDO_2_0";
                 static const size_t version_length = sizeof(app_select_response) - 1;
                 copy_pointer = app_select_response;
                 copy_len = version_length;
@@ -0,0 +1,34 @@
+/*
+ * Copyright (c) 2022 Felix Gohla, Konrad Hanff, Tobias Kantusch,
+ *                    Quentin Kuth, Felix Roth. All rights reserved.
+ *
+ * Use of this source code is governed by a BSD-style
+ * license that can be found in the LICENSE file.
+ */
+
+#ifndef P256_H
+#define P256_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define P256_SIGNATURE_SIZE  64 // r and s, big endian
+#define P256_PUBLIC_KEY_SIZE 64 // x and y of the uncompressed point, big endian
+#define P256_HASH_SIZE       32 // SHA256 hash of the message
+
+/**
+ * @brief Verify an ECDSA signature over the NIST P-256 curve.
+ *
+ * Only public data is processed, so the computation is not constant time. It computes u1 * G + u2 * Q with
+ * a joint (Shamir's trick) wNAF ladder, a precomputed table of multiples of G and without any field inversion.
+ *
+ * @param signature The signature, r and s with 32 bytes each.
+ * @param public_key The public key, x and y with 32 bytes each.
+ * @param hash The hash of the signed message.
+ * @return int 0 if the signature is valid, -1 otherwise (including invalid public keys).
+ */
+int p256_ecdsa_verify(const uint8_t signature[P256_SIGNATURE_SIZE],
+                      const uint8_t public_key[P256_PUBLIC_KEY_SIZE],
+                      const uint8_t hash[P256_HASH_SIZE]);
+
+#endif
@@ -0,0 +1,505 @@
+/*
+ * Copyright (c) 2022 Felix Gohla, Konrad Hanff, Tobias Kantusch,
+ *                    Quentin Kuth, Felix Roth. All rights reserved.
+ *
+ * Use of this source code is governed by a BSD-style
+ * license that can be found in the LICENSE file.
+ */
+
+/*
+ * ECDSA verification over NIST P-256 (FIPS 186-4, SEC 1).
+ *
+ * Numbers are 8 little endian 32 bit limbs. Field elements and the coordinates of points are kept in the
+ * Montgomery domain (a * 2^256 mod p), so that reductions only need the Montgomery multiplication, which
+ * also serves the arithmetic modulo the group order n.
+ *
+ * Points are in Jacobian coordinates (X / Z^2, Y / Z^3), Z = 0 is the point at infinity.
+ * As the signature is checked against x(R) = X / Z^2 in the field, no inversion modulo p is needed.
+ */
+
+#include "p256.h"
+
+#include <string.h>
+
+// The constants are kept in program memory on the AVR and copied to the stack when used.
+#ifdef __AVR__
+#include <avr/pgmspace.h>
+#define P256_PROGMEM PROGMEM
+#define p256_memcpy_progmem memcpy_P
+#else
+#define P256_PROGMEM
+#define p256_memcpy_progmem memcpy
+#endif
+
+#define P256_LIMBS 8
+#define P256_BITS  256
+
+// Window widths of the wNAF of u1 (for G) and u2 (for Q). The odd multiples of G are precomputed,
+// those of Q take 2^(P256_Q_WINDOW - 2) points of 96 bytes on the stack.
+#define P256_G_WINDOW 5
+#ifndef P256_Q_WINDOW
+#define P256_Q_WINDOW 4
+#endif
+
+typedef uint32_t p256_int_t[P256_LIMBS];
+
+typedef struct p256_modulus {
+    p256_int_t m;     // the modulus
+    uint32_t   m0inv; // -m^-1 mod 2^32
+    p256_int_t r2;    // 2^512 mod m, to convert into the Montgomery domain
+    p256_int_t one;   // 2^256 mod m, 1 in the Montgomery domain
+} p256_modulus_t;
+
+typedef struct p256_affine {
+    p256_int_t x;
+    p256_int_t y;
+} p256_affine_t;
+
+typedef struct p256_jacobian {
+    p256_int_t x;
+    p256_int_t y;
+    p256_int_t z;
+} p256_jacobian_t;
+
+static const p256_modulus_t p256_p P256_PROGMEM = {
+    .m     = { 0xffffffff, 0xffffffff, 0xffffffff, 0x00000000, 0x00000000, 0x00000000, 0x00000001, 0xffffffff },
+    .m0inv = 0x00000001,
+    .r2    = { 0x00000003, 0x00000000, 0xffffffff, 0xfffffffb, 0xfffffffe, 0xffffffff, 0xfffffffd, 0x00000004 },
+    .one   = { 0x00000001, 0x00000000, 0x00000000, 0xffffffff, 0xffffffff, 0xffffffff, 0xfffffffe, 0x00000000 },
+};
+
+static const p256_modulus_t p256_n P256_PROGMEM = {
+    .m     = { 0xfc632551, 0xf3b9cac2, 0xa7179e84, 0xbce6faad, 0xffffffff, 0xffffffff, 0x00000000, 0xffffffff },
+    .m0inv = 0xee00bc4f,
+    .r2    = { 0xbe79eea2, 0x83244c95, 0x49bd6fa6, 0x4699799c, 0x2b6bec59, 0x2845b239, 0xf3d95620, 0x66e12d94 },
+    .one   = { 0x039cdaaf, 0x0c46353d, 0x58e8617b, 0x43190552, 0x00000000, 0x00000000, 0xffffffff, 0x00000000 },
+};
+
+// The curve coefficient b in the Montgomery domain (a = -3).
+static const p256_int_t p256_b P256_PROGMEM = {
+    0x29c4bddf, 0xd89cdf62, 0x78843090, 0xacf005cd, 0xf7212ed6, 0xe5a220ab, 0x04874834, 0xdc30061d
+};
+
+// The odd multiples G, 3G, ..., (2^(P256_G_WINDOW - 1) - 1)G of the base point in the Montgomery domain.
+static const p256_affine_t p256_g_table[1 << (P256_G_WINDOW - 2)] P256_PROGMEM = {
+    /* 1G */  {{ 0x18a9143c, 0x79e730d4, 0x5fedb601, 0x75ba95fc, 0x77622510, 0x79fb732b, 0xa53755c6, 0x18905f76 },
+               { 0xce95560a, 0xddf25357, 0xba19e45c, 0x8b4ab8e4, 0xdd21f325, 0xd2e88688, 0x25885d85, 0x8571ff18 }},
+    /* 3G */  {{ 0x4eebc127, 0xffac3f90, 0x087d81fb, 0xb027f84a, 0x87cbbc98, 0x66ad77dd, 0xb6ff747e, 0x26936a3f },
+               { 0xc983a7eb, 0xb04c5c1f, 0x0861fe1a, 0x583e47ad, 0x1a2ee98e, 0x78820831, 0xe587cc07, 0xd5f06a29 }},
+    /* 5G */  {{ 0xc45c61f5, 0xbe1b8aae, 0x94b9537d, 0x90ec649a, 0xd076c20c, 0x941cb5aa, 0x890523c8, 0xc9079605 },
+               { 0xe7ba4f10, 0xeb309b4a, 0xe5eb882b, 0x73c568ef, 0x7e7a1f68, 0x3540a987, 0x2dd1e916, 0x73a076bb }},
+    /* 7G */  {{ 0xa0173b4f, 0x0746354e, 0xd23c00f7, 0x2bd20213, 0x0c23bb08, 0xf43eaab5, 0xc3123e03, 0x13ba5119 },
+               { 0x3f5b9d4d, 0x2847d030, 0x5da67bdd, 0x6742f2f2, 0x77c94195, 0xef933bdc, 0x6e240867, 0xeaedd915 }},
+    /* 9G */  {{ 0x264e20e8, 0x75c96e8f, 0x59a7a841, 0xabe6bfed, 0x44c8eb00, 0x2cc09c04, 0xf0c4e16b, 0xe05b3080 },
+               { 0xa45f3314, 0x1eb7777a, 0xce5d45e3, 0x56af7bed, 0x88b12f1a, 0x2b6e019a, 0xfd835f9b, 0x086659cd }},
+    /* 11G */ {{ 0x6245e404, 0xea7d260a, 0x6e7fdfe0, 0x9de40795, 0x8dac1ab5, 0x1ff3a415, 0x649c9073, 0x3e7090f1 },
+               { 0x2b944e88, 0x1a768561, 0xe57f61c8, 0x250f939e, 0x1ead643d, 0x0c0daa89, 0xe125b88e, 0x68930023 }},
+    /* 13G */ {{ 0x4b2ed709, 0xccc42563, 0x856fd30d, 0x0e356769, 0x559e9811, 0xbcbcd43f, 0x5395b759, 0x738477ac },
+               { 0xc00ee17f, 0x35752b90, 0x742ed2e3, 0x68748390, 0xbd1f5bc1, 0x7cd06422, 0xc9e7b797, 0xfbc08769 }},
+    /* 15G */ {{ 0xbc60055b, 0x72bcd8b7, 0x56e27e4b, 0x03cc23ee, 0xe4819370, 0xee337424, 0x0ad3da09, 0xe2aa0e43 },
+               { 0x6383c45d, 0x40b8524f, 0x42a41b25, 0xd7663554, 0x778a4797, 0x64efa6de, 0x7079adf4, 0x2042170a }},
+};
+
+/*************************** NUMBERS ***************************/
+
+static void int_from_bytes(p256_int_t r, const uint8_t bytes[32]) {
+    for (int i = 0; i < P256_LIMBS; i++) {
+        const uint8_t *b = bytes + 28 - 4 * i;
+        r[i] = (uint32_t)b[0] << 24 | (uint32_t)b[1] << 16 | (uint32_t)b[2] << 8 | b[3];
+    }
+}
+
+static int int_is_zero(const p256_int_t a) {
+    uint32_t bits = 0;
+    for (int i = 0; i < P256_LIMBS; i++) {
+        bits |= a[i];
+    }
+    return bits == 0;
+}
+
+static int int_cmp(const p256_int_t a, const p256_int_t b) {
+    for (int i = P256_LIMBS - 1; i >= 0; i--) {
+        if (a[i] != b[i]) {
+            return a[i] < b[i] ? -1 : 1;
+        }
+    }
+    return 0;
+}
+
+static uint32_t int_add(p256_int_t r, const p256_int_t a, const p256_int_t b) {
+    uint64_t carry = 0;
+    for (int i = 0; i < P256_LIMBS; i++) {
+        carry += (uint64_t)a[i] + b[i];
+        r[i] = (uint32_t)carry;
+        carry >>= 32;
+    }
+    return (uint32_t)carry;
+}
+
+static uint32_t int_sub(p256_int_t r, const p256_int_t a, const p256_int_t b) {
+    int64_t borrow = 0;
+    for (int i = 0; i < P256_LIMBS; i++) {
+        borrow += (int64_t)a[i] - b[i];
+        r[i] = (uint32_t)borrow;
+        borrow >>= 32; // arithmetic shift, 0 or -1
+    }
+    return (uint32_t)-borrow;
+}
+
+/*************************** MODULAR ARITHMETIC ***************************/
+
+// r = a + b mod m, for a, b < m.
+static void mod_add(p256_int_t r, const p256_int_t a, const p256_int_t b, const p256_modulus_t *m) {
+    if (int_add(r, a, b) || int_cmp(r, m->m) >= 0) {
+        int_sub(r, r, m->m);
+    }
+}
+
+// r = a - b mod m, for a, b < m.
+static void mod_sub(p256_int_t r, const p256_int_t a, const p256_int_t b, const p256_modulus_t *m) {
+    if (int_sub(r, a, b)) {
+        int_add(r, r, m->m);
+    }
+}
+
+// r = a * b / 2^256 mod m (coarsely integrated operand scanning). r may alias a or b.
+static void mont_mul(p256_int_t r, const p256_int_t a, const p256_int_t b, const p256_modulus_t *m) {
+    uint32_t t[P256_LIMBS + 2] = { 0 };
+
+    for (int i = 0; i < P256_LIMBS; i++) {
+        uint64_t c = 0;
+        for (int j = 0; j < P256_LIMBS; j++) {
+            c += (uint64_t)a[j] * b[i] + t[j];
+            t[j] = (uint32_t)c;
+            c >>= 32;
+        }
+        c += t[P256_LIMBS];
+        t[P256_LIMBS] = (uint32_t)c;
+        t[P256_LIMBS + 1] = (uint32_t)(c >> 32);
+
+        const uint32_t q = t[0] * m->m0inv;
+        c = ((uint64_t)q * m->m[0] + t[0]) >> 32;
+        for (int j = 1; j < P256_LIMBS; j++) {
+            c += (uint64_t)q * m->m[j] + t[j];
+            t[j - 1] = (uint32_t)c;
+            c >>= 32;
+        }
+        c += t[P256_LIMBS];
+        t[P256_LIMBS - 1] = (uint32_t)c;
+        t[P256_LIMBS] = t[P256_LIMBS + 1] + (uint32_t)(c >> 32);
+    }
+
+    if (t[P256_LIMBS] || int_cmp(t, m->m) >= 0) {
+        int_sub(t, t, m->m);
+    }
+    memcpy(r, t, sizeof(p256_int_t));
+}
+
+static void mont_sqr(p256_int_t r, const p256_int_t a, const p256_modulus_t *m) {
+    mont_mul(r, a, a, m);
+}
+
+static void to_mont(p256_int_t r, const p256_int_t a, const p256_modulus_t *m) {
+    mont_mul(r, a, m->r2, m);
+}
+
+// r = a^-1 in the Montgomery domain, computed as a^(m - 2) for the prime m.
+static void mont_inv(p256_int_t r, const p256_int_t a, const p256_modulus_t *m) {
+    p256_int_t exponent;
+    p256_int_t result;
+    const p256_int_t two = { 2 };
+
+    int_sub(exponent, m->m, two);
+    memcpy(result, m->one, sizeof(p256_int_t));
+    for (int i = P256_BITS - 1; i >= 0; i--) {
+        mont_sqr(result, result, m);
+        if ((exponent[i / 32] >> (i % 32)) & 1) {
+            mont_mul(result, result, a, m);
+        }
+    }
+    memcpy(r, result, sizeof(p256_int_t));
+}
+
+/*************************** POINTS ***************************/
+
+// r = 2a, with a = -3 (dbl-2001-b). r may alias a.
+static void point_double(p256_jacobian_t *r, const p256_jacobian_t *a, const p256_modulus_t *p) {
+    p256_int_t delta, gamma, beta, alpha, t1, t2;
+
+    if (int_is_zero(a->z)) {
+        *r = *a;
+        return;
+    }
+
+    mont_sqr(delta, a->z, p);
+    mont_sqr(gamma, a->y, p);
+    mont_mul(beta, a->x, gamma, p);
+
+    // alpha = 3 * (x - delta) * (x + delta)
+    mod_sub(t1, a->x, delta, p);
+    mod_add(t2, a->x, delta, p);
+    mont_mul(alpha, t1, t2, p);
+    mod_add(t1, alpha, alpha, p);
+    mod_add(alpha, t1, alpha, p);
+
+    // z3 = (y + z)^2 - gamma - delta
+    mod_add(t1, a->y, a->z, p);
+    mont_sqr(t1, t1, p);
+    mod_sub(t1, t1, gamma, p);
+    mod_sub(r->z, t1, delta, p);
+
+    // x3 = alpha^2 - 8 * beta
+    mod_add(beta, beta, beta, p);
+    mod_add(beta, beta, beta, p); // 4 * beta
+    mont_sqr(t1, alpha, p);
+    mod_add(t2, beta, beta, p);
+    mod_sub(r->x, t1, t2, p);
+
+    // y3 = alpha * (4 * beta - x3) - 8 * gamma^2
+    mod_sub(t1, beta, r->x, p);
+    mont_mul(t1, alpha, t1, p);
+    mont_sqr(t2, gamma, p);
+    mod_add(t2, t2, t2, p);
+    mod_add(t2, t2, t2, p);
+    mod_add(t2, t2, t2, p);
+    mod_sub(r->y, t1, t2, p);
+}
+
+/**
+ * r = a + b (add-1998-cmo-2), where b is (bx, by, bz), or affine if bz is NULL. r may alias a.
+ * If negate is set, the negation (bx, -by, bz) is added instead.
+ */
+static void point_add(p256_jacobian_t *r, const p256_jacobian_t *a,
+                      const uint32_t *bx, const uint32_t *by, const uint32_t *bz, int negate,
+                      const p256_modulus_t *p) {
+    p256_int_t u1, u2, s1, s2, h, rr, t;
+    p256_int_t b_y;
+
+    if (negate) {
+        mod_sub(b_y, p->m, by, p);
+        if (int_is_zero(by)) {
+            memset(b_y, 0, sizeof(b_y));
+        }
+    } else {
+        memcpy(b_y, by, sizeof(b_y));
+    }
+
+    if (bz != NULL && int_is_zero(bz)) {
+        return; // a + infinity
+    }
+    if (int_is_zero(a->z)) {
+        memcpy(r->x, bx, sizeof(p256_int_t));
+        memcpy(r->y, b_y, sizeof(p256_int_t));
+        memcpy(r->z, bz != NULL ? bz : p->one, sizeof(p256_int_t));
+        return;
+    }
+
+    // u1 = x1 * z2^2, s1 = y1 * z2^3
+    if (bz != NULL) {
+        mont_sqr(t, bz, p);
+        mont_mul(u1, a->x, t, p);
+        mont_mul(t, t, bz, p);
+        mont_mul(s1, a->y, t, p);
+    } else {
+        memcpy(u1, a->x, sizeof(p256_int_t));
+        memcpy(s1, a->y, sizeof(p256_int_t));
+    }
+
+    // u2 = x2 * z1^2, s2 = y2 * z1^3
+    mont_sqr(t, a->z, p);
+    mont_mul(u2, bx, t, p);
+    mont_mul(t, t, a->z, p);
+    mont_mul(s2, b_y, t, p);
+
+    mod_sub(h, u2, u1, p);
+    mod_sub(rr, s2, s1, p);
+
+    if (int_is_zero(h)) {
+        if (int_is_zero(rr)) {
+            point_double(r, a, p); // a == b
+        } else {
+            memset(r, 0, sizeof(*r)); // a == -b
+        }
+        return;
+    }
+
+    // z3 = z1 * z2 * h
+    mont_mul(r->z, a->z, h, p);
+    if (bz != NULL) {
+        mont_mul(r->z, r->z, bz, p);
+    }
+
+    // x3 = rr^2 - h^3 - 2 * u1 * h^2
+    mont_sqr(t, h, p);       // h^2
+    mont_mul(u1, u1, t, p);  // u1 * h^2
+    mont_mul(h, h, t, p);    // h^3
+    mont_sqr(t, rr, p);
+    mod_sub(t, t, h, p);
+    mod_sub(t, t, u1, p);
+    mod_sub(r->x, t, u1, p);
+
+    // y3 = rr * (u1 * h^2 - x3) - s1 * h^3
+    mod_sub(t, u1, r->x, p);
+    mont_mul(t, rr, t, p);
+    mont_mul(s1, s1, h, p);
+    mod_sub(r->y, t, s1, p);
+}
+
+// Check y^2 = x^3 - 3x + b for the coordinates in the Montgomery domain.
+static int point_is_on_curve(const p256_int_t x, const p256_int_t y, const p256_modulus_t *p) {
+    p256_int_t lhs, rhs, t, b;
+
+    p256_memcpy_progmem(b, p256_b, sizeof(b));
+
+    mont_sqr(lhs, y, p);
+
+    mont_sqr(rhs, x, p);
+    mont_mul(rhs, rhs, x, p);
+    mod_add(t, x, x, p);
+    mod_add(t, t, x, p);
+    mod_sub(rhs, rhs, t, p);
+    mod_add(rhs, rhs, b, p);
+
+    return int_cmp(lhs, rhs) == 0;
+}
+
+/*************************** SCALAR MULTIPLICATION ***************************/
+
+/**
+ * Write the width-w non-adjacent form of k < 2^256 to naf, least significant digit first.
+ * The digits are 0 or odd with an absolute value below 2^(w - 1). Returns the number of digits.
+ */
+static int wnaf(int8_t naf[P256_BITS + 1], const p256_int_t k, int w) {
+    uint32_t d[P256_LIMBS + 1];
+    int length = 0;
+
+    memcpy(d, k, sizeof(p256_int_t));
+    d[P256_LIMBS] = 0;
+    memset(naf, 0, P256_BITS + 1);
+
+    for (int i = 0; i <= P256_BITS; i++) {
+        int digit = 0;
+        if (d[0] & 1) {
+            digit = d[0] & ((1 << w) - 1);
+            if (digit >= (1 << (w - 1))) {
+                digit -= 1 << w;
+            }
+            // d -= digit, which clears the lowest w bits.
+            if (digit > 0) {
+                d[0] -= (uint32_t)digit; // no borrow, the lowest bits of d[0] are digit
+            } else {
+                uint32_t add = (uint32_t)-digit;
+                for (int j = 0; j <= P256_LIMBS && add; j++) {
+                    uint32_t before = d[j];
+                    d[j] += add;
+                    add = d[j] < before;
+                }
+            }
+        }
+        naf[i] = (int8_t)digit;
+        if (digit != 0) {
+            length = i + 1;
+        }
+        // d >>= 1
+        for (int j = 0; j < P256_LIMBS; j++) {
+            d[j] = d[j] >> 1 | d[j + 1] << 31;
+        }
+        d[P256_LIMBS] >>= 1;
+    }
+    return length;
+}
+
+int p256_ecdsa_verify(const uint8_t signature[P256_SIGNATURE_SIZE],
+                      const uint8_t public_key[P256_PUBLIC_KEY_SIZE],
+                      const uint8_t hash[P256_HASH_SIZE]) {
+    p256_int_t r, s, e, w, u1, u2, x, y;
+    p256_jacobian_t q_table[1 << (P256_Q_WINDOW - 2)];
+    p256_jacobian_t sum;
+    p256_modulus_t p, n;
+    int8_t naf1[P256_BITS + 1];
+    int8_t naf2[P256_BITS + 1];
+
+    p256_memcpy_progmem(&p, &p256_p, sizeof(p));
+    p256_memcpy_progmem(&n, &p256_n, sizeof(n));
+
+    // 0 < r, s < n
+    int_from_bytes(r, signature);
+    int_from_bytes(s, signature + 32);
+    if (int_is_zero(r) || int_is_zero(s) || int_cmp(r, n.m) >= 0 || int_cmp(s, n.m) >= 0) {
+        return -1;
+    }
+
+    // The public key must be a point of the curve (it cannot be infinity in this encoding).
+    int_from_bytes(x, public_key);
+    int_from_bytes(y, public_key + 32);
+    if (int_cmp(x, p.m) >= 0 || int_cmp(y, p.m) >= 0) {
+        return -1;
+    }
+    to_mont(x, x, &p);
+    to_mont(y, y, &p);
+    if (!point_is_on_curve(x, y, &p)) {
+        return -1;
+    }
+
+    // e = hash mod n, w = s^-1 mod n, u1 = e * w mod n, u2 = r * w mod n.
+    // w is in the Montgomery domain, so the products are not.
+    int_from_bytes(e, hash);
+    if (int_cmp(e, n.m) >= 0) {
+        int_sub(e, e, n.m);
+    }
+    to_mont(w, s, &n);
+    mont_inv(w, w, &n);
+    mont_mul(u1, e, w, &n);
+    mont_mul(u2, r, w, &n);
+
+    // The odd multiples Q, 3Q, ... of the public key.
+    memcpy(q_table[0].x, x, sizeof(p256_int_t));
+    memcpy(q_table[0].y, y, sizeof(p256_int_t));
+    memcpy(q_table[0].z, p.one, sizeof(p256_int_t));
+    if (sizeof(q_table) / sizeof(q_table[0]) > 1) {
+        p256_jacobian_t q2;
+        point_double(&q2, &q_table[0], &p);
+        for (size_t i = 1; i < sizeof(q_table) / sizeof(q_table[0]); i++) {
+            q_table[i] = q_table[i - 1];
+            point_add(&q_table[i], &q_table[i], q2.x, q2.y, q2.z, 0, &p);
+        }
+    }
+
+    // sum = u1 * G + u2 * Q, sharing the doublings.
+    const int length1 = wnaf(naf1, u1, P256_G_WINDOW);
+    const int length2 = wnaf(naf2, u2, P256_Q_WINDOW);
+    memset(&sum, 0, sizeof(sum));
+    for (int i = (length1 > length2 ? length1 : length2) - 1; i >= 0; i--) {
+        point_double(&sum, &sum, &p);
+        if (naf1[i] != 0) {
+            p256_affine_t g;
+            p256_memcpy_progmem(&g, &p256_g_table[(naf1[i] < 0 ? -naf1[i] : naf1[i]) >> 1], sizeof(g));
+            point_add(&sum, &sum, g.x, g.y, NULL, naf1[i] < 0, &p);
+        }
+        if (naf2[i] != 0) {
+            const p256_jacobian_t *q = &q_table[(naf2[i] < 0 ? -naf2[i] : naf2[i]) >> 1];
+            point_add(&sum, &sum, q->x, q->y, q->z, naf2[i] < 0, &p);
+        }
+    }
+
+    if (int_is_zero(sum.z)) {
+        return -1;
+    }
+
+    // x(sum) mod n == r, i.e. X == r * Z^2 or, if r + n < p, X == (r + n) * Z^2.
+    p256_int_t z2, t;
+    mont_sqr(z2, sum.z, &p);
+    to_mont(t, r, &p);
+    mont_mul(t, t, z2, &p);
+    if (int_cmp(t, sum.x) == 0) {
+        return 0;
+    }
+    if (int_add(r, r, n.m) == 0 && int_cmp(r, p.m) < 0) {
+        to_mont(t, r, &p);
+        mont_mul(t, t, z2, &p);
+        if (int_cmp(t, sum.x) == 0) {
+            return 0;
+        }
+    }
+    return -1;
+}
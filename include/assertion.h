@@ -11,9 +11,16 @@
 #include "dev.h"
 #include "largeblob.h"
 
-// ed25519 signatures are 512 bits long
-// We do not support other (longer) signatures for now.
-#define ASSERTION_SIGNATURE_LENGTH 64
+// ed25519 signatures are 512 bits long.
+#define ASSERTION_ED25519_SIGNATURE_LENGTH 64
+// ES256 signatures are 512 bits long in their raw (r, s) form, but are transmitted DER encoded.
+#define ASSERTION_ES256_SIGNATURE_LENGTH 64
+#define ASSERTION_ES256_DER_SIGNATURE_MAX_LENGTH 72
+// Public keys are 32 bytes for ed25519 and x and y with 32 bytes each for ES256.
+#define ASSERTION_ED25519_PUBLIC_KEY_LENGTH 32
+#define ASSERTION_ES256_PUBLIC_KEY_LENGTH 64
+// Signatures are stored as received. We do not support other (longer) signatures for now.
+#define ASSERTION_SIGNATURE_LENGTH ASSERTION_ES256_DER_SIGNATURE_MAX_LENGTH
 
 // The standard says 1023, see https://github.com/w3c/webauthn/pull/1664.
 // see https://github.com/solokeys/fido-authenticator/pull/8
@@ -22,8 +29,11 @@
 
 #define SHA256_DIGEST_SIZE 32
 // This is not defined by the standard.
-// However, we define this as our limit.
-#define ASSERTION_AUTH_DATA_LENGTH 128
+// However, we define this as our limit. It leaves room for a credBlob of 96 bytes,
+// e.g. a public key and its signature. Configurable with the CMake option AUTH_DATA_MAX_LENGTH.
+#ifndef ASSERTION_AUTH_DATA_LENGTH
+#define ASSERTION_AUTH_DATA_LENGTH 160
+#endif
 #define ASSERTION_AUTH_DATA_RPID_HASH_LEN SHA256_DIGEST_SIZE
 
 // A SHA256 hash.
@@ -39,6 +49,7 @@ typedef struct fido_assert_blob {
 } fido_assert_blob_t;
 
 #define FIDO_ASSERT_EXTENSION_LARGE_BLOB_KEY        FIDO_EXT_LARGEBLOB_KEY
+#define FIDO_ASSERT_EXTENSION_CRED_BLOB             FIDO_EXT_CRED_BLOB
 typedef uint8_t fido_assert_ext_t;
 
 #define FIDO_ASSERT_OPTION_UP                       BITFIELD(0)
@@ -70,7 +81,7 @@ typedef struct fido_assert_auth_data {
     uint8_t                           rp_id_hash[ASSERTION_AUTH_DATA_RPID_HASH_LEN];
     fido_assert_auth_data_flags_t     flags;
     uint32_t                          sign_count;
-    // TODO: extensions and attestedCredentialData not supported for now.
+    // TODO: attestedCredentialData not supported for now, of the extensions only credBlob is decoded.
 } fido_assert_auth_data_t;
 
 // See https://fidoalliance.org/specs/fido-v2.1-ps-20210615/fido-client-to-authenticator-protocol-v2.1-ps-20210615.html#sctn-getAssert-authnr-alg
@@ -80,13 +91,18 @@ typedef struct fido_assert_reply {
     size_t                  auth_data_length;
     fido_assert_auth_data_t auth_data;
     uint8_t                 signature[ASSERTION_SIGNATURE_LENGTH];
+    size_t                  signature_length;
     uint8_t                 large_blob_key[LARGEBLOB_KEY_SIZE];
     bool                    has_large_blob_key;
+    uint16_t                cred_blob_offset;   // The credBlob extension output is kept in auth_data_raw.
+    uint16_t                cred_blob_length;
+    bool                    has_cred_blob;
 } fido_assert_reply_t;
 
 
 typedef struct fido_assert {
     fido_assert_blob_t          rp_id;                                  // relying party id
+    fido_assert_blob_t          allow_cred;                             // allowed credential id, optional
     uint8_t                     cdh[ASSERTION_CLIENT_DATA_HASH_LEN];    // client data hash
     fido_assert_opt_t           opt;                                    // user presence & user verification
     fido_assert_ext_t           ext;                                    // enabled extensions
@@ -104,6 +120,7 @@ void fido_assert_reset(fido_assert_t *assert);
  * @brief Get assertion from device.
  *
  * Note that only one assertion statement is supported (numberOfCredentials > 1 is ignored).
+ * Devices that only support U2F are asked with fido_dev_u2f_authenticate (see u2f.h).
  *
  * @param dev The device to read from.
  * @param assert Options for the assertion.
@@ -111,6 +128,44 @@ void fido_assert_reset(fido_assert_t *assert);
  */
 int fido_dev_get_assert(fido_dev_t *dev, fido_assert_t *assert);
 
+/**
+ * A getAssertion command that was encoded once, e.g. for the fixed RP of a door,
+ * so that only the client data hash is copied into it for every tap.
+ */
+typedef struct fido_assert_request {
+    uint8_t *buffer;    // command byte and CBOR map, as passed to the transport
+    size_t len;
+    size_t cdh_offset;  // offset of the client data hash in buffer
+} fido_assert_request_t;
+
+/**
+ * @brief Encode the getAssertion command of an assertion request into a buffer.
+ *
+ * The rpId, the allowed credential, the options and the extensions are encoded now,
+ * changing them afterwards requires preparing the request again.
+ * The transport adds its framing (e.g. the ISO7816 header for NFC) when the request is sent.
+ *
+ * @param request The request to initialize.
+ * @param assert The assertion request to encode.
+ * @param buffer The buffer to encode into. Must stay valid while the request is used.
+ *               256 bytes are enough for an rpId and a credential ID of usual length.
+ * @param buffer_len The length of the buffer.
+ * @return int FIDO_OK, FIDO_ERR_INVALID_ARGUMENT if no rpId is set or FIDO_ERR_BUFFER_TOO_SHORT.
+ */
+int fido_assert_prepare_request(fido_assert_request_t *request, const fido_assert_t *assert, uint8_t *buffer, size_t buffer_len);
+
+/**
+ * @brief Get assertion from device with a prepared request, like fido_dev_get_assert.
+ *
+ * The client data hash of assert is copied into the request, which is sent without encoding it again.
+ *
+ * @param dev The device to read from.
+ * @param assert The assertion request the request was prepared from, with the client data hash of this tap.
+ * @param request The prepared request.
+ * @return success or failure
+ */
+int fido_dev_get_assert_request(fido_dev_t *dev, fido_assert_t *assert, const fido_assert_request_t *request);
+
 /**
  * @brief Set the relying party ID for an assertion.
  *
@@ -121,6 +176,21 @@ int fido_dev_get_assert(fido_dev_t *dev, fido_assert_t *assert);
  */
 void fido_assert_set_rp(fido_assert_t *assert, const char* id);
 
+/**
+ * @brief Set the ID of the credential to use for an assertion (allowList with one entry).
+ *
+ * Without it, the authenticator looks for a discoverable credential of the relying party.
+ * U2F devices need it, as the ID is the key handle of the U2F authenticate command.
+ *
+ * **Warning:** Do not change the data until having called `fido_dev_get_assert`.
+ *
+ * @param assert A pointer to an assertion request to set the credential on.
+ * @param id The credential ID.
+ * @param id_len The length of the credential ID, at most ASSERTION_MAX_KEY_HANDLE_LENGTH.
+ * @return int FIDO_OK, or FIDO_ERR_INVALID_ARGUMENT if the ID is too long.
+ */
+int fido_assert_set_allow_credential(fido_assert_t *assert, const uint8_t *id, const size_t id_len);
+
 /**
  * @brief Set the client data hash for an assertion.
  *
@@ -144,6 +214,23 @@ void fido_assert_set_client_data_hash(fido_assert_t *assert, const uint8_t hash[
  */
 void fido_assert_set_client_data(fido_assert_t *assert, const uint8_t *client_data, const size_t client_data_len);
 
+/**
+ * @brief Set the client data for an assertion from its fields, without building the clientDataJSON.
+ *
+ * Serializes {"type":"webauthn.get","challenge":...,"origin":...,"crossOrigin":...} like a WebAuthn client
+ * straight into a streaming SHA256 hash, base64url encoding the challenge on the fly,
+ * and stores the hash in the assertion request.
+ *
+ * @param assert A pointer to an assertion request to set the client data hash on.
+ * @param challenge A pointer to the challenge, which should be non-predictable.
+ * @param challenge_len The length of the challenge.
+ * @param origin The origin of the relying party, e.g. "https://example.com", as a null terminated UTF-8 string.
+ * @param cross_origin Whether the request is made from a cross origin context.
+ * @return int FIDO_OK, FIDO_ERR_INVALID_ARGUMENT if the challenge or origin is missing,
+ *             or FIDO_ERR_INTERNAL if the streaming SHA256 is not available.
+ */
+int fido_assert_set_client_data_json(fido_assert_t *assert, const uint8_t *challenge, const size_t challenge_len, const char *origin, const bool cross_origin);
+
 /**
  * @brief Set the options field for an assertion.
  *
@@ -160,12 +247,52 @@ void fido_assert_set_options(fido_assert_t *assert, const fido_assert_opt_t opti
  */
 void fido_assert_set_extensions(fido_assert_t *assert, const fido_assert_ext_t extensions);
 
+/**
+ * @brief Get the credBlob returned with an assertion requested with FIDO_ASSERT_EXTENSION_CRED_BLOB.
+ *
+ * The data is not copied, it points into the authenticator data of the reply.
+ *
+ * @param assert A pointer to the assertion.
+ * @return const uint8_t* The credBlob, or NULL if the authenticator did not return one.
+ */
+const uint8_t *fido_assert_cred_blob_ptr(const fido_assert_t *assert);
+
+/**
+ * @brief Get the length of the credBlob returned with an assertion, see fido_assert_cred_blob_ptr.
+ *
+ * @param assert A pointer to the assertion.
+ * @return size_t The length of the credBlob, 0 if there is none. Authenticators return an empty credBlob
+ *                for credentials without one.
+ */
+size_t fido_assert_cred_blob_len(const fido_assert_t *assert);
+
+/**
+ * @brief Get the ID of the credential of an assertion.
+ *
+ * Authenticators may omit the credential in the reply if only one credential was allowed,
+ * the allowed credential is returned then.
+ *
+ * @param assert A pointer to the assertion.
+ * @return const uint8_t* The credential ID, or NULL if it is unknown.
+ */
+const uint8_t *fido_assert_id_ptr(const fido_assert_t *assert);
+
+/**
+ * @brief Get the length of the ID of the credential of an assertion, see fido_assert_id_ptr.
+ *
+ * @param assert A pointer to the assertion.
+ * @return size_t The length of the credential ID, 0 if it is unknown.
+ */
+size_t fido_assert_id_len(const fido_assert_t *assert);
+
+#ifndef FIDO_NO_ASSERT_VERIFY
 /**
  * @brief Verify an assertion.
  *
  * @param assert A pointer to an assertion request/reply struct.
  * @param cose_alg A COSE algorithm identifier.
- * @param pk The public key to verify the signature with.
+ * @param pk The public key to verify the signature with (32 bytes for EdDSA, x and y with 32 bytes each for ES256).
  * @return int
  */
 int fido_assert_verify(const fido_assert_t *assert, const int cose_alg, const uint8_t *pk);
+#endif
@@ -0,0 +1,98 @@
+/*
+ * Copyright (c) 2022 Felix Gohla, Konrad Hanff, Tobias Kantusch,
+ *                    Quentin Kuth, Felix Roth. All rights reserved.
+ *
+ * Use of this source code is governed by a BSD-style
+ * license that can be found in the LICENSE file.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "assertion.h"
+
+/**
+ * A read-only store of the public keys of enrolled credentials, e.g. for a stateful RP
+ * with thousands of users, which is built offline by tools/build_cred_store.py and kept in flash.
+ *
+ * The image consists of a header, an open-addressing hash table and fixed-size records,
+ * all little endian:
+ *
+ *   header (16 bytes):  magic "FCS1" | slot count (uint32, a power of two) | record count (uint32) | metadata size (uint32)
+ *   slots:              slot count times the index + 1 of a record (uint16), 0 if the slot is empty
+ *   records:            truncated SHA256(credential ID) (16 bytes) | COSE algorithm (int16) | reserved (2 bytes) |
+ *                       public key (64 bytes, the first 32 for EdDSA) | metadata (metadata size bytes)
+ *
+ * A credential ID is looked up by its hash, starting at the slot that the first 4 bytes of the hash
+ * (little endian) select, and probing the following slots, so that
+ * only a few slots and records are read. Nothing of the image is copied to RAM except the public key
+ * of the credential that was found. On the AVR, the image is read with the program memory functions,
+ * so it can be declared with PROGMEM_MARKER.
+ *
+ * Removed with FIDO_NO_CRED_STORE (CMake option ENABLE_CRED_STORE).
+ */
+
+#define FIDO_CRED_STORE_HEADER_SIZE     16
+#define FIDO_CRED_STORE_SLOT_SIZE       2
+#define FIDO_CRED_STORE_ID_HASH_SIZE    16
+#define FIDO_CRED_STORE_PUBLIC_KEY_SIZE 64
+#define FIDO_CRED_STORE_RECORD_SIZE(metadata_size) (FIDO_CRED_STORE_ID_HASH_SIZE + 4 + FIDO_CRED_STORE_PUBLIC_KEY_SIZE + (metadata_size))
+
+typedef struct fido_cred_store {
+    const uint8_t *slots;       // the hash table in the image
+    const uint8_t *records;     // the records in the image
+    size_t slot_mask;           // number of slots - 1
+    size_t record_count;
+    size_t metadata_size;
+} fido_cred_store_t;
+
+/**
+ * A credential found in a store.
+ */
+typedef struct fido_cred_store_entry {
+    int cose_alg;                                           // COSE algorithm of the public key
+    uint8_t public_key[FIDO_CRED_STORE_PUBLIC_KEY_SIZE];    // copied from the image
+    const uint8_t *metadata;                                // points into the image (program memory on the AVR)
+    size_t metadata_len;
+} fido_cred_store_entry_t;
+
+#ifndef FIDO_NO_CRED_STORE
+/**
+ * @brief Open a store image.
+ *
+ * @param store The store to initialize.
+ * @param image The image built by tools/build_cred_store.py. Must stay valid while the store is used.
+ * @param image_len The length of the image.
+ * @return int FIDO_OK, or FIDO_ERR_INVALID_ARGUMENT if the image is malformed.
+ */
+int fido_cred_store_init(fido_cred_store_t *store, const uint8_t *image, size_t image_len);
+
+/**
+ * @brief Look up a credential by its ID.
+ *
+ * @param store The store.
+ * @param id The credential ID.
+ * @param id_len The length of the credential ID.
+ * @param entry A pointer to store the credential to.
+ * @return int FIDO_OK, FIDO_ERR_NOTFOUND if the credential is not in the store,
+ *             or FIDO_ERR_INTERNAL if SHA256 is not available.
+ */
+int fido_cred_store_find(const fido_cred_store_t *store, const uint8_t *id, size_t id_len, fido_cred_store_entry_t *entry);
+
+#ifndef FIDO_NO_ASSERT_VERIFY
+/**
+ * @brief Verify an assertion with the public key that a store has for its credential, like fido_assert_verify.
+ *
+ * The credential is the one of the reply, or the allowed credential of the request
+ * if the authenticator omitted it.
+ *
+ * @param assert A pointer to an assertion request/reply struct.
+ * @param store The store.
+ * @param entry A pointer to store the credential to, e.g. for its metadata, may be NULL.
+ * @return int FIDO_OK if the signature is valid, FIDO_ERR_NOTFOUND if the credential is unknown.
+ */
+int fido_assert_verify_cred_store(const fido_assert_t *assert, const fido_cred_store_t *store, fido_cred_store_entry_t *entry);
+#endif
+#endif
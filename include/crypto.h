@@ -10,6 +10,8 @@
 #include <stdint.h>
 #include <stddef.h>
 
+#include "fido_config.h"
+
 #ifndef AES_GCM_TAG_SIZE
 #define AES_GCM_TAG_SIZE  16
 #endif
@@ -18,6 +20,32 @@
 #define SHA256_BLOCK_SIZE 32
 #endif
 
+// The size of the state of a streaming SHA256 hash, large enough for the one of the software SHA256 and of mbedTLS.
+// Hardware implementations with a larger state can raise it (CMake option SHA256_CTX_SIZE).
+#ifndef FIDO_SHA256_CTX_SIZE
+#define FIDO_SHA256_CTX_SIZE 112
+#endif
+
+/**
+ * The state of a streaming SHA256 hash, opaque to the library.
+ */
+typedef struct fido_sha256_ctx {
+    uint64_t state[(FIDO_SHA256_CTX_SIZE + sizeof(uint64_t) - 1) / sizeof(uint64_t)];
+} fido_sha256_ctx_t;
+
+// The size of the state of a streaming SHA512 hash, large enough for the one of Monocypher and of mbedTLS.
+// Hardware implementations with a larger state can raise it (CMake option SHA512_CTX_SIZE).
+#ifndef FIDO_SHA512_CTX_SIZE
+#define FIDO_SHA512_CTX_SIZE 256
+#endif
+
+/**
+ * The state of a streaming SHA512 hash, opaque to the library.
+ */
+typedef struct fido_sha512_ctx {
+    uint64_t state[(FIDO_SHA512_CTX_SIZE + sizeof(uint64_t) - 1) / sizeof(uint64_t)];
+} fido_sha512_ctx_t;
+
 /**
  * @brief AES GCM encrypt
  *
@@ -91,6 +119,20 @@ typedef int (*fido_ed25519_verify_t)(
     const uint8_t *public_key,
     const uint8_t *message, size_t message_len);
 
+/**
+ * @brief Verify ECDSA signature over the NIST P-256 curve (COSE ES256)
+ *
+ * @param signature Pointer to the signature (64 bytes, r and s big endian) to verify.
+ * @param public_key Pointer to the uncompressed public key (64 bytes, x and y big endian) to verify with.
+ * @param hash Pointer to the SHA256 hash (32 bytes) of the message that was signed.
+ *
+ * @return 0 if the signature is valid.
+ */
+typedef int (*fido_es256_verify_t)(
+    const uint8_t *signature,
+    const uint8_t *public_key,
+    const uint8_t *hash);
+
 /**
  * @brief SHA256 hash
  *
@@ -104,6 +146,37 @@ typedef void (*fido_sha256_t)(
     uint8_t *hash
 );
 
+/**
+ * @brief Start a streaming SHA256 hash
+ *
+ * @param ctx Pointer to the state to initialize.
+ */
+typedef void (*fido_sha256_init_t)(fido_sha256_ctx_t *ctx);
+
+/**
+ * @brief Add data to a streaming SHA256 hash
+ *
+ * @param ctx Pointer to the state.
+ * @param data Pointer to the data to hash.
+ * @param data_len Length of the data.
+ */
+typedef void (*fido_sha256_update_t)(
+    fido_sha256_ctx_t *ctx,
+    const uint8_t *data,
+    size_t data_len
+);
+
+/**
+ * @brief Finish a streaming SHA256 hash
+ *
+ * @param ctx Pointer to the state.
+ * @param hash Pointer to where to write the hash (32 bytes) to.
+ */
+typedef void (*fido_sha256_final_t)(
+    fido_sha256_ctx_t *ctx,
+    uint8_t *hash
+);
+
 /**
  * @brief SHA512 hash
  *
@@ -117,6 +190,37 @@ typedef void (*fido_sha512_t)(
     uint8_t *hash
 );
 
+/**
+ * @brief Start a streaming SHA512 hash
+ *
+ * @param ctx Pointer to the state to initialize.
+ */
+typedef void (*fido_sha512_init_t)(fido_sha512_ctx_t *ctx);
+
+/**
+ * @brief Add data to a streaming SHA512 hash
+ *
+ * @param ctx Pointer to the state.
+ * @param data Pointer to the data to hash.
+ * @param data_len Length of the data.
+ */
+typedef void (*fido_sha512_update_t)(
+    fido_sha512_ctx_t *ctx,
+    const uint8_t *data,
+    size_t data_len
+);
+
+/**
+ * @brief Finish a streaming SHA512 hash
+ *
+ * @param ctx Pointer to the state.
+ * @param hash Pointer to where to write the hash (64 bytes) to.
+ */
+typedef void (*fido_sha512_final_t)(
+    fido_sha512_ctx_t *ctx,
+    uint8_t *hash
+);
+
 /**
  * These are pointers to the cryptographic functions used by this library.
  * They can be set to other functions, for example when the platform supports
@@ -125,18 +229,42 @@ typedef void (*fido_sha512_t)(
  * fido_ed25510_sign = &my_hardware_accelerated_ed25519_sign;
  *
  * You can define any of the macros
- * NO_SOFTWARE_{AES_GCM_ENCRYPT|AES_GCM_DECRYPT|ED25519_SIGN|ED25519_VERIFY|SHA256|SHA512}
+ * NO_SOFTWARE_{AES_GCM_ENCRYPT|AES_GCM_DECRYPT|ED25519_SIGN|ED25519_VERIFY|ES256_VERIFY|SHA256|SHA512}
  * to prevent the software implementation of this algorithm to be included in the library.
  * Be aware that AES_GCM_DECRYPT, ED25519_VERIFY and SHA256 are necessary for this library
  * to function correctly. If you don't include the software implementation, replace it with
  * another implementation as described above.
+ * ES256_VERIFY is only needed for ES256 credentials, e.g. those of U2F devices.
+ * SHA256 and SHA512 include the streaming functions fido_sha256_{init|update|final} and
+ * fido_sha512_{init|update|final}, which must be set together.
+ *
+ * The software implementation of ED25519_VERIFY hashes with the streaming SHA512 functions,
+ * so a hardware SHA512 set there speeds up the verification of signatures as well.
+ * If they are not set, Monocypher's own SHA512 is used.
  *
  * Additionally, these functions can be called from other code so they don't
  * have to be reimplemented if needed.
+ *
+ * Alternatively, the library can call the implementations directly, which allows the compiler
+ * to inline them. For that, define FIDO_CRYPTO_BACKEND as the name of a header that defines
+ * FIDO_CRYPTO_{AES_GCM_ENCRYPT|AES_GCM_DECRYPT|ED25519_SIGN|ED25519_VERIFY|ES256_VERIFY|SHA256|SHA256_INIT|SHA256_UPDATE|SHA256_FINAL|SHA512|SHA512_INIT|SHA512_UPDATE|SHA512_FINAL}
+ * as the function implementing the algorithm, e.g.
+ *
+ * #define FIDO_CRYPTO_SHA256 my_hardware_accelerated_sha256
+ *
+ * The library ignores the pointers of these algorithms then, the pointers of the others are used as before.
+ * crypto_software.h binds the software implementations.
  */
 extern fido_aes_gcm_encrypt_t fido_aes_gcm_encrypt;
 extern fido_aes_gcm_decrypt_t fido_aes_gcm_decrypt;
 extern fido_ed25519_sign_t fido_ed25519_sign;
 extern fido_ed25519_verify_t fido_ed25519_verify;
+extern fido_es256_verify_t fido_es256_verify;
 extern fido_sha256_t fido_sha256;
+extern fido_sha256_init_t fido_sha256_init;
+extern fido_sha256_update_t fido_sha256_update;
+extern fido_sha256_final_t fido_sha256_final;
 extern fido_sha512_t fido_sha512;
+extern fido_sha512_init_t fido_sha512_init;
+extern fido_sha512_update_t fido_sha512_update;
+extern fido_sha512_final_t fido_sha512_final;
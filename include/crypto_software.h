@@ -0,0 +1,76 @@
+/*
+ * Copyright (c) 2022 Felix Gohla, Konrad Hanff, Tobias Kantusch,
+ *                    Quentin Kuth, Felix Roth. All rights reserved.
+ *
+ * Use of this source code is governed by a BSD-style
+ * license that can be found in the LICENSE file.
+ */
+#pragma once
+
+/**
+ * The crypto backend that binds the software implementations of crypto.c at compile time,
+ * see FIDO_CRYPTO_BACKEND in crypto.h. Algorithms without a software implementation
+ * (NO_SOFTWARE_CRYPTO_*) are still called through their function pointer.
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+
+#if !defined(NO_SOFTWARE_CRYPTO_AES_GCM_ENCRYPT) || !defined(NO_SOFTWARE_CRYPTO_AES_GCM_DECRYPT)
+#include <aes_gcm.h>
+#endif
+
+#ifndef NO_SOFTWARE_CRYPTO_AES_GCM_ENCRYPT
+#define FIDO_CRYPTO_AES_GCM_ENCRYPT aes_gcm_ae
+#endif
+
+#ifndef NO_SOFTWARE_CRYPTO_AES_GCM_DECRYPT
+#define FIDO_CRYPTO_AES_GCM_DECRYPT aes_gcm_ad
+#endif
+
+#ifndef NO_SOFTWARE_CRYPTO_ED25519_SIGN
+void crypto_ed25519_sign_wrapper(uint8_t *signature,
+                                 const uint8_t *secret_key,
+                                 const uint8_t *message, size_t message_len);
+#define FIDO_CRYPTO_ED25519_SIGN crypto_ed25519_sign_wrapper
+#endif
+
+#ifndef NO_SOFTWARE_CRYPTO_ED25519_VERIFY
+int crypto_ed25519_check_wrapper(const uint8_t *signature,
+                                 const uint8_t *public_key,
+                                 const uint8_t *message, size_t message_len);
+#define FIDO_CRYPTO_ED25519_VERIFY crypto_ed25519_check_wrapper
+#endif
+
+#ifndef NO_SOFTWARE_CRYPTO_ES256_VERIFY
+#include <p256.h>
+#define FIDO_CRYPTO_ES256_VERIFY p256_ecdsa_verify
+#endif
+
+#ifndef NO_SOFTWARE_CRYPTO_SHA256
+// Not <sha256.h>, whose SHA256_DIGEST_SIZE collides with the one of assertion.h.
+void sha256(const uint8_t *data, size_t len, uint8_t *hash);
+#define FIDO_CRYPTO_SHA256 sha256
+
+#include "crypto.h"
+void sha256_init_wrapper(fido_sha256_ctx_t *ctx);
+void sha256_update_wrapper(fido_sha256_ctx_t *ctx, const uint8_t *data, size_t data_len);
+void sha256_final_wrapper(fido_sha256_ctx_t *ctx, uint8_t *hash);
+#define FIDO_CRYPTO_SHA256_INIT sha256_init_wrapper
+#define FIDO_CRYPTO_SHA256_UPDATE sha256_update_wrapper
+#define FIDO_CRYPTO_SHA256_FINAL sha256_final_wrapper
+#endif
+
+#ifndef NO_SOFTWARE_CRYPTO_SHA512
+void crypto_sha512_wrapper(const uint8_t *data, size_t data_len,
+                           uint8_t *hash);
+#define FIDO_CRYPTO_SHA512 crypto_sha512_wrapper
+
+#include "crypto.h"
+void crypto_sha512_init_wrapper(fido_sha512_ctx_t *ctx);
+void crypto_sha512_update_wrapper(fido_sha512_ctx_t *ctx, const uint8_t *data, size_t data_len);
+void crypto_sha512_final_wrapper(fido_sha512_ctx_t *ctx, uint8_t *hash);
+#define FIDO_CRYPTO_SHA512_INIT crypto_sha512_init_wrapper
+#define FIDO_CRYPTO_SHA512_UPDATE crypto_sha512_update_wrapper
+#define FIDO_CRYPTO_SHA512_FINAL crypto_sha512_final_wrapper
+#endif
@@ -12,8 +12,10 @@
 #include <stdint.h>
 #include <stdbool.h>
 
+#include "fido_config.h"
 #include "io.h"
 #include "info.h"
+#include "inflate.h"
 
 /* internal device capability flags */
 #define FIDO_DEV_PIN_SET        BITFIELD(0)
@@ -25,6 +27,8 @@
 #define FIDO_DEV_TOKEN_PERMS    BITFIELD(6)
 #define FIDO_DEV_LARGE_BLOB     BITFIELD(7)
 #define FIDO_DEV_LARGE_BLOB_KEY BITFIELD(8)
+#define FIDO_DEV_FORCE_U2F      BITFIELD(9) /* set by fido_dev_force_u2f */
+#define FIDO_DEV_CRED_BLOB      BITFIELD(10)
 typedef uint16_t fido_dev_flag_t;
 
 typedef struct __attribute__((packed)) fido_ctap_info {
@@ -36,6 +40,45 @@ typedef struct __attribute__((packed)) fido_ctap_info {
     uint8_t  flags;    // capabilities flags; see FIDO_CAP_*
 } fido_ctap_info_t;
 
+/**
+ * Phases of which the time is accumulated in fido_dev_stats_t.time_us.
+ */
+typedef enum fido_dev_stats_phase {
+    FIDO_DEV_STATS_TX = 0,             // fido_tx, including the I/O
+    FIDO_DEV_STATS_RX,                 // fido_rx, including the I/O
+    FIDO_DEV_STATS_LARGEBLOB_DECRYPT,  // trial decryption of large-blob entries
+    FIDO_DEV_STATS_LARGEBLOB_INFLATE,  // decompression of large blobs
+    FIDO_DEV_STATS_PHASE_COUNT,
+} fido_dev_stats_phase_t;
+
+/**
+ * @brief Counters of the traffic and work of a device, e.g. for monitoring.
+ *        Removed with FIDO_NO_DEV_STATS (CMake option ENABLE_DEVICE_STATS).
+ *
+ * There is no retry counter, as the transport never re-sends a command, a chain segment or a GET RESPONSE.
+ * A failed exchange is counted in errors and returned to the caller, who may repeat the command.
+ */
+typedef struct fido_dev_stats {
+    uint32_t commands;           // messages sent with fido_tx
+    uint32_t errors;             // fido_tx and fido_rx calls that failed
+    uint32_t apdus_tx;           // command APDUs written, including chain segments and GET RESPONSE
+    uint32_t apdus_rx;           // response APDUs read, including the status words of chain segments
+    uint32_t chain_segments;     // command APDUs sent with the chaining bit set
+    uint32_t get_responses;      // GET RESPONSE continuations
+    uint32_t bytes_tx;           // bytes written to the I/O
+    uint32_t bytes_rx;           // bytes read from the I/O
+    uint32_t largeblob_chunks;   // fragments of the large-blob array received
+    uint32_t largeblob_decrypts; // large-blob entries trial-decrypted, by all threads
+    uint32_t cache_hits;         // lookups answered from a cache of the device, including the prefetched large-blob array
+    uint32_t cache_misses;       // lookups that missed a cache of the device
+    uint64_t time_us[FIDO_DEV_STATS_PHASE_COUNT]; // accumulated microseconds, if a clock is set
+} fido_dev_stats_t;
+
+/**
+ * @brief Returns the current time in microseconds.
+ */
+typedef uint64_t (*fido_dev_clock_t)(void);
+
 typedef struct fido_dev {
     fido_dev_io_t           io;           // I/O functions (raw)
     void                    *io_handle;   // I/O handle
@@ -47,6 +90,23 @@ typedef struct fido_dev {
     fido_dev_flag_t         flags;        // flags for the device (indicating special capabilities)
     uint64_t                maxmsgsize;   // maximum message size
     uint64_t                maxlargeblob; // maximum size of the serialized large-blob array
+    uint64_t                maxcredbloblen; // maximum length of a credBlob
+    fido_inflate_tables_t   *inflate_tables; // buffers for decompressing large blobs, optional
+#ifndef FIDO_NO_VERIFY_CACHE
+    struct fido_verify_cache *verify_cache; // verified signatures, optional, see verify_cache.h
+#endif
+#ifndef FIDO_NO_REVOCATION
+    const struct fido_revocation *revocation; // revoked credential public keys, optional, see revocation.h
+#endif
+#ifndef FIDO_NO_LARGEBLOB
+    uint8_t                 *largeblob_prefetch;      // buffer for the speculatively read large-blob array, optional
+    size_t                  largeblob_prefetch_size;  // size of the buffer
+    size_t                  largeblob_prefetch_len;   // length of the prefetched array, 0 if none
+#endif
+#ifndef FIDO_NO_DEV_STATS
+    fido_dev_stats_t        stats;        // counters of the traffic and work
+    fido_dev_clock_t        stats_clock;  // clock for the phase times, optional
+#endif
 } fido_dev_t;
 
 /**
@@ -74,6 +134,43 @@ void fido_dev_set_io(fido_dev_t *dev, const fido_dev_io_t *io);
  */
 void fido_dev_set_transport(fido_dev_t *dev, const fido_dev_transport_t *transport);
 
+/**
+ * @brief Set the buffers used for building Huffman codes when decompressing large blobs of the device.
+ *
+ * Without them, the codes are built on the stack for every blob.
+ *
+ * @param dev A pointer to the FIDO device.
+ * @param tables The buffers, or NULL. Must stay valid while the device is used.
+ */
+void fido_dev_set_inflate_tables(fido_dev_t *dev, fido_inflate_tables_t *tables);
+
+#ifndef FIDO_NO_DEV_STATS
+/**
+ * @brief Set the clock used for measuring the time of the phases in the statistics of a device.
+ *
+ * Without a clock, fido_dev_stats_t.time_us stays 0.
+ *
+ * @param dev A pointer to the FIDO device.
+ * @param clock The clock returning microseconds, or NULL.
+ */
+void fido_dev_set_stats_clock(fido_dev_t *dev, fido_dev_clock_t clock);
+
+/**
+ * @brief Get the statistics of a device, accumulated since fido_dev_init or fido_dev_reset_stats.
+ *
+ * @param dev A pointer to the FIDO device.
+ * @param stats A pointer to store the statistics to.
+ */
+void fido_dev_get_stats(const fido_dev_t *dev, fido_dev_stats_t *stats);
+
+/**
+ * @brief Reset the statistics of a device to 0.
+ *
+ * @param dev A pointer to the FIDO device.
+ */
+void fido_dev_reset_stats(fido_dev_t *dev);
+#endif
+
 /**
  * @brief Open a FIDO device.
  *
@@ -94,6 +191,20 @@ int fido_dev_open(fido_dev_t *dev);
  */
 int fido_dev_close(fido_dev_t *dev);
 
+#ifndef FIDO_NO_U2F
+/**
+ * @brief Use a device with U2F (CTAP1) only.
+ *
+ * fido_dev_open does not send authenticatorGetInfo then, which saves its round trip for keys known
+ * to only support U2F. NFC devices that answer the applet selection with U2F_V2 instead of FIDO_2_0
+ * are used with U2F without it as well, and devices whose authenticatorGetInfo fails are used with U2F anyway.
+ * Must be called after fido_dev_init and before fido_dev_open.
+ *
+ * @param dev A pointer to the FIDO device.
+ */
+void fido_dev_force_u2f(fido_dev_t *dev);
+#endif
+
 /**
  * @brief Test whether a device is FIDO-capable.
  *
@@ -101,6 +212,15 @@ int fido_dev_close(fido_dev_t *dev);
  */
 bool fido_dev_is_fido(fido_dev_t *dev);
 
+/**
+ * @brief Test whether a device supports the credBlob extension, see FIDO_ASSERT_EXTENSION_CRED_BLOB.
+ *
+ * @param dev A pointer to the opened device to check.
+ * @param len The length of the credBlob that is needed.
+ * @return true if the device supports credBlobs of at least len bytes.
+ */
+bool fido_dev_supports_cred_blob(const fido_dev_t *dev, size_t len);
+
 /**
  * @brief Retrieve information about a device.
  * 
@@ -73,3 +73,5 @@
 #define FIDO_ERR_COMPRESS               -11
 #define FIDO_ERR_DECOMPRESS             -12
 #define FIDO_ERR_BUFFER_TOO_SHORT       -13
+#define FIDO_ERR_REVOKED                -14
+#define FIDO_ERR_SIGN_COUNT             -15
@@ -18,6 +18,7 @@
 #endif
 
 #include "assertion.h"
+#include "cred_store.h"
 #include "crypto.h"
 #include "info.h"
 #include "io.h"
@@ -25,3 +26,9 @@
 #include "nfc.h"
 #include "param.h"
 #include "random.h"
+#include "revocation.h"
+#include "rp_registry.h"
+#include "sign_count.h"
+#include "trace.h"
+#include "u2f.h"
+#include "verify_cache.h"
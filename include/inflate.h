@@ -0,0 +1,122 @@
+/*
+ * Copyright (c) 2022 Felix Gohla, Konrad Hanff, Tobias Kantusch,
+ *                    Quentin Kuth, Felix Roth. All rights reserved.
+ *
+ * Use of this source code is governed by a BSD-style
+ * license that can be found in the LICENSE file.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "fido_config.h"
+
+/**
+ * The largest distance a DEFLATE stream may refer back to.
+ * A window needs to be at most this large, or as large as the uncompressed data, whichever is smaller.
+ */
+#define FIDO_INFLATE_MAX_WINDOW_SIZE 32768
+
+#define FIDO_INFLATE_MAX_BITS         15
+#define FIDO_INFLATE_NUM_LITLEN_CODES 288
+#define FIDO_INFLATE_NUM_DIST_CODES   30
+
+// Upper bounds for the table sizes of the table-driven decoder with 9 and 6 root bits,
+// including all second level tables, as computed by zlib's enough.c.
+#define FIDO_INFLATE_LITLEN_TABLE_SIZE 852
+#define FIDO_INFLATE_DIST_TABLE_SIZE   592
+
+/**
+ * @brief Buffers for the decoding structures of dynamic Huffman codes.
+ *
+ * Without these, every dynamic block builds its codes on the stack. A caller that inflates
+ * repeatedly can keep one instance around (e.g. per device) and attach it with fido_inflate_set_tables.
+ * It must not be used by two inflate states at the same time.
+ */
+typedef struct fido_inflate_tables {
+    uint8_t lengths[FIDO_INFLATE_NUM_LITLEN_CODES + FIDO_INFLATE_NUM_DIST_CODES];
+    uint16_t litlen_counts[FIDO_INFLATE_MAX_BITS + 1];
+    uint16_t litlen_symbols[FIDO_INFLATE_NUM_LITLEN_CODES];
+    uint16_t dist_counts[FIDO_INFLATE_MAX_BITS + 1];
+    uint16_t dist_symbols[FIDO_INFLATE_NUM_DIST_CODES];
+#ifdef FIDO_FAST_INFLATE
+    uint16_t litlen_entries[FIDO_INFLATE_LITLEN_TABLE_SIZE];
+    uint16_t dist_entries[FIDO_INFLATE_DIST_TABLE_SIZE];
+#endif
+} fido_inflate_tables_t;
+
+/**
+ * The bit buffer is as wide as possible with the table-driven decoder, so that it needs to be refilled less often.
+ */
+#if defined(FIDO_FAST_INFLATE) && UINTPTR_MAX > UINT32_MAX
+typedef uint64_t fido_inflate_bit_buffer_t;
+#else
+typedef uint32_t fido_inflate_bit_buffer_t;
+#endif
+
+/**
+ * @brief Receives inflated data.
+ *
+ * @param data Pointer to the inflated data. Only valid during the call.
+ * @param data_len The length of the inflated data.
+ * @param ctx The context that was passed to fido_inflate_init.
+ * @return int FIDO_OK to continue, any other value aborts inflating with that error.
+ */
+typedef int (*fido_inflate_output_t)(const uint8_t *data, size_t data_len, void *ctx);
+
+/**
+ * @brief State of a raw DEFLATE (RFC 1951) decompression.
+ *
+ * The window keeps the most recently inflated data for resolving back references.
+ * With an output callback, the window is used as a ring buffer and handed to the callback
+ * whenever it is full. Without a callback, the window is the output buffer itself and
+ * has to be large enough for the whole uncompressed data.
+ */
+typedef struct fido_inflate {
+    const uint8_t *in;
+    size_t in_len;
+    size_t in_pos;
+    fido_inflate_bit_buffer_t bit_buffer;
+    uint8_t bit_count;
+    uint8_t *window;
+    size_t window_len;
+    size_t window_pos;
+    size_t flushed;   // Start of the data in the window that was not yet passed to the output.
+    size_t total_out; // Number of bytes inflated so far.
+    fido_inflate_output_t output;
+    void *output_ctx;
+    fido_inflate_tables_t *tables; // Optional, see fido_inflate_set_tables.
+} fido_inflate_t;
+
+/**
+ * @brief Initialize the inflate state.
+ *
+ * @param inflate The state to initialize.
+ * @param window The window buffer, or the output buffer if output is NULL.
+ * @param window_len The length of the window buffer.
+ * @param output The callback receiving the inflated data, or NULL to inflate into the window.
+ * @param output_ctx The context passed to the callback.
+ */
+void fido_inflate_init(fido_inflate_t *inflate, uint8_t *window, size_t window_len, fido_inflate_output_t output, void *output_ctx);
+
+/**
+ * @brief Use the given buffers for dynamic Huffman codes instead of the stack.
+ *
+ * @param inflate The initialized inflate state.
+ * @param tables The buffers, or NULL to use the stack.
+ */
+void fido_inflate_set_tables(fido_inflate_t *inflate, fido_inflate_tables_t *tables);
+
+/**
+ * @brief Inflate a complete raw DEFLATE stream.
+ *
+ * @param inflate The initialized inflate state. inflate->total_out holds the uncompressed length afterwards.
+ * @param in The compressed data.
+ * @param in_len The length of the compressed data.
+ * @return int FIDO_OK on success, FIDO_ERR_DECOMPRESS on malformed input or references beyond the window,
+ *         FIDO_ERR_BUFFER_TOO_SHORT if the output does not fit into the window without a callback,
+ *         or the error returned by the output callback.
+ */
+int fido_inflate(fido_inflate_t *inflate, const uint8_t *in, size_t in_len);
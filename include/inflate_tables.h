@@ -0,0 +1,93 @@
+/*
+ * Copyright (c) 2022 Felix Gohla, Konrad Hanff, Tobias Kantusch,
+ *                    Quentin Kuth, Felix Roth. All rights reserved.
+ *
+ * Use of this source code is governed by a BSD-style
+ * license that can be found in the LICENSE file.
+ */
+
+// Generated by tools/gen_inflate_tables.py, do not edit.
+// Decoding tables of the fixed Huffman codes, only to be included by src/inflate.c.
+
+#pragma once
+
+#include "utils.h"
+#include <stdint.h>
+
+static const uint16_t inflate_fixed_litlen_counts[16] PROGMEM_MARKER = {
+    0, 0, 0, 0, 0, 0, 0, 24, 152, 112, 0, 0, 0, 0, 0, 0,
+};
+
+static const uint16_t inflate_fixed_litlen_symbols[288] PROGMEM_MARKER = {
+    256, 257, 258, 259, 260, 261, 262, 263, 264, 265, 266, 267, 268, 269, 270, 271,
+    272, 273, 274, 275, 276, 277, 278, 279, 0, 1, 2, 3, 4, 5, 6, 7,
+    8, 9, 10, 11, 12, 13, 14, 15, 16, 17, 18, 19, 20, 21, 22, 23,
+    24, 25, 26, 27, 28, 29, 30, 31, 32, 33, 34, 35, 36, 37, 38, 39,
+    40, 41, 42, 43, 44, 45, 46, 47, 48, 49, 50, 51, 52, 53, 54, 55,
+    56, 57, 58, 59, 60, 61, 62, 63, 64, 65, 66, 67, 68, 69, 70, 71,
+    72, 73, 74, 75, 76, 77, 78, 79, 80, 81, 82, 83, 84, 85, 86, 87,
+    88, 89, 90, 91, 92, 93, 94, 95, 96, 97, 98, 99, 100, 101, 102, 103,
+    104, 105, 106, 107, 108, 109, 110, 111, 112, 113, 114, 115, 116, 117, 118, 119,
+    120, 121, 122, 123, 124, 125, 126, 127, 128, 129, 130, 131, 132, 133, 134, 135,
+    136, 137, 138, 139, 140, 141, 142, 143, 280, 281, 282, 283, 284, 285, 286, 287,
+    144, 145, 146, 147, 148, 149, 150, 151, 152, 153, 154, 155, 156, 157, 158, 159,
+    160, 161, 162, 163, 164, 165, 166, 167, 168, 169, 170, 171, 172, 173, 174, 175,
+    176, 177, 178, 179, 180, 181, 182, 183, 184, 185, 186, 187, 188, 189, 190, 191,
+    192, 193, 194, 195, 196, 197, 198, 199, 200, 201, 202, 203, 204, 205, 206, 207,
+    208, 209, 210, 211, 212, 213, 214, 215, 216, 217, 218, 219, 220, 221, 222, 223,
+    224, 225, 226, 227, 228, 229, 230, 231, 232, 233, 234, 235, 236, 237, 238, 239,
+    240, 241, 242, 243, 244, 245, 246, 247, 248, 249, 250, 251, 252, 253, 254, 255,
+};
+
+static const uint16_t inflate_fixed_dist_counts[16] PROGMEM_MARKER = {
+    0, 0, 0, 0, 0, 30, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+};
+
+static const uint16_t inflate_fixed_dist_symbols[30] PROGMEM_MARKER = {
+    0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15,
+    16, 17, 18, 19, 20, 21, 22, 23, 24, 25, 26, 27, 28, 29,
+};
+
+#ifdef FIDO_FAST_INFLATE
+static const uint16_t inflate_fixed_litlen_table[512] PROGMEM_MARKER = {
+    16391, 5128, 1032, 17928, 17415, 7176, 3080, 12297, 16903, 6152, 2056, 10249, 8, 8200, 4104, 14345,
+    16647, 5640, 1544, 9225, 17671, 7688, 3592, 13321, 17159, 6664, 2568, 11273, 520, 8712, 4616, 15369,
+    16519, 5384, 1288, 18184, 17543, 7432, 3336, 12809, 17031, 6408, 2312, 10761, 264, 8456, 4360, 14857,
+    16775, 5896, 1800, 9737, 17799, 7944, 3848, 13833, 17287, 6920, 2824, 11785, 776, 8968, 4872, 15881,
+    16455, 5256, 1160, 18056, 17479, 7304, 3208, 12553, 16967, 6280, 2184, 10505, 136, 8328, 4232, 14601,
+    16711, 5768, 1672, 9481, 17735, 7816, 3720, 13577, 17223, 6792, 2696, 11529, 648, 8840, 4744, 15625,
+    16583, 5512, 1416, 18312, 17607, 7560, 3464, 13065, 17095, 6536, 2440, 11017, 392, 8584, 4488, 15113,
+    16839, 6024, 1928, 9993, 17863, 8072, 3976, 14089, 17351, 7048, 2952, 12041, 904, 9096, 5000, 16137,
+    16391, 5192, 1096, 17992, 17415, 7240, 3144, 12425, 16903, 6216, 2120, 10377, 72, 8264, 4168, 14473,
+    16647, 5704, 1608, 9353, 17671, 7752, 3656, 13449, 17159, 6728, 2632, 11401, 584, 8776, 4680, 15497,
+    16519, 5448, 1352, 18248, 17543, 7496, 3400, 12937, 17031, 6472, 2376, 10889, 328, 8520, 4424, 14985,
+    16775, 5960, 1864, 9865, 17799, 8008, 3912, 13961, 17287, 6984, 2888, 11913, 840, 9032, 4936, 16009,
+    16455, 5320, 1224, 18120, 17479, 7368, 3272, 12681, 16967, 6344, 2248, 10633, 200, 8392, 4296, 14729,
+    16711, 5832, 1736, 9609, 17735, 7880, 3784, 13705, 17223, 6856, 2760, 11657, 712, 8904, 4808, 15753,
+    16583, 5576, 1480, 18376, 17607, 7624, 3528, 13193, 17095, 6600, 2504, 11145, 456, 8648, 4552, 15241,
+    16839, 6088, 1992, 10121, 17863, 8136, 4040, 14217, 17351, 7112, 3016, 12169, 968, 9160, 5064, 16265,
+    16391, 5128, 1032, 17928, 17415, 7176, 3080, 12361, 16903, 6152, 2056, 10313, 8, 8200, 4104, 14409,
+    16647, 5640, 1544, 9289, 17671, 7688, 3592, 13385, 17159, 6664, 2568, 11337, 520, 8712, 4616, 15433,
+    16519, 5384, 1288, 18184, 17543, 7432, 3336, 12873, 17031, 6408, 2312, 10825, 264, 8456, 4360, 14921,
+    16775, 5896, 1800, 9801, 17799, 7944, 3848, 13897, 17287, 6920, 2824, 11849, 776, 8968, 4872, 15945,
+    16455, 5256, 1160, 18056, 17479, 7304, 3208, 12617, 16967, 6280, 2184, 10569, 136, 8328, 4232, 14665,
+    16711, 5768, 1672, 9545, 17735, 7816, 3720, 13641, 17223, 6792, 2696, 11593, 648, 8840, 4744, 15689,
+    16583, 5512, 1416, 18312, 17607, 7560, 3464, 13129, 17095, 6536, 2440, 11081, 392, 8584, 4488, 15177,
+    16839, 6024, 1928, 10057, 17863, 8072, 3976, 14153, 17351, 7048, 2952, 12105, 904, 9096, 5000, 16201,
+    16391, 5192, 1096, 17992, 17415, 7240, 3144, 12489, 16903, 6216, 2120, 10441, 72, 8264, 4168, 14537,
+    16647, 5704, 1608, 9417, 17671, 7752, 3656, 13513, 17159, 6728, 2632, 11465, 584, 8776, 4680, 15561,
+    16519, 5448, 1352, 18248, 17543, 7496, 3400, 13001, 17031, 6472, 2376, 10953, 328, 8520, 4424, 15049,
+    16775, 5960, 1864, 9929, 17799, 8008, 3912, 14025, 17287, 6984, 2888, 11977, 840, 9032, 4936, 16073,
+    16455, 5320, 1224, 18120, 17479, 7368, 3272, 12745, 16967, 6344, 2248, 10697, 200, 8392, 4296, 14793,
+    16711, 5832, 1736, 9673, 17735, 7880, 3784, 13769, 17223, 6856, 2760, 11721, 712, 8904, 4808, 15817,
+    16583, 5576, 1480, 18376, 17607, 7624, 3528, 13257, 17095, 6600, 2504, 11209, 456, 8648, 4552, 15305,
+    16839, 6088, 1992, 10185, 17863, 8136, 4040, 14281, 17351, 7112, 3016, 12233, 968, 9160, 5064, 16329,
+};
+
+static const uint16_t inflate_fixed_dist_table[64] PROGMEM_MARKER = {
+    5, 1029, 517, 1541, 261, 1285, 773, 1797, 133, 1157, 645, 1669, 389, 1413, 901, 32,
+    69, 1093, 581, 1605, 325, 1349, 837, 1861, 197, 1221, 709, 1733, 453, 1477, 965, 32,
+    5, 1029, 517, 1541, 261, 1285, 773, 1797, 133, 1157, 645, 1669, 389, 1413, 901, 32,
+    69, 1093, 581, 1605, 325, 1349, 837, 1861, 197, 1221, 709, 1733, 453, 1477, 965, 32,
+};
+#endif
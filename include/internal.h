@@ -60,3 +60,185 @@ int fido_buf_read(const unsigned char **buf, size_t *len, void *dst, size_t coun
  * @return int FIDO_OK if the operation was successful.
  */
 int fido_buf_write(unsigned char **buf, size_t *len, const void *src, size_t count);
+
+#if !defined(FIDO_NO_CRED_STORE) || !defined(FIDO_NO_REVOCATION)
+/**
+ * @brief Read a little endian integer from an image, which may be in program memory.
+ *
+ * @param ptr Pointer to the integer in the image.
+ * @param len The size of the integer in bytes, at most 4.
+ * @return uint32_t The integer.
+ */
+uint32_t fido_buf_read_le_progmem(const uint8_t *ptr, size_t len);
+
+/**
+ * @brief Check the magic at the start of an image, where both may be in program memory.
+ *
+ * @param image The image.
+ * @param magic The expected magic.
+ * @param len The length of the magic.
+ * @return bool true if the image starts with the magic.
+ */
+bool fido_buf_has_magic_progmem(const uint8_t *image, const uint8_t *magic, size_t len);
+#endif
+
+#ifndef FIDO_NO_DEV_STATS
+/**
+ * @brief Get the current time of the statistics clock of a device.
+ *
+ * @param d A pointer to the FIDO device, may be NULL.
+ * @return uint64_t The time in microseconds, or 0 without a device or clock.
+ */
+uint64_t fido_dev_stats_now(const fido_dev_t *d);
+
+/**
+ * @brief Add the time since start to a phase in the statistics of a device.
+ *
+ * @param d A pointer to the FIDO device. Nothing is added if NULL.
+ * @param phase The phase, see fido_dev_stats_phase_t.
+ * @param start The time returned by fido_dev_stats_now when the phase started.
+ */
+void fido_dev_stats_add_time(fido_dev_t *d, fido_dev_stats_phase_t phase, uint64_t start);
+
+#define FIDO_STATS_ADD(d, counter, n)       ((d)->stats.counter += (uint32_t)(n))
+#define FIDO_STATS_INC(d, counter)          FIDO_STATS_ADD(d, counter, 1)
+#define FIDO_STATS_START(d, start)          uint64_t start = fido_dev_stats_now(d)
+#define FIDO_STATS_STOP(d, phase, start)    fido_dev_stats_add_time(d, phase, start)
+#else
+#define FIDO_STATS_ADD(d, counter, n)       do {} while(0)
+#define FIDO_STATS_INC(d, counter)          do {} while(0)
+#define FIDO_STATS_START(d, start)          do {} while(0)
+#define FIDO_STATS_STOP(d, phase, start)    do {} while(0)
+#endif
+
+#ifdef FIDO_STATIC_IO
+// The I/O functions <FIDO_STATIC_IO>_open, _close, _read and _write are bound at link time instead of through fido_dev_io_t.
+#define FIDO_STATIC_IO_PASTE(prefix, function)  prefix ## _ ## function
+#define FIDO_STATIC_IO_SYMBOL(prefix, function) FIDO_STATIC_IO_PASTE(prefix, function)
+
+fido_dev_io_open_t  FIDO_STATIC_IO_SYMBOL(FIDO_STATIC_IO, open);
+fido_dev_io_close_t FIDO_STATIC_IO_SYMBOL(FIDO_STATIC_IO, close);
+fido_dev_io_read_t  FIDO_STATIC_IO_SYMBOL(FIDO_STATIC_IO, read);
+fido_dev_io_write_t FIDO_STATIC_IO_SYMBOL(FIDO_STATIC_IO, write);
+
+#define FIDO_IO_IS_SET(d, function)     (true)
+#define FIDO_IO_OPEN(d)                 FIDO_STATIC_IO_SYMBOL(FIDO_STATIC_IO, open)()
+#define FIDO_IO_CLOSE(d)                FIDO_STATIC_IO_SYMBOL(FIDO_STATIC_IO, close)((d)->io_handle)
+#define FIDO_IO_READ(d, buf, len)       FIDO_STATIC_IO_SYMBOL(FIDO_STATIC_IO, read)((d)->io_handle, buf, len)
+#define FIDO_IO_WRITE(d, buf, len)      FIDO_STATIC_IO_SYMBOL(FIDO_STATIC_IO, write)((d)->io_handle, buf, len)
+#else
+#define FIDO_IO_IS_SET(d, function)     ((d)->io.function != NULL)
+#define FIDO_IO_OPEN(d)                 (d)->io.open()
+#define FIDO_IO_CLOSE(d)                (d)->io.close((d)->io_handle)
+#define FIDO_IO_READ(d, buf, len)       (d)->io.read((d)->io_handle, buf, len)
+#define FIDO_IO_WRITE(d, buf, len)      (d)->io.write((d)->io_handle, buf, len)
+#endif
+
+/**
+ * @brief Receive a CTAP response over NFC, see fido_init_nfc_device.
+ *
+ * @param d A pointer to the FIDO device.
+ * @param cmd The CTAP command to receive data from.
+ * @param buf A pointer to the destination buffer.
+ * @param len The size of the destination buffer.
+ * @return int The number of bytes received or an error below 0.
+ */
+int fido_nfc_rx(fido_dev_t *d, const uint8_t cmd, unsigned char *buf, const size_t len);
+
+/**
+ * @brief Transmit a CTAP command over NFC, see fido_init_nfc_device.
+ *
+ * @param d A pointer to the FIDO device.
+ * @param cmd The CTAP command to transmit.
+ * @param buf A pointer to the source buffer.
+ * @param len The size of the source buffer.
+ * @return int FIDO_OK if the write operation was successful.
+ */
+int fido_nfc_tx(fido_dev_t *d, const uint8_t cmd, const unsigned char *buf, const size_t len);
+
+#ifdef FIDO_STATIC_TRANSPORT_NFC
+// fido_tx and fido_rx call the NFC transport directly instead of through fido_dev_transport_t.
+#define FIDO_TRANSPORT_IS_SET(d, function)  (true)
+#define FIDO_TRANSPORT_RX(d, cmd, buf, len) fido_nfc_rx(d, cmd, buf, len)
+#define FIDO_TRANSPORT_TX(d, cmd, buf, len) fido_nfc_tx(d, cmd, buf, len)
+#else
+#define FIDO_TRANSPORT_IS_SET(d, function)  ((d)->transport.function != NULL)
+#define FIDO_TRANSPORT_RX(d, cmd, buf, len) (d)->transport.rx(d, cmd, buf, len)
+#define FIDO_TRANSPORT_TX(d, cmd, buf, len) (d)->transport.tx(d, cmd, buf, len)
+#endif
+
+#ifdef FIDO_CRYPTO_BACKEND
+#include FIDO_CRYPTO_BACKEND
+#endif
+
+// The crypto primitives the backend binds are called directly, the others through their function pointer, see crypto.h.
+#define FIDO_CRYPTO_IS_SET(primitive)   FIDO_CRYPTO_IS_SET_ ## primitive
+#define FIDO_CRYPTO_CALL(primitive)     FIDO_CRYPTO_CALL_ ## primitive
+
+#ifdef FIDO_CRYPTO_AES_GCM_ENCRYPT
+#define FIDO_CRYPTO_IS_SET_aes_gcm_encrypt  (true)
+#define FIDO_CRYPTO_CALL_aes_gcm_encrypt    FIDO_CRYPTO_AES_GCM_ENCRYPT
+#else
+#define FIDO_CRYPTO_IS_SET_aes_gcm_encrypt  (fido_aes_gcm_encrypt != NULL)
+#define FIDO_CRYPTO_CALL_aes_gcm_encrypt    fido_aes_gcm_encrypt
+#endif
+
+#ifdef FIDO_CRYPTO_AES_GCM_DECRYPT
+#define FIDO_CRYPTO_IS_SET_aes_gcm_decrypt  (true)
+#define FIDO_CRYPTO_CALL_aes_gcm_decrypt    FIDO_CRYPTO_AES_GCM_DECRYPT
+#else
+#define FIDO_CRYPTO_IS_SET_aes_gcm_decrypt  (fido_aes_gcm_decrypt != NULL)
+#define FIDO_CRYPTO_CALL_aes_gcm_decrypt    fido_aes_gcm_decrypt
+#endif
+
+#ifdef FIDO_CRYPTO_ED25519_SIGN
+#define FIDO_CRYPTO_IS_SET_ed25519_sign     (true)
+#define FIDO_CRYPTO_CALL_ed25519_sign       FIDO_CRYPTO_ED25519_SIGN
+#else
+#define FIDO_CRYPTO_IS_SET_ed25519_sign     (fido_ed25519_sign != NULL)
+#define FIDO_CRYPTO_CALL_ed25519_sign       fido_ed25519_sign
+#endif
+
+#ifdef FIDO_CRYPTO_ED25519_VERIFY
+#define FIDO_CRYPTO_IS_SET_ed25519_verify   (true)
+#define FIDO_CRYPTO_CALL_ed25519_verify     FIDO_CRYPTO_ED25519_VERIFY
+#else
+#define FIDO_CRYPTO_IS_SET_ed25519_verify   (fido_ed25519_verify != NULL)
+#define FIDO_CRYPTO_CALL_ed25519_verify     fido_ed25519_verify
+#endif
+
+#ifdef FIDO_CRYPTO_ES256_VERIFY
+#define FIDO_CRYPTO_IS_SET_es256_verify     (true)
+#define FIDO_CRYPTO_CALL_es256_verify       FIDO_CRYPTO_ES256_VERIFY
+#else
+#define FIDO_CRYPTO_IS_SET_es256_verify     (fido_es256_verify != NULL)
+#define FIDO_CRYPTO_CALL_es256_verify       fido_es256_verify
+#endif
+
+#ifdef FIDO_CRYPTO_SHA256
+#define FIDO_CRYPTO_IS_SET_sha256           (true)
+#define FIDO_CRYPTO_CALL_sha256             FIDO_CRYPTO_SHA256
+#else
+#define FIDO_CRYPTO_IS_SET_sha256           (fido_sha256 != NULL)
+#define FIDO_CRYPTO_CALL_sha256             fido_sha256
+#endif
+
+#if defined(FIDO_CRYPTO_SHA256_INIT) && defined(FIDO_CRYPTO_SHA256_UPDATE) && defined(FIDO_CRYPTO_SHA256_FINAL)
+#define FIDO_CRYPTO_IS_SET_sha256_stream    (true)
+#define FIDO_CRYPTO_CALL_sha256_init        FIDO_CRYPTO_SHA256_INIT
+#define FIDO_CRYPTO_CALL_sha256_update      FIDO_CRYPTO_SHA256_UPDATE
+#define FIDO_CRYPTO_CALL_sha256_final       FIDO_CRYPTO_SHA256_FINAL
+#else
+#define FIDO_CRYPTO_IS_SET_sha256_stream    (fido_sha256_init != NULL && fido_sha256_update != NULL && fido_sha256_final != NULL)
+#define FIDO_CRYPTO_CALL_sha256_init        fido_sha256_init
+#define FIDO_CRYPTO_CALL_sha256_update      fido_sha256_update
+#define FIDO_CRYPTO_CALL_sha256_final       fido_sha256_final
+#endif
+
+#ifdef FIDO_CRYPTO_SHA512
+#define FIDO_CRYPTO_IS_SET_sha512           (true)
+#define FIDO_CRYPTO_CALL_sha512             FIDO_CRYPTO_SHA512
+#else
+#define FIDO_CRYPTO_IS_SET_sha512           (fido_sha512 != NULL)
+#define FIDO_CRYPTO_CALL_sha512             fido_sha512
+#endif
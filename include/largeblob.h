@@ -10,6 +10,7 @@
 #pragma once
 
 #include "dev.h"
+#include "inflate.h"
 #include <stdint.h>
 #include <stddef.h>
 
@@ -23,6 +24,32 @@ typedef struct fido_blob {
     size_t length;
 } fido_blob_t;
 
+/**
+ * @brief Descriptor of a single entry of a serialized large-blob array.
+ *        Offsets are relative to the start of the array.
+ */
+typedef struct fido_largeblob_entry {
+    uint32_t ciphertext_offset; // followed by the 16 byte tag
+    uint32_t ciphertext_len;    // without the tag
+    uint32_t nonce_offset;
+    uint64_t orig_size;
+} fido_largeblob_entry_t;
+
+/**
+ * @brief Index over the entries of a fetched large-blob array.
+ *        The array must be kept alive and unmodified as long as the index is used.
+ */
+typedef struct fido_largeblob_index {
+    uint8_t *array;
+    fido_largeblob_entry_t *entries;
+    size_t max_count;
+    size_t count;
+    size_t max_ciphertext_len;
+    uint8_t *scratch;       // for the plaintext of the entries, so that the array is not modified
+    size_t scratch_len;
+    fido_inflate_tables_t *inflate_tables; // buffers for decompressing the found blob, optional
+} fido_largeblob_index_t;
+
 /**
  * @brief Reset a blob.
  *
@@ -32,6 +59,8 @@ typedef struct fido_blob {
  */
 void fido_blob_reset(fido_blob_t *blob, uint8_t *buffer, size_t buffer_len);
 
+#ifndef FIDO_NO_LARGEBLOB
+
 /**
  * @brief Read the serialized large-blob array.
  *
@@ -42,7 +71,36 @@ void fido_blob_reset(fido_blob_t *blob, uint8_t *buffer, size_t buffer_len);
 int fido_dev_largeblob_get_array(fido_dev_t *dev, fido_blob_t *largeblob_array);
 
 /**
- * @brief Get the blob that was encrypted with key.
+ * @brief Set the buffer for prefetching the serialized large-blob array of a device,
+ *        which enables the speculative prefetch.
+ *
+ * fido_dev_get_assert then reads the array into the buffer before sending authenticatorGetAssertion
+ * if the largeBlobKey extension is requested, and fido_dev_largeblob_get and fido_dev_largeblob_get_stream
+ * decrypt the prefetched array instead of reading it again. As the entries are decrypted in place, the array is
+ * used by one lookup only; it is also dropped by fido_dev_open and fido_dev_close.
+ * As the array is read before the assertion is sent, this also applies to assertions without user presence.
+ * Only use it with authenticators that answer authenticatorLargeBlobs while user presence is pending or,
+ * like NFC authenticators, do not wait for it, and where the large blob is needed after most assertions.
+ *
+ * @param dev The device.
+ * @param buffer The buffer, should be at least as large as maxSerializedLargeBlobArray. NULL disables the prefetch.
+ *               Must stay valid while the device is used.
+ * @param buffer_len The length of the buffer.
+ */
+void fido_dev_set_largeblob_prefetch(fido_dev_t *dev, uint8_t *buffer, size_t buffer_len);
+
+/**
+ * @brief Read the serialized large-blob array into the prefetch buffer of the device,
+ *        see fido_dev_set_largeblob_prefetch. Can also be called by the application at any time
+ *        between fido_dev_open and fido_dev_largeblob_get.
+ *
+ * @param dev The device to read from.
+ * @return success or failure, FIDO_ERR_INVALID_ARGUMENT if no prefetch buffer is set.
+ */
+int fido_dev_largeblob_prefetch(fido_dev_t *dev);
+
+/**
+ * @brief Get the blob that was encrypted with key. Uses up the prefetched large-blob array, if there is one.
  *
  * @param dev The device to read from.
  * @param key The AES key to use for decryption.
@@ -51,3 +109,70 @@ int fido_dev_largeblob_get_array(fido_dev_t *dev, fido_blob_t *largeblob_array);
  * @return success or failure
  */
 int fido_dev_largeblob_get(fido_dev_t *dev, uint8_t *key, size_t key_len, fido_blob_t *blob);
+
+/**
+ * @brief Get the blob that was encrypted with key and pass it to a callback while it is uncompressed.
+ *        Instead of a buffer for the whole blob, only a window for the decompression is needed,
+ *        which has to be at least as large as the blob or FIDO_INFLATE_MAX_WINDOW_SIZE, whichever is smaller.
+ *        The callback may already have received data when an error is returned.
+ *
+ * @param dev The device to read from.
+ * @param key The AES key to use for decryption.
+ * @param key_len The length of the AES key. Must be 32 byte.
+ * @param window The decompression window.
+ * @param window_len The length of the decompression window.
+ * @param output The callback receiving the uncompressed data.
+ * @param output_ctx The context passed to the callback.
+ * @return success or failure
+ */
+int fido_dev_largeblob_get_stream(fido_dev_t *dev, uint8_t *key, size_t key_len, uint8_t *window, size_t window_len, fido_inflate_output_t output, void *output_ctx);
+
+/**
+ * @brief Reset a large-blob index.
+ *
+ * The scratch buffer receives the plaintext of the entries that are tried, so it must hold the largest
+ * ciphertext of the array; the size of the array (maxSerializedLargeBlobArray) always suffices.
+ * With ENABLE_PARALLEL_LARGEBLOB, every thread needs its own part of that size, so the number of
+ * threads is also limited by the scratch buffer.
+ *
+ * @param index The index to reset.
+ * @param entries Storage for the entry descriptors.
+ * @param max_entries The number of descriptors that fit into entries.
+ * @param scratch The scratch buffer for decrypting the entries. Must stay valid while the index is used.
+ * @param scratch_len The length of the scratch buffer.
+ */
+void fido_largeblob_index_reset(fido_largeblob_index_t *index, fido_largeblob_entry_t *entries, size_t max_entries, uint8_t *scratch, size_t scratch_len);
+
+/**
+ * @brief Set the buffers used for building Huffman codes when decompressing the blobs found in the index,
+ *        like fido_dev_set_inflate_tables. The index must then not be queried by two threads at the same time.
+ *
+ * @param index The index, after it was reset.
+ * @param tables The buffers, or NULL. Must stay valid while the index is used.
+ */
+void fido_largeblob_index_set_inflate_tables(fido_largeblob_index_t *index, fido_inflate_tables_t *tables);
+
+/**
+ * @brief Parse a serialized large-blob array once and record its entries in the index.
+ *        Entries lacking a ciphertext or nonce are skipped.
+ *
+ * @param index The index to fill. Must have been reset before.
+ * @param largeblob_array The array, as read by fido_dev_largeblob_get_array.
+ * @return success or failure, FIDO_ERR_BUFFER_TOO_SHORT if there are more entries than descriptors
+ *         or a ciphertext does not fit into the scratch buffer.
+ */
+int fido_largeblob_index_build(fido_largeblob_index_t *index, const fido_blob_t *largeblob_array);
+
+/**
+ * @brief Get the blob that was encrypted with key from an indexed large-blob array.
+ *        The array is not modified, so the index can be queried with many keys.
+ *
+ * @param index The index of the array.
+ * @param key The AES key to use for decryption.
+ * @param key_len The length of the AES key. Must be 32 byte.
+ * @param blob The blob to load the data into.
+ * @return success or failure
+ */
+int fido_largeblob_index_find(const fido_largeblob_index_t *index, const uint8_t *key, size_t key_len, fido_blob_t *blob);
+
+#endif
@@ -49,6 +49,7 @@
 /* U2F command flags. */
 #define U2F_AUTH_SIGN                       0x03
 #define U2F_AUTH_CHECK                      0x07
+#define U2F_AUTH_DONT_ENFORCE               0x08
 
 /* ISO7816-4 class bits */
 #define CLA_CHAIN_CONTINUE                  (1 << 4)
@@ -0,0 +1,104 @@
+/*
+ * Copyright (c) 2022 Felix Gohla, Konrad Hanff, Tobias Kantusch,
+ *                    Quentin Kuth, Felix Roth. All rights reserved.
+ *
+ * Use of this source code is governed by a BSD-style
+ * license that can be found in the LICENSE file.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "dev.h"
+
+/**
+ * A list of revoked credential public keys, e.g. for stateless RPs, whose doors cannot forget a credential.
+ * It is built and signed by the updater with tools/build_revocation.py and can be kept in flash.
+ *
+ * The list is a blocked Bloom filter backed by the sorted revoked keys. A key is hashed with a salt,
+ * the hash selects one 64 byte block of the filter and hash count bits within it. Only if all of them
+ * are set, which happens for revoked keys and rarely for others, the sorted keys are searched, so that
+ * a key is never rejected by a false positive.
+ *
+ * Timing: the filter probe has a fixed cost, it always reads all hash count bits of one block.
+ * The binary search only runs on filter hits, so a check takes longer for revoked keys and false
+ * positives and is not constant time overall. This is fine, as neither the keys nor the list are secret.
+ * The image is, all little endian:
+ *
+ *   header (32 bytes):  magic "FRV1" | version (uint32) | key count (uint32) | block count (uint32, a power of two) |
+ *                       hash count (uint8, at most 14) | reserved (3 bytes) | salt (12 bytes)
+ *   blocks:             block count times 64 bytes of the filter
+ *   keys:               key count times the revoked public keys (32 bytes), sorted
+ *   signature:          Ed25519 signature of the updater over everything before (64 bytes)
+ *
+ * Removed with FIDO_NO_REVOCATION (CMake option ENABLE_REVOCATION).
+ */
+
+#define FIDO_REVOCATION_HEADER_SIZE     32
+#define FIDO_REVOCATION_BLOCK_SIZE      64
+#define FIDO_REVOCATION_KEY_SIZE        32
+#define FIDO_REVOCATION_SIGNATURE_SIZE  64
+#define FIDO_REVOCATION_SALT_SIZE       12
+#define FIDO_REVOCATION_MAX_HASHES      14
+
+typedef struct fido_revocation {
+    const uint8_t *salt;        // in the image
+    const uint8_t *blocks;      // in the image
+    const uint8_t *keys;        // in the image
+    size_t block_mask;          // number of blocks - 1
+    size_t key_count;
+    uint8_t hash_count;
+    uint32_t version;           // see the min_version of fido_revocation_init
+} fido_revocation_t;
+
+#ifndef FIDO_NO_REVOCATION
+/**
+ * @brief Open a revocation list image, verifying its signature.
+ *
+ * The signature should be verified whenever an image is received, before it is stored.
+ * An image that was verified then can be opened without the key, e.g. from program memory on the AVR,
+ * which the signature verification cannot read.
+ *
+ * @param revocation The revocation list to initialize.
+ * @param image The image built by tools/build_revocation.py. Must stay valid while the list is used.
+ * @param image_len The length of the image.
+ * @param min_version The smallest version to accept. To prevent a rollback to an older list, pass the version
+ *                    of the stored list to reopen it and that version plus one for an update.
+ * @param updater_public_key The Ed25519 public key (32 bytes) of the updater, or NULL to skip the signature.
+ * @return int FIDO_OK, FIDO_ERR_INVALID_ARGUMENT if the image is malformed or older than min_version
+ *             or FIDO_ERR_INVALID_SIG if its signature is invalid.
+ */
+int fido_revocation_init(fido_revocation_t *revocation, const uint8_t *image, size_t image_len, uint32_t min_version, const uint8_t *updater_public_key);
+
+/**
+ * @brief Check whether a credential public key is revoked.
+ *
+ * @param revocation The revocation list.
+ * @param public_key The public key (32 bytes), e.g. the credential public key of a stateless RP blob.
+ * @return int FIDO_OK if the key is not revoked, FIDO_ERR_REVOKED if it is
+ *             or FIDO_ERR_INTERNAL if SHA256 is not available.
+ */
+int fido_revocation_check(const fido_revocation_t *revocation, const uint8_t *public_key);
+
+/**
+ * @brief Set the revocation list of a device, see fido_dev_check_revocation.
+ *
+ * @param dev A pointer to the FIDO device.
+ * @param revocation The revocation list, or NULL. Must stay valid while the device is used.
+ */
+void fido_dev_set_revocation(fido_dev_t *dev, const fido_revocation_t *revocation);
+#endif
+
+/**
+ * @brief Check a credential public key against the revocation list of a device,
+ *        before verifying an assertion with it.
+ *
+ * Without a revocation list, no key is revoked.
+ *
+ * @param dev A pointer to the FIDO device.
+ * @param public_key The public key (32 bytes).
+ * @return int FIDO_OK if the key is not revoked, FIDO_ERR_REVOKED if it is.
+ */
+int fido_dev_check_revocation(fido_dev_t *dev, const uint8_t *public_key);
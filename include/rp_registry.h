@@ -0,0 +1,100 @@
+/*
+ * Copyright (c) 2022 Felix Gohla, Konrad Hanff, Tobias Kantusch,
+ *                    Quentin Kuth, Felix Roth. All rights reserved.
+ *
+ * Use of this source code is governed by a BSD-style
+ * license that can be found in the LICENSE file.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "assertion.h"
+
+/**
+ * A registry of relying parties, e.g. for a gateway that serves many RPs.
+ *
+ * The rpIdHash of every RP is computed once when it is added, and the RPs are kept in an
+ * open-addressing hash table indexed by the rpIdHash, which is uniformly distributed already.
+ * An assertion is then resolved to its RP from the rpIdHash of its authenticator data
+ * with a single probe on average, without hashing the rpId again.
+ * The RPs and the table are allocated by the user.
+ *
+ * Removed with FIDO_NO_RP_REGISTRY (CMake option ENABLE_RP_REGISTRY).
+ */
+
+/**
+ * A relying party and the public keys that are trusted for it.
+ */
+typedef struct fido_rp {
+    const char *id;                                         // rpId, must stay valid
+    size_t id_len;
+    uint8_t id_hash[ASSERTION_AUTH_DATA_RPID_HASH_LEN];     // SHA256(rpId)
+    int cose_alg;                                           // COSE algorithm of the public keys
+    const uint8_t *public_keys;                             // consecutive public keys, see fido_assert_verify
+    size_t public_key_count;
+    void *ctx;                                              // for the user
+} fido_rp_t;
+
+typedef struct fido_rp_registry {
+    fido_rp_t *rps;
+    size_t max_count;
+    size_t count;
+    uint16_t *slots;    // index + 1 of the RP in rps, 0 if the slot is empty
+    size_t slot_mask;   // number of slots - 1
+} fido_rp_registry_t;
+
+#ifndef FIDO_NO_RP_REGISTRY
+/**
+ * @brief Initialize an empty registry.
+ *
+ * @param registry The registry to initialize.
+ * @param rps Storage for the RPs.
+ * @param max_count The number of RPs that fit into rps, at most 65535.
+ * @param slots Storage for the hash table. Should have about twice as many slots as RPs.
+ * @param slot_count The number of slots, a power of two larger than max_count.
+ * @return int FIDO_OK, or FIDO_ERR_INVALID_ARGUMENT if the sizes do not fit.
+ */
+int fido_rp_registry_init(fido_rp_registry_t *registry, fido_rp_t *rps, size_t max_count, uint16_t *slots, size_t slot_count);
+
+/**
+ * @brief Add an RP to a registry, computing its rpIdHash.
+ *
+ * @param registry The registry.
+ * @param rp_id The rpId. Must stay valid while the registry is used.
+ * @param cose_alg The COSE algorithm of the public keys.
+ * @param public_keys The consecutive public keys trusted for the RP (32 bytes each for EdDSA, 64 for ES256).
+ *                    Must stay valid while the registry is used.
+ * @param public_key_count The number of public keys.
+ * @return fido_rp_t* The added RP, e.g. to set its ctx, or NULL if the registry is full,
+ *                    SHA256 is not available or the RP was added before.
+ */
+fido_rp_t *fido_rp_registry_add(fido_rp_registry_t *registry, const char *rp_id, int cose_alg, const uint8_t *public_keys, size_t public_key_count);
+
+/**
+ * @brief Look up an RP by its rpIdHash.
+ *
+ * @param registry The registry.
+ * @param rp_id_hash The rpIdHash (32 bytes), e.g. of the authenticator data of an assertion.
+ * @return const fido_rp_t* The RP, or NULL if it is not in the registry.
+ */
+const fido_rp_t *fido_rp_registry_find(const fido_rp_registry_t *registry, const uint8_t *rp_id_hash);
+
+#ifndef FIDO_NO_ASSERT_VERIFY
+/**
+ * @brief Verify an assertion against the RP of a registry that its authenticator data names.
+ *
+ * Unlike fido_assert_verify, the rpId of the assertion is not hashed. If it is set,
+ * it has to match the rpId of the RP. The signature is checked with every trusted key of the RP
+ * until one matches.
+ *
+ * @param assert A pointer to an assertion request/reply struct.
+ * @param registry The registry.
+ * @param rp A pointer to store the RP of the assertion to, may be NULL.
+ * @return int FIDO_OK if the signature is valid, FIDO_ERR_NOTFOUND if the RP is unknown.
+ */
+int fido_assert_verify_rp_registry(const fido_assert_t *assert, const fido_rp_registry_t *registry, const fido_rp_t **rp);
+#endif
+#endif
@@ -0,0 +1,158 @@
+/*
+ * Copyright (c) 2022 Felix Gohla, Konrad Hanff, Tobias Kantusch,
+ *                    Quentin Kuth, Felix Roth. All rights reserved.
+ *
+ * Use of this source code is governed by a BSD-style
+ * license that can be found in the LICENSE file.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "assertion.h"
+
+/**
+ * A store of the signature counters of credentials in flash, to detect cloned authenticators.
+ *
+ * Counters are appended as records to the active page of at least two flash pages, so that a tap
+ * writes 16 bytes instead of erasing a page. A RAM index of the latest counter of every credential,
+ * an open-addressing hash table over the truncated SHA256 of the credential IDs, is rebuilt from the
+ * active page when the store is initialized, so a lookup costs one hash and a probe or two.
+ * When the active page is full, the latest counters are written to the next page, which then
+ * becomes the active one (compaction). Its header is written last, so that the store survives
+ * a power loss at any time.
+ *
+ *   page header (16 bytes): magic "FSC1" | sequence number (uint32) | inverted sequence number (uint32) | reserved
+ *   record (16 bytes):      truncated SHA256(credential ID) (8 bytes) | counter (uint32) | inverted counter (uint32)
+ *
+ * all little endian. The flash is accessed with functions of the user.
+ *
+ * Removed with FIDO_NO_SIGN_COUNT (CMake option ENABLE_SIGN_COUNT).
+ */
+
+#define FIDO_SIGN_COUNT_HEADER_SIZE 16
+#define FIDO_SIGN_COUNT_RECORD_SIZE 16
+#define FIDO_SIGN_COUNT_HASH_SIZE   8
+
+/**
+ * @brief Read from flash.
+ *
+ * @param ctx The context of the flash.
+ * @param address The address relative to the start of the first page.
+ * @param data The buffer to read into.
+ * @param len The number of bytes to read.
+ * @return int 0 on success.
+ */
+typedef int fido_sign_count_read_t(void *ctx, size_t address, uint8_t *data, size_t len);
+
+/**
+ * @brief Program erased flash. Records and headers are written at once and never cross a page.
+ *
+ * @param ctx The context of the flash.
+ * @param address The address relative to the start of the first page, a multiple of 16.
+ * @param data The data to write.
+ * @param len The number of bytes to write, 16.
+ * @return int 0 on success.
+ */
+typedef int fido_sign_count_write_t(void *ctx, size_t address, const uint8_t *data, size_t len);
+
+/**
+ * @brief Erase a flash page, so that it reads as 0xff.
+ *
+ * @param ctx The context of the flash.
+ * @param address The address of the page relative to the start of the first page.
+ * @return int 0 on success.
+ */
+typedef int fido_sign_count_erase_t(void *ctx, size_t address);
+
+/**
+ * @brief The flash of a store, consecutive pages accessed with functions of the user.
+ */
+typedef struct fido_sign_count_flash {
+    fido_sign_count_read_t  *read;
+    fido_sign_count_write_t *write;
+    fido_sign_count_erase_t *erase;
+    void                    *ctx;
+    size_t                  page_size;  // a multiple of 16
+    size_t                  page_count; // at least 2
+} fido_sign_count_flash_t;
+
+typedef struct fido_sign_count_entry {
+    uint8_t hash[FIDO_SIGN_COUNT_HASH_SIZE];
+    uint32_t count;
+} fido_sign_count_entry_t;
+
+typedef struct fido_sign_count_store {
+    const fido_sign_count_flash_t *flash;
+    fido_sign_count_entry_t *entries;   // the latest counters
+    size_t max_count;
+    size_t count;
+    uint16_t *slots;                    // index + 1 of the entry, 0 if the slot is empty
+    size_t slot_mask;                   // number of slots - 1
+    size_t page;                        // the active page
+    size_t write_offset;                // offset of the next record in the active page
+    uint32_t sequence;                  // sequence number of the active page
+} fido_sign_count_store_t;
+
+#ifndef FIDO_NO_SIGN_COUNT
+/**
+ * @brief Initialize a store, rebuilding the index from the active page, or formatting the flash if it has none.
+ *
+ * @param store The store to initialize.
+ * @param flash The flash of the store. Must stay valid while the store is used.
+ * @param entries Storage for the counters of max_count credentials.
+ * @param max_count The number of credentials, at most 65535. Their records have to fit into a page with the header.
+ * @param slots Storage for the index. Should have about twice as many slots as credentials.
+ * @param slot_count The number of slots, a power of two larger than max_count.
+ * @return int FIDO_OK, FIDO_ERR_INVALID_ARGUMENT if the sizes do not fit or the flash holds more credentials,
+ *             or FIDO_ERR_INTERNAL if the flash cannot be accessed.
+ */
+int fido_sign_count_store_init(fido_sign_count_store_t *store, const fido_sign_count_flash_t *flash, fido_sign_count_entry_t *entries, size_t max_count, uint16_t *slots, size_t slot_count);
+
+/**
+ * @brief Check the signature counter of a credential and store it.
+ *
+ * The counter has to be larger than the stored one. Authenticators without counters always return 0,
+ * which is accepted as long as no other counter was stored, and is not written.
+ *
+ * @param store The store.
+ * @param id The credential ID.
+ * @param id_len The length of the credential ID.
+ * @param count The signature counter of the assertion.
+ * @return int FIDO_OK, FIDO_ERR_SIGN_COUNT if the counter did not increase, FIDO_ERR_BUFFER_TOO_SHORT if the store is full,
+ *             or FIDO_ERR_INTERNAL if SHA256 is not available or the flash cannot be accessed.
+ */
+int fido_sign_count_store_update(fido_sign_count_store_t *store, const uint8_t *id, size_t id_len, uint32_t count);
+
+/**
+ * @brief Write the latest counters to the next page, e.g. when idle and the active page is almost full,
+ *        so that no tap has to wait for it.
+ *
+ * @param store The store.
+ * @return int FIDO_OK, or FIDO_ERR_INTERNAL if the flash cannot be accessed.
+ */
+int fido_sign_count_store_compact(fido_sign_count_store_t *store);
+
+/**
+ * @brief Get the number of records that can still be appended before the next compaction.
+ *
+ * @param store The store.
+ * @return size_t The number of records.
+ */
+size_t fido_sign_count_store_free(const fido_sign_count_store_t *store);
+
+#ifndef FIDO_NO_ASSERT_VERIFY
+/**
+ * @brief Verify an assertion like fido_assert_verify, then check and store its signature counter.
+ *
+ * @param assert A pointer to an assertion request/reply struct.
+ * @param cose_alg The COSE algorithm of the public key.
+ * @param pk The public key of the credential, see fido_assert_verify.
+ * @param store The store.
+ * @return int FIDO_OK if the signature is valid and the counter increased, FIDO_ERR_SIGN_COUNT if it did not.
+ */
+int fido_assert_verify_sign_count(const fido_assert_t *assert, const int cose_alg, const uint8_t *pk, fido_sign_count_store_t *store);
+#endif
+#endif
@@ -0,0 +1,133 @@
+/*
+ * Copyright (c) 2022 Felix Gohla, Konrad Hanff, Tobias Kantusch,
+ *                    Quentin Kuth, Felix Roth. All rights reserved.
+ *
+ * Use of this source code is governed by a BSD-style
+ * license that can be found in the LICENSE file.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "fido_config.h"
+
+/**
+ * Tracing of the phases of an operation, enabled with FIDO_TRACING (CMake option ENABLE_TRACING).
+ *
+ * Begin and end events are recorded into a fixed-size ring buffer, with timestamps taken from
+ * a clock set by the user, e.g. a cycle counter like examples/nrf52/clock/clock_cycles.h.
+ * Without FIDO_TRACING, the trace macros compile to nothing.
+ */
+
+typedef enum fido_trace_id {
+    FIDO_TRACE_TX = 0,  // fido_tx, arg is the command
+    FIDO_TRACE_RX,      // fido_rx, arg is the command
+    FIDO_TRACE_APDU_TX, // a single command APDU, arg is its length
+    FIDO_TRACE_APDU_RX, // a single response APDU, arg is its length
+    FIDO_TRACE_CBOR,    // parsing a CBOR response or large-blob entry, arg is its length
+    FIDO_TRACE_HASH,    // hashing, arg is the length of the data
+    FIDO_TRACE_AES_GCM, // AES-GCM decryption, arg is the length of the ciphertext
+    FIDO_TRACE_INFLATE, // decompression, arg is the length of the compressed data
+    FIDO_TRACE_VERIFY,  // signature verification, arg is the COSE algorithm
+    FIDO_TRACE_ID_COUNT,
+} fido_trace_id_t;
+
+#define FIDO_TRACE_PHASE_BEGIN 'B'
+#define FIDO_TRACE_PHASE_END   'E'
+
+// The number of events the ring buffer holds. Older events are overwritten,
+// so a full buffer may start with end events whose begin events are lost.
+#ifndef FIDO_TRACE_BUFFER_SIZE
+#define FIDO_TRACE_BUFFER_SIZE 128
+#endif
+
+typedef struct fido_trace_event {
+    uint64_t timestamp; // In ticks of the trace clock
+    uint32_t arg;
+    uint8_t id;         // See fido_trace_id_t
+    uint8_t phase;      // FIDO_TRACE_PHASE_BEGIN or FIDO_TRACE_PHASE_END
+} fido_trace_event_t;
+
+/**
+ * @brief Returns the current time in ticks.
+ */
+typedef uint64_t (*fido_trace_clock_t)(void);
+
+/**
+ * @brief Receives a part of an exported trace.
+ *
+ * @param data The data to write.
+ * @param data_len The length of the data.
+ * @param ctx The context passed to the exporter.
+ * @return int FIDO_OK to continue, any other value aborts the export with that error.
+ */
+typedef int (*fido_trace_write_t)(const char *data, size_t data_len, void *ctx);
+
+#ifdef FIDO_TRACING
+
+/**
+ * @brief Set the clock for the timestamps of the events. Without a clock, no events are recorded.
+ *
+ * @param clock The clock, or NULL to stop tracing.
+ * @param ticks_per_us The number of clock ticks per microsecond, used for exporting.
+ */
+void fido_trace_set_clock(fido_trace_clock_t clock, uint32_t ticks_per_us);
+
+/**
+ * @brief Remove all events from the ring buffer.
+ */
+void fido_trace_reset(void);
+
+/**
+ * @brief Record an event. Use the FIDO_TRACE_BEGIN and FIDO_TRACE_END macros instead.
+ *
+ * @param id The fido_trace_id_t of the event.
+ * @param phase FIDO_TRACE_PHASE_BEGIN or FIDO_TRACE_PHASE_END.
+ * @param arg An argument depending on the id.
+ */
+void fido_trace_record(uint8_t id, uint8_t phase, uint32_t arg);
+
+/**
+ * @brief Get the number of events in the ring buffer.
+ *
+ * @return size_t The number of events, at most FIDO_TRACE_BUFFER_SIZE.
+ */
+size_t fido_trace_count(void);
+
+/**
+ * @brief Get an event from the ring buffer.
+ *
+ * @param index The index of the event, 0 is the oldest one.
+ * @return const fido_trace_event_t* The event or NULL if index is out of range.
+ */
+const fido_trace_event_t *fido_trace_get(size_t index);
+
+/**
+ * @brief Get the name of an event, e.g. "tx".
+ *
+ * @param id The fido_trace_id_t of the event.
+ * @return const char* The name.
+ */
+const char *fido_trace_name(uint8_t id);
+
+/**
+ * @brief Export the events in the ring buffer in the Chrome trace event format,
+ *        which can be viewed with chrome://tracing or Perfetto.
+ *
+ * @param write The callback receiving the JSON.
+ * @param ctx The context passed to the callback.
+ * @return int FIDO_OK on success or the error of the callback.
+ */
+int fido_trace_export_chrome(fido_trace_write_t write, void *ctx);
+
+#define FIDO_TRACE_BEGIN(id, arg) fido_trace_record((id), FIDO_TRACE_PHASE_BEGIN, (uint32_t)(arg))
+#define FIDO_TRACE_END(id, arg)   fido_trace_record((id), FIDO_TRACE_PHASE_END, (uint32_t)(arg))
+
+#else
+
+#define FIDO_TRACE_BEGIN(id, arg) do {} while(0)
+#define FIDO_TRACE_END(id, arg)   do {} while(0)
+
+#endif
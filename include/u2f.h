@@ -0,0 +1,35 @@
+/*
+ * Copyright (c) 2022 Felix Gohla, Konrad Hanff, Tobias Kantusch,
+ *                    Quentin Kuth, Felix Roth. All rights reserved.
+ *
+ * Use of this source code is governed by a BSD-style
+ * license that can be found in the LICENSE file.
+ */
+
+#pragma once
+
+#include "assertion.h"
+#include "dev.h"
+
+// The ECDSA signature of the U2F authenticate response is DER encoded:
+// SEQUENCE of two INTEGERs with up to 33 bytes each.
+#define U2F_MAX_SIGNATURE_LENGTH ASSERTION_ES256_DER_SIGNATURE_MAX_LENGTH
+
+#ifndef FIDO_NO_U2F
+/**
+ * @brief Get an assertion from a U2F (CTAP1) device with the U2F authenticate command.
+ *
+ * The request is a short APDU of fixed layout: the client data hash is the challenge, the SHA256 hash of
+ * the relying party ID the application parameter and the credential set with fido_assert_set_allow_credential
+ * the key handle. The reply is stored in the same form as the one of authenticatorGetAssertion,
+ * with authenticator data made of the application parameter, the flags and the counter and
+ * the DER encoded signature, so that it can be checked with fido_assert_verify and COSE_ALGORITHM_ES256.
+ *
+ * fido_dev_get_assert calls this for devices that do not support CTAP2.
+ *
+ * @param dev The device to read from.
+ * @param assert Options for the assertion. User verification and extensions are not supported.
+ * @return int FIDO_OK if the operation was successful, FIDO_ERR_USER_PRESENCE_REQUIRED if the device waits for the user.
+ */
+int fido_dev_u2f_authenticate(fido_dev_t *dev, fido_assert_t *assert);
+#endif
@@ -39,8 +39,12 @@
 #include <avr/pgmspace.h>
 #define PROGMEM_MARKER PROGMEM
 #define memcmp_progmem memcmp_P
+#define read_progmem_byte(addr) pgm_read_byte(addr)
+#define read_progmem_word(addr) pgm_read_word(addr)
 #else
 #define PROGMEM_MARKER
 #define memcmp_progmem memcmp
 #define memcpy_progmem memcpy
+#define read_progmem_byte(addr) (*(const uint8_t *)(addr))
+#define read_progmem_word(addr) (*(const uint16_t *)(addr))
 #endif
@@ -0,0 +1,108 @@
+/*
+ * Copyright (c) 2022 Felix Gohla, Konrad Hanff, Tobias Kantusch,
+ *                    Quentin Kuth, Felix Roth. All rights reserved.
+ *
+ * Use of this source code is governed by a BSD-style
+ * license that can be found in the LICENSE file.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "dev.h"
+
+/**
+ * A cache of Ed25519 signatures that were verified successfully, e.g. the signature of the updater
+ * over the credential public key in the large blob of a stateless RP, which is the same on every tap.
+ *
+ * The cache is a 2-way set-associative table of the first FIDO_VERIFY_CACHE_TAG_SIZE bytes of
+ * SHA256(public key || signature || message), so a hit costs one hash instead of a verification.
+ * It is allocated by the user and set on a device with fido_dev_set_verify_cache.
+ * Whoever can write to the table, including its persistent copy, can make signatures pass,
+ * so it must be kept where the signatures themselves could not be forged.
+ *
+ * Removed with FIDO_NO_VERIFY_CACHE (CMake option ENABLE_VERIFY_CACHE).
+ */
+
+// The number of sets of the table, with 2 entries each. Configurable with the CMake option VERIFY_CACHE_SETS.
+#ifndef FIDO_VERIFY_CACHE_SETS
+#define FIDO_VERIFY_CACHE_SETS 8
+#endif
+
+#define FIDO_VERIFY_CACHE_WAYS      2
+#define FIDO_VERIFY_CACHE_TAG_SIZE  16
+
+typedef struct fido_verify_cache_table {
+    uint8_t tags[FIDO_VERIFY_CACHE_SETS][FIDO_VERIFY_CACHE_WAYS][FIDO_VERIFY_CACHE_TAG_SIZE];
+    uint8_t state[FIDO_VERIFY_CACHE_SETS]; // valid bits of the ways and the way to replace next
+} fido_verify_cache_table_t;
+
+/**
+ * @brief Load the table of a cache from persistent storage.
+ *
+ * @param table The table to fill.
+ * @param ctx The context passed to fido_verify_cache_init.
+ * @return int 0 if the table was loaded, any other value starts with an empty table.
+ */
+typedef int (*fido_verify_cache_load_t)(fido_verify_cache_table_t *table, void *ctx);
+
+/**
+ * @brief Store the table of a cache in persistent storage. Called whenever the table changes.
+ *
+ * @param table The table to store.
+ * @param ctx The context passed to fido_verify_cache_init.
+ */
+typedef void (*fido_verify_cache_save_t)(const fido_verify_cache_table_t *table, void *ctx);
+
+typedef struct fido_verify_cache {
+    fido_verify_cache_table_t table;
+    fido_verify_cache_save_t  save; // optional
+    void                      *ctx; // passed to save
+} fido_verify_cache_t;
+
+#ifndef FIDO_NO_VERIFY_CACHE
+/**
+ * @brief Initialize a cache, optionally with a table loaded from persistent storage.
+ *
+ * @param cache The cache to initialize.
+ * @param load The function to load the table with, or NULL to start with an empty table.
+ * @param save The function to store the table with, or NULL.
+ * @param ctx The context passed to load and save.
+ */
+void fido_verify_cache_init(fido_verify_cache_t *cache, fido_verify_cache_load_t load, fido_verify_cache_save_t save, void *ctx);
+
+/**
+ * @brief Remove all entries of a cache, e.g. when the key of the updater changes.
+ *
+ * @param cache The cache to clear.
+ */
+void fido_verify_cache_clear(fido_verify_cache_t *cache);
+
+/**
+ * @brief Set the cache of verified signatures of a device, see fido_dev_ed25519_verify.
+ *
+ * The cache is not tied to the device, so the same cache can be set again after the device was initialized.
+ *
+ * @param dev A pointer to the FIDO device.
+ * @param cache The cache, or NULL. Must stay valid while the device is used.
+ */
+void fido_dev_set_verify_cache(fido_dev_t *dev, fido_verify_cache_t *cache);
+#endif
+
+/**
+ * @brief Verify an Ed25519 signature with fido_ed25519_verify, unless the cache of the device has it.
+ *
+ * Successfully verified signatures are added to the cache. The lookups are counted as
+ * cache_hits and cache_misses in the statistics of the device.
+ * Without a cache, this is the same as fido_ed25519_verify.
+ *
+ * @param dev A pointer to the FIDO device.
+ * @param signature Pointer to the signature (64 bytes) to verify.
+ * @param public_key Pointer to the public key (32 bytes) to verify with.
+ * @param message Pointer to the message that was signed.
+ * @param message_len Length of the message.
+ * @return int 0 if the signature is valid.
+ */
+int fido_dev_ed25519_verify(fido_dev_t *dev, const uint8_t *signature, const uint8_t *public_key, const uint8_t *message, size_t message_len);
@@ -0,0 +1,650 @@
+/*
+ * Copyright (c) 2022 Felix Gohla, Konrad Hanff, Tobias Kantusch,
+ *                    Quentin Kuth, Felix Roth. All rights reserved.
+ *
+ * Use of this source code is governed by a BSD-style
+ * license that can be found in the LICENSE file.
+ */
+
+#include "simulator.h"
+
+#include <cbor.h>
+#include <monocypher-ed25519.h>
+
+#include <string.h>
+#include <time.h>
+
+#define NFC_INS_SELECT       0xa4
+#define NFC_INS_CTAP_MSG     0x10
+#define NFC_INS_GET_RESPONSE 0xc0
+#define NFC_CLA_CHAIN        0x10
+
+#define SW_WRONG_LENGTH          0x6700
+#define SW_INS_NOT_SUPPORTED     0x6d00
+
+// ISO 14443-A: every byte is followed by a parity bit, every frame has a PCB and a two byte CRC.
+#define FIDO_SIM_BITS_PER_BYTE 9
+#define FIDO_SIM_FRAME_OVERHEAD 3
+
+#define FIDO_SIM_AUTH_DATA_LEN (ASSERTION_AUTH_DATA_RPID_HASH_LEN + 1 + 4)
+#define FIDO_SIM_LARGEBLOB_DIGEST_LEN 16
+#define FIDO_SIM_STORED_BLOCK_MAX 65535
+
+static const uint8_t fido_sim_version[] = "FIDO_2_0";
+static const uint8_t fido_sim_aaguid[16] = "0123456789012345";
+
+static fido_sim_t *fido_sim_attached = NULL;
+
+void fido_sim_config_default(fido_sim_config_t *config) {
+    memset(config, 0, sizeof(*config));
+    config->max_msg_size = 1024;
+    config->max_large_blob = 2048;
+    config->link_kbps = FIDO_SIM_LINK_106K;
+    config->frame_size = 256;
+    config->frame_latency_us = 100;
+}
+
+/**
+ * @brief Derive a key from the seed of the simulator.
+ *
+ * @param sim The simulator.
+ * @param label The purpose of the key.
+ * @param index The index of the key for that purpose.
+ * @param out The derived key.
+ */
+static void fido_sim_derive(const fido_sim_t *sim, char label, uint32_t index, uint8_t out[FIDO_SIM_KEY_SIZE]) {
+    uint8_t input[1 + FIDO_SIM_KEY_SIZE + 4];
+    input[0] = (uint8_t)label;
+    memcpy(input + 1, sim->seed, FIDO_SIM_KEY_SIZE);
+    input[1 + FIDO_SIM_KEY_SIZE + 0] = (uint8_t)index;
+    input[1 + FIDO_SIM_KEY_SIZE + 1] = (uint8_t)(index >> 8);
+    input[1 + FIDO_SIM_KEY_SIZE + 2] = (uint8_t)(index >> 16);
+    input[1 + FIDO_SIM_KEY_SIZE + 3] = (uint8_t)(index >> 24);
+    fido_sha256(input, sizeof(input), out);
+}
+
+/**
+ * @brief Append LEFT(SHA-256(array), 16) to the serialized large-blob array.
+ *
+ * @param sim The simulator.
+ * @param array_len The length of the array without the digest.
+ * @return int FIDO_OK on success.
+ */
+static int fido_sim_finish_large_blobs(fido_sim_t *sim, size_t array_len) {
+    uint8_t digest[SHA256_DIGEST_SIZE];
+
+    if (array_len + FIDO_SIM_LARGEBLOB_DIGEST_LEN > sim->large_blob_max_len) {
+        sim->large_blob_len = 0;
+        return FIDO_ERR_BUFFER_TOO_SHORT;
+    }
+    fido_sha256(sim->large_blob, array_len, digest);
+    memcpy(sim->large_blob + array_len, digest, FIDO_SIM_LARGEBLOB_DIGEST_LEN);
+    sim->large_blob_len = array_len + FIDO_SIM_LARGEBLOB_DIGEST_LEN;
+    return FIDO_OK;
+}
+
+int fido_sim_init(fido_sim_t *sim, const fido_sim_config_t *config, const uint8_t seed[FIDO_SIM_KEY_SIZE], uint8_t *large_blob_buffer, size_t large_blob_buffer_len) {
+    if (fido_sha256 == NULL) {
+        return FIDO_ERR_INTERNAL;
+    }
+
+    memset(sim, 0, sizeof(*sim));
+    sim->config = *config;
+    if (seed != NULL) {
+        memcpy(sim->seed, seed, sizeof(sim->seed));
+    }
+
+    fido_sim_derive(sim, 'i', 0, sim->credential.id);
+    fido_sim_derive(sim, 'c', 0, sim->credential.secret_key);
+    fido_sim_derive(sim, 'l', 0, sim->credential.large_blob_key);
+    fido_sim_derive(sim, 'u', 0, sim->updater_secret_key);
+    crypto_ed25519_public_key(sim->credential.public_key, sim->credential.secret_key);
+    crypto_ed25519_public_key(sim->updater_public_key, sim->updater_secret_key);
+
+    // Start with an empty array.
+    sim->large_blob = large_blob_buffer;
+    sim->large_blob_max_len = large_blob_buffer_len;
+    if (large_blob_buffer_len < 1) {
+        return FIDO_ERR_BUFFER_TOO_SHORT;
+    }
+    sim->large_blob[0] = 0x80;
+    return fido_sim_finish_large_blobs(sim, 1);
+}
+
+/**
+ * @brief Get the length of data stored in raw DEFLATE stored blocks.
+ *
+ * @param data_len The length of the data.
+ * @return size_t The length of the DEFLATE stream.
+ */
+static size_t fido_sim_stored_len(size_t data_len) {
+    size_t blocks = data_len == 0 ? 1 : (data_len + FIDO_SIM_STORED_BLOCK_MAX - 1) / FIDO_SIM_STORED_BLOCK_MAX;
+    return data_len + 5 * blocks;
+}
+
+/**
+ * @brief "Compress" data into raw DEFLATE stored blocks.
+ *
+ * @param out The buffer of fido_sim_stored_len(data_len) bytes.
+ * @param data The data.
+ * @param data_len The length of the data.
+ */
+static void fido_sim_stored_deflate(uint8_t *out, const uint8_t *data, size_t data_len) {
+    do {
+        uint16_t len = data_len > FIDO_SIM_STORED_BLOCK_MAX ? FIDO_SIM_STORED_BLOCK_MAX : (uint16_t)data_len;
+        uint16_t nlen = (uint16_t)~len;
+        out[0] = len == data_len ? 0x01 : 0x00; // BFINAL, BTYPE 00
+        out[1] = (uint8_t)len;
+        out[2] = (uint8_t)(len >> 8);
+        out[3] = (uint8_t)nlen;
+        out[4] = (uint8_t)(nlen >> 8);
+        memcpy(out + 5, data, len);
+        out += 5 + len;
+        data += len;
+        data_len -= len;
+    } while (data_len > 0);
+}
+
+int fido_sim_set_large_blobs(fido_sim_t *sim, size_t entry_count, size_t match_index, const uint8_t *data, size_t data_len) {
+    size_t compressed_len = fido_sim_stored_len(data_len);
+    uint8_t compressed[compressed_len];
+    uint8_t ciphertext[compressed_len + AES_GCM_TAG_SIZE];
+    uint8_t associated_data[LARGEBLOB_ASSOCIATED_DATA_SIZE] = { 'b', 'l', 'o', 'b' };
+    uint8_t key[LARGEBLOB_KEY_SIZE];
+    uint8_t nonce[FIDO_SIM_KEY_SIZE];
+    cbor_writer_s writer;
+
+    if (fido_aes_gcm_encrypt == NULL) {
+        return FIDO_ERR_INTERNAL;
+    }
+
+    fido_sim_stored_deflate(compressed, data, data_len);
+    for (size_t i = 0; i < 8; i++) {
+        associated_data[4 + i] = (uint8_t)((uint64_t)data_len >> (8 * i));
+    }
+
+    cbor_writer_reset(&writer, sim->large_blob, sim->large_blob_max_len);
+    cbor_encode_array_start(&writer, entry_count);
+    for (size_t i = 0; i < entry_count; i++) {
+        // The other entries hold the same data, but nobody but the simulator knows their keys.
+        if (i == match_index) {
+            memcpy(key, sim->credential.large_blob_key, sizeof(key));
+        } else {
+            fido_sim_derive(sim, 'k', (uint32_t)i, key);
+        }
+        fido_sim_derive(sim, 'n', (uint32_t)i, nonce);
+
+        if (fido_aes_gcm_encrypt(
+                key, sizeof(key),
+                nonce, LARGEBLOB_NONCE_SIZE,
+                compressed, compressed_len,
+                associated_data, sizeof(associated_data),
+                ciphertext, ciphertext + compressed_len
+            ) != 0) {
+            return FIDO_ERR_INTERNAL;
+        }
+
+        cbor_encode_map_start(&writer, 3);
+        cbor_encode_uint(&writer, 0x01); // ciphertext
+        cbor_encode_bytestring(&writer, ciphertext, sizeof(ciphertext));
+        cbor_encode_uint(&writer, 0x02); // nonce
+        cbor_encode_bytestring(&writer, nonce, LARGEBLOB_NONCE_SIZE);
+        cbor_encode_uint(&writer, 0x03); // origSize
+        cbor_encode_uint(&writer, data_len);
+        if (!cbor_writer_is_ok(&writer)) {
+            sim->large_blob_len = 0;
+            return FIDO_ERR_BUFFER_TOO_SHORT;
+        }
+    }
+
+    return fido_sim_finish_large_blobs(sim, writer.length);
+}
+
+int fido_sim_set_cred_blob(fido_sim_t *sim, const uint8_t *data, size_t data_len) {
+    if (data_len > sizeof(sim->credential.cred_blob)) {
+        return FIDO_ERR_BUFFER_TOO_SHORT;
+    }
+    memcpy(sim->credential.cred_blob, data, data_len);
+    sim->credential.cred_blob_len = data_len;
+    return FIDO_OK;
+}
+
+void fido_sim_stateless_rp_blob(const fido_sim_t *sim, uint8_t blob[FIDO_SIM_KEY_SIZE + 64]) {
+    memcpy(blob, sim->credential.public_key, FIDO_SIM_KEY_SIZE);
+    crypto_ed25519_sign(blob + FIDO_SIM_KEY_SIZE, sim->updater_secret_key, sim->updater_public_key, sim->credential.public_key, FIDO_SIM_KEY_SIZE);
+}
+
+/*
+ * Timing model.
+ */
+
+/**
+ * @brief Advance the virtual clock and sleep as long if requested.
+ *
+ * @param sim The simulator.
+ * @param ns The time to advance the clock by.
+ */
+static void fido_sim_advance(fido_sim_t *sim, uint64_t ns) {
+    sim->clock_ns += ns;
+    if (sim->config.real_time && ns > 0) {
+        struct timespec ts = {
+            .tv_sec = (time_t)(ns / 1000000000u),
+            .tv_nsec = (long)(ns % 1000000000u),
+        };
+        while (nanosleep(&ts, &ts) != 0) {
+        }
+    }
+}
+
+/**
+ * @brief Account for the transfer of an APDU over the link.
+ *        APDUs larger than a frame are split into frames, each of which is acknowledged by the receiver.
+ *
+ * @param sim The simulator.
+ * @param len The length of the APDU.
+ */
+static void fido_sim_transfer(fido_sim_t *sim, size_t len) {
+    size_t frame_payload = sim->config.frame_size > FIDO_SIM_FRAME_OVERHEAD ? sim->config.frame_size - FIDO_SIM_FRAME_OVERHEAD : len;
+    size_t frames = len == 0 || frame_payload == 0 ? 1 : (len + frame_payload - 1) / frame_payload;
+
+    sim->stats.frames += frames;
+    if (sim->config.link_kbps == FIDO_SIM_LINK_UNLIMITED) {
+        return;
+    }
+
+    // Data frames plus an acknowledgement for every frame except the last.
+    uint64_t bytes = len + frames * FIDO_SIM_FRAME_OVERHEAD + (frames - 1) * FIDO_SIM_FRAME_OVERHEAD;
+    uint64_t bits = bytes * FIDO_SIM_BITS_PER_BYTE;
+    uint64_t turnarounds = 2 * frames - 1;
+    fido_sim_advance(sim, bits * 1000000u / sim->config.link_kbps + turnarounds * sim->config.frame_latency_us * 1000u);
+}
+
+void fido_sim_reset_clock(fido_sim_t *sim) {
+    sim->clock_ns = 0;
+    memset(&sim->stats, 0, sizeof(sim->stats));
+}
+
+/*
+ * CTAP commands.
+ */
+
+/**
+ * @brief Encode the getInfo response.
+ *
+ * @param sim The simulator.
+ * @param writer The writer for the response.
+ */
+static void fido_sim_get_info(fido_sim_t *sim, cbor_writer_t writer) {
+    static const uint8_t version[] = "FIDO_2_1";
+    static const uint8_t extension[] = "largeBlobKey";
+    static const uint8_t extension_cred_blob[] = "credBlob";
+    static const uint8_t option[] = "largeBlobs";
+    static const uint8_t transport[] = "nfc";
+    const bool cred_blob = sim->config.max_cred_blob > 0;
+
+    cbor_encode_map_start(writer, cred_blob ? 8 : 7);
+    cbor_encode_uint(writer, 0x01); // versions
+    cbor_encode_array_start(writer, 1);
+    cbor_encode_string(writer, version, sizeof(version) - 1);
+    cbor_encode_uint(writer, 0x02); // extensions
+    cbor_encode_array_start(writer, cred_blob ? 2 : 1);
+    cbor_encode_string(writer, extension, sizeof(extension) - 1);
+    if (cred_blob) {
+        cbor_encode_string(writer, extension_cred_blob, sizeof(extension_cred_blob) - 1);
+    }
+    cbor_encode_uint(writer, 0x03); // aaguid
+    cbor_encode_bytestring(writer, fido_sim_aaguid, sizeof(fido_sim_aaguid));
+    cbor_encode_uint(writer, 0x04); // options
+    cbor_encode_map_start(writer, 1);
+    cbor_encode_string(writer, option, sizeof(option) - 1);
+    cbor_encode_boolean(writer, true);
+    cbor_encode_uint(writer, 0x05); // maxMsgSize
+    cbor_encode_uint(writer, sim->config.max_msg_size);
+    cbor_encode_uint(writer, 0x09); // transports
+    cbor_encode_array_start(writer, 1);
+    cbor_encode_string(writer, transport, sizeof(transport) - 1);
+    cbor_encode_uint(writer, 0x0b); // maxSerializedLargeBlobArray
+    cbor_encode_uint(writer, sim->config.max_large_blob);
+    if (cred_blob) {
+        cbor_encode_uint(writer, 0x0f); // maxCredBlobLength
+        cbor_encode_uint(writer, sim->config.max_cred_blob);
+    }
+}
+
+typedef struct fido_sim_assert_request {
+    const uint8_t *rp_id;
+    size_t rp_id_len;
+    const uint8_t *client_data_hash;
+    bool large_blob_key;
+    bool cred_blob;
+} fido_sim_assert_request_t;
+
+static int fido_sim_parse_assert_extension(const cb0r_t key, const cb0r_t value, void *arg) {
+    static const char large_blob_key[] = "largeBlobKey";
+    static const char get_cred_blob[] = "getCredBlob";
+    fido_sim_assert_request_t *request = (fido_sim_assert_request_t *)arg;
+
+    if (key->type == CB0R_UTF8 && CBOR_STR_MEMCMP(key, large_blob_key)) {
+        request->large_blob_key = value->type == CB0R_TRUE;
+    } else if (key->type == CB0R_UTF8 && CBOR_STR_MEMCMP(key, get_cred_blob)) {
+        request->cred_blob = value->type == CB0R_TRUE;
+    }
+    return FIDO_OK;
+}
+
+static int fido_sim_parse_assert_request(const cb0r_t key, const cb0r_t value, void *arg) {
+    fido_sim_assert_request_t *request = (fido_sim_assert_request_t *)arg;
+
+    if (key->type != CB0R_INT) {
+        return FIDO_ERR_INVALID_CBOR;
+    }
+    switch (key->value) {
+        case 0x01: // rpId
+            if (value->type != CB0R_UTF8) {
+                return FIDO_ERR_CBOR_UNEXPECTED_TYPE;
+            }
+            request->rp_id = cb0r_value(value);
+            request->rp_id_len = cb0r_vlen(value);
+            return FIDO_OK;
+        case 0x02: // clientDataHash
+            if (value->type != CB0R_BYTE || cb0r_vlen(value) != ASSERTION_CLIENT_DATA_HASH_LEN) {
+                return FIDO_ERR_CBOR_UNEXPECTED_TYPE;
+            }
+            request->client_data_hash = cb0r_value(value);
+            return FIDO_OK;
+        case 0x04: // extensions
+            return cbor_iter_map(value, fido_sim_parse_assert_extension, request);
+        default:
+            return FIDO_OK;
+    }
+}
+
+/**
+ * @brief Sign an assertion with the credential and encode the getAssertion response.
+ *
+ * @param sim The simulator.
+ * @param request The parsed request.
+ * @param writer The writer for the response.
+ */
+static void fido_sim_get_assertion(fido_sim_t *sim, const fido_sim_assert_request_t *request, cbor_writer_t writer) {
+    static const uint8_t type_key[] = "type";
+    static const uint8_t type_value[] = "public-key";
+    static const uint8_t id_key[] = "id";
+    static const uint8_t cred_blob_key[] = "credBlob";
+    // The extensions are a map with the credBlob: map header, key and byte string header.
+    uint8_t signed_data[FIDO_SIM_AUTH_DATA_LEN + 1 + sizeof(cred_blob_key) + 2 + FIDO_SIM_MAX_CRED_BLOB_LEN + ASSERTION_CLIENT_DATA_HASH_LEN];
+    uint8_t *auth_data = signed_data;
+    size_t auth_data_len = FIDO_SIM_AUTH_DATA_LEN;
+    uint8_t signature[ASSERTION_ED25519_SIGNATURE_LENGTH];
+    uint32_t sign_count = ++sim->credential.sign_count;
+    const bool cred_blob = request->cred_blob && sim->config.max_cred_blob > 0;
+
+    fido_sha256(request->rp_id, request->rp_id_len, auth_data);
+    auth_data[ASSERTION_AUTH_DATA_RPID_HASH_LEN] = FIDO_AUTH_DATA_FLAGS_UP | (cred_blob ? FIDO_AUTH_DATA_FLAGS_ED : 0);
+    auth_data[ASSERTION_AUTH_DATA_RPID_HASH_LEN + 1] = (uint8_t)(sign_count >> 24);
+    auth_data[ASSERTION_AUTH_DATA_RPID_HASH_LEN + 2] = (uint8_t)(sign_count >> 16);
+    auth_data[ASSERTION_AUTH_DATA_RPID_HASH_LEN + 3] = (uint8_t)(sign_count >> 8);
+    auth_data[ASSERTION_AUTH_DATA_RPID_HASH_LEN + 4] = (uint8_t)sign_count;
+    if (cred_blob) {
+        // Credentials without a credBlob return an empty one.
+        cbor_writer_s extensions;
+        cbor_writer_reset(&extensions, auth_data + auth_data_len, sizeof(signed_data) - auth_data_len - ASSERTION_CLIENT_DATA_HASH_LEN);
+        cbor_encode_map_start(&extensions, 1);
+        cbor_encode_string(&extensions, cred_blob_key, sizeof(cred_blob_key) - 1);
+        cbor_encode_bytestring(&extensions, sim->credential.cred_blob, sim->credential.cred_blob_len);
+        auth_data_len += extensions.length;
+    }
+    memcpy(signed_data + auth_data_len, request->client_data_hash, ASSERTION_CLIENT_DATA_HASH_LEN);
+    crypto_ed25519_sign(signature, sim->credential.secret_key, sim->credential.public_key, signed_data, auth_data_len + ASSERTION_CLIENT_DATA_HASH_LEN);
+
+    cbor_encode_map_start(writer, request->large_blob_key ? 4 : 3);
+    cbor_encode_uint(writer, 0x01); // credential
+    cbor_encode_map_start(writer, 2);
+    cbor_encode_string(writer, type_key, sizeof(type_key) - 1);
+    cbor_encode_string(writer, type_value, sizeof(type_value) - 1);
+    cbor_encode_string(writer, id_key, sizeof(id_key) - 1);
+    cbor_encode_bytestring(writer, sim->credential.id, sizeof(sim->credential.id));
+    cbor_encode_uint(writer, 0x02); // authData
+    cbor_encode_bytestring(writer, auth_data, auth_data_len);
+    cbor_encode_uint(writer, 0x03); // signature
+    cbor_encode_bytestring(writer, signature, sizeof(signature));
+    if (request->large_blob_key) {
+        cbor_encode_uint(writer, 0x07); // largeBlobKey
+        cbor_encode_bytestring(writer, sim->credential.large_blob_key, sizeof(sim->credential.large_blob_key));
+    }
+}
+
+typedef struct fido_sim_largeblob_request {
+    bool has_get;
+    uint64_t get;
+    uint64_t offset;
+} fido_sim_largeblob_request_t;
+
+static int fido_sim_parse_largeblob_request(const cb0r_t key, const cb0r_t value, void *arg) {
+    fido_sim_largeblob_request_t *request = (fido_sim_largeblob_request_t *)arg;
+
+    if (key->type != CB0R_INT) {
+        return FIDO_ERR_INVALID_CBOR;
+    }
+    switch (key->value) {
+        case 0x01: // get
+            if (value->type != CB0R_INT) {
+                return FIDO_ERR_CBOR_UNEXPECTED_TYPE;
+            }
+            request->has_get = true;
+            request->get = value->value;
+            return FIDO_OK;
+        case 0x02: // set
+            return FIDO_ERR_UNSUPPORTED_OPTION;
+        case 0x03: // offset
+            if (value->type != CB0R_INT) {
+                return FIDO_ERR_CBOR_UNEXPECTED_TYPE;
+            }
+            request->offset = value->value;
+            return FIDO_OK;
+        default:
+            return FIDO_OK;
+    }
+}
+
+/**
+ * @brief Process a complete CTAP command and store the response.
+ *
+ * @param sim The simulator, with the command in sim->command.
+ * @return int The CTAP status of the response.
+ */
+static int fido_sim_process(fido_sim_t *sim) {
+    cbor_writer_s writer;
+    cb0r_s request;
+    int r;
+
+    sim->stats.commands++;
+    fido_sim_advance(sim, (uint64_t)sim->config.command_latency_us * 1000u);
+
+    if (sim->command_len < 1) {
+        return FIDO_ERR_INVALID_LENGTH;
+    }
+    if (sim->command_len > 1 && (!cb0r_read(sim->command + 1, sim->command_len - 1, &request) || request.type != CB0R_MAP)) {
+        return FIDO_ERR_INVALID_CBOR;
+    }
+
+    cbor_writer_reset(&writer, sim->response + 1, sizeof(sim->response) - 1);
+    switch (sim->command[0]) {
+        case CTAP_CBOR_GETINFO:
+            fido_sim_get_info(sim, &writer);
+            break;
+        case CTAP_CBOR_ASSERT: {
+            fido_sim_assert_request_t assert_request = { 0 };
+            if (sim->command_len < 2) {
+                return FIDO_ERR_MISSING_PARAMETER;
+            }
+            if ((r = cbor_iter_map(&request, fido_sim_parse_assert_request, &assert_request)) != FIDO_OK) {
+                return r;
+            }
+            if (assert_request.rp_id == NULL || assert_request.client_data_hash == NULL) {
+                return FIDO_ERR_MISSING_PARAMETER;
+            }
+            fido_sim_advance(sim, (uint64_t)sim->config.assertion_latency_us * 1000u);
+            fido_sim_get_assertion(sim, &assert_request, &writer);
+            break;
+        }
+        case CTAP_CBOR_LARGEBLOB: {
+            fido_sim_largeblob_request_t largeblob_request = { 0 };
+            if (sim->command_len < 2) {
+                return FIDO_ERR_MISSING_PARAMETER;
+            }
+            if ((r = cbor_iter_map(&request, fido_sim_parse_largeblob_request, &largeblob_request)) != FIDO_OK) {
+                return r;
+            }
+            if (!largeblob_request.has_get) {
+                return FIDO_ERR_MISSING_PARAMETER;
+            }
+            // maxFragmentLength
+            if (sim->config.max_msg_size < 64 || largeblob_request.get > sim->config.max_msg_size - 64) {
+                return FIDO_ERR_INVALID_LENGTH;
+            }
+            if (largeblob_request.offset > sim->large_blob_len) {
+                return FIDO_ERR_INVALID_PARAMETER;
+            }
+            size_t rest = sim->large_blob_len - largeblob_request.offset;
+            cbor_encode_map_start(&writer, 1);
+            cbor_encode_uint(&writer, 0x01); // config
+            cbor_encode_bytestring(
+                &writer,
+                sim->large_blob + largeblob_request.offset,
+                largeblob_request.get < rest ? largeblob_request.get : rest
+            );
+            break;
+        }
+        default:
+            return FIDO_ERR_INVALID_COMMAND;
+    }
+
+    if (!cbor_writer_is_ok(&writer)) {
+        return FIDO_ERR_REQUEST_TOO_LARGE;
+    }
+    sim->response_len = 1 + writer.length;
+    return FIDO_OK;
+}
+
+/*
+ * I/O.
+ */
+
+static void fido_sim_set_status(fido_sim_t *sim, uint16_t status) {
+    sim->status[0] = (uint8_t)(status >> 8);
+    sim->status[1] = (uint8_t)status;
+}
+
+void *fido_sim_open() {
+    fido_sim_t *sim = fido_sim_attached;
+    if (sim != NULL) {
+        sim->command_len = 0;
+        sim->response_len = 0;
+        sim->response_offset = 0;
+        sim->status_only = false;
+    }
+    return sim;
+}
+
+void fido_sim_close(void *handle) {
+}
+
+int fido_sim_read(void *handle, unsigned char *buf, const size_t len) {
+    fido_sim_t *sim = (fido_sim_t *)handle;
+    size_t n;
+
+    if (len < 2) {
+        return -1;
+    }
+
+    size_t rest = sim->response_len - sim->response_offset;
+    if (sim->status_only) {
+        sim->status_only = false;
+        memcpy(buf, sim->status, 2);
+        n = 2;
+    } else if (rest > len - 2) {
+        memcpy(buf, sim->response + sim->response_offset, len - 2);
+        sim->response_offset += len - 2;
+        rest -= len - 2;
+        buf[len - 2] = SW1_MORE_DATA;
+        buf[len - 1] = rest > 0xff ? 0xff : (uint8_t)rest;
+        n = len;
+    } else {
+        memcpy(buf, sim->response + sim->response_offset, rest);
+        sim->response_offset += rest;
+        memcpy(buf + rest, sim->status, 2);
+        n = rest + 2;
+    }
+
+    sim->stats.bytes_out += n;
+    fido_sim_transfer(sim, n);
+    return (int)n;
+}
+
+int fido_sim_write(void *handle, const unsigned char *buf, const size_t len) {
+    fido_sim_t *sim = (fido_sim_t *)handle;
+
+    if (len < 4) {
+        return -1;
+    }
+
+    sim->stats.apdus++;
+    sim->stats.bytes_in += len;
+    fido_sim_transfer(sim, len);
+
+    size_t data_len = len > 5 ? buf[4] : 0;
+    if (5 + data_len > len) {
+        data_len = 0;
+    }
+
+    fido_sim_set_status(sim, SW_NO_ERROR);
+    switch (buf[1]) {
+        case NFC_INS_GET_RESPONSE:
+            // Continue with the pending response.
+            return (int)len;
+        case NFC_INS_SELECT:
+            memcpy(sim->response, fido_sim_version, sizeof(fido_sim_version) - 1);
+            sim->response_len = sizeof(fido_sim_version) - 1;
+            sim->command_len = 0;
+            break;
+        case NFC_INS_CTAP_MSG:
+            sim->response_len = 0;
+            if (sim->command_len + data_len > sizeof(sim->command)) {
+                sim->command_len = 0;
+                fido_sim_set_status(sim, SW_WRONG_LENGTH);
+                break;
+            }
+            memcpy(sim->command + sim->command_len, buf + 5, data_len);
+            sim->command_len += data_len;
+            if (buf[0] & NFC_CLA_CHAIN) {
+                sim->status_only = true;
+                break;
+            }
+            sim->response[0] = (uint8_t)fido_sim_process(sim);
+            if (sim->response[0] != FIDO_OK) {
+                sim->response_len = 1;
+            }
+            sim->command_len = 0;
+            break;
+        default:
+            sim->response_len = 0;
+            sim->command_len = 0;
+            fido_sim_set_status(sim, SW_INS_NOT_SUPPORTED);
+            break;
+    }
+    sim->response_offset = 0;
+    return (int)len;
+}
+
+static const fido_dev_io_t fido_sim_io = {
+    .open = fido_sim_open,
+    .close = fido_sim_close,
+    .read = fido_sim_read,
+    .write = fido_sim_write
+};
+
+int fido_sim_prepare_device(fido_sim_t *sim, fido_dev_t *dev) {
+    fido_sim_attached = sim;
+    return fido_init_nfc_device(dev, &fido_sim_io);
+}
@@ -0,0 +1,182 @@
+/*
+ * Copyright (c) 2022 Felix Gohla, Konrad Hanff, Tobias Kantusch,
+ *                    Quentin Kuth, Felix Roth. All rights reserved.
+ *
+ * Use of this source code is governed by a BSD-style
+ * license that can be found in the LICENSE file.
+ */
+
+#pragma once
+
+#include <fido.h>
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stddef.h>
+
+/**
+ * Data rates of ISO 14443 in kbit/s, for fido_sim_config_t.link_kbps.
+ * FIDO_SIM_LINK_UNLIMITED disables the link model.
+ */
+#define FIDO_SIM_LINK_UNLIMITED 0
+#define FIDO_SIM_LINK_106K      106
+#define FIDO_SIM_LINK_212K      212
+#define FIDO_SIM_LINK_424K      424
+#define FIDO_SIM_LINK_848K      848
+
+// Buffer sizes of the simulated authenticator.
+#define FIDO_SIM_MAX_COMMAND_LEN  (FIDO_MAXMSG + 16)
+#define FIDO_SIM_MAX_RESPONSE_LEN 4096
+
+#define FIDO_SIM_CREDENTIAL_ID_LEN 32
+#define FIDO_SIM_KEY_SIZE          32
+#define FIDO_SIM_MAX_CRED_BLOB_LEN 96
+
+/**
+ * @brief Configuration of the simulated authenticator.
+ *        Use fido_sim_config_default to get sensible defaults.
+ */
+typedef struct fido_sim_config {
+    uint64_t max_msg_size;         // maxMsgSize reported in getInfo
+    uint64_t max_large_blob;       // maxSerializedLargeBlobArray reported in getInfo
+    uint64_t max_cred_blob;        // maxCredBlobLength reported in getInfo, 0 to not support the credBlob extension
+    uint32_t link_kbps;            // Data rate of the link, see FIDO_SIM_LINK_*
+    uint16_t frame_size;           // Maximum ISO-DEP frame size (FSC/FSD), larger APDUs are chained in multiple frames
+    uint32_t frame_latency_us;     // Turnaround time between two frames
+    uint32_t command_latency_us;   // Processing time of every CTAP command
+    uint32_t assertion_latency_us; // Additional processing time of getAssertion, e.g. for signing
+    bool real_time;                // Sleep for the modeled time instead of only advancing the virtual clock
+} fido_sim_config_t;
+
+typedef struct fido_sim_credential {
+    uint8_t id[FIDO_SIM_CREDENTIAL_ID_LEN];
+    uint8_t secret_key[FIDO_SIM_KEY_SIZE];
+    uint8_t public_key[FIDO_SIM_KEY_SIZE];
+    uint8_t large_blob_key[LARGEBLOB_KEY_SIZE];
+    uint8_t cred_blob[FIDO_SIM_MAX_CRED_BLOB_LEN];
+    size_t cred_blob_len;
+    uint32_t sign_count;
+} fido_sim_credential_t;
+
+/**
+ * @brief Counters of the traffic between the library and the simulated authenticator.
+ */
+typedef struct fido_sim_stats {
+    size_t apdus;      // Command APDUs received, including chained ones and GET RESPONSE
+    size_t frames;     // ISO-DEP frames in both directions
+    size_t bytes_in;   // Bytes received from the library
+    size_t bytes_out;  // Bytes sent to the library
+    size_t commands;   // Complete CTAP commands
+} fido_sim_stats_t;
+
+/**
+ * @brief A simulated NFC authenticator.
+ *
+ * It holds a single discoverable Ed25519 credential that signs assertions for any RP and
+ * an updater key that can sign the credential public key for the stateless RP use case.
+ * All keys are derived from a seed, so the simulation is reproducible.
+ */
+typedef struct fido_sim {
+    fido_sim_config_t config;
+    fido_sim_credential_t credential;
+    uint8_t updater_secret_key[FIDO_SIM_KEY_SIZE];
+    uint8_t updater_public_key[FIDO_SIM_KEY_SIZE];
+    uint8_t seed[FIDO_SIM_KEY_SIZE];
+
+    // The serialized large-blob array, including the trailing digest.
+    uint8_t *large_blob;
+    size_t large_blob_len;
+    size_t large_blob_max_len;
+
+    // APDU state.
+    uint8_t command[FIDO_SIM_MAX_COMMAND_LEN];
+    size_t command_len;
+    uint8_t response[FIDO_SIM_MAX_RESPONSE_LEN];
+    size_t response_len;
+    size_t response_offset;
+    uint8_t status[2];
+    bool status_only; // The next read only returns the status word, e.g. after a chained APDU.
+
+    uint64_t clock_ns; // Virtual time spent on the link and processing.
+    fido_sim_stats_t stats;
+} fido_sim_t;
+
+/**
+ * @brief Get the default configuration: the same getInfo values as the stateless RP simulator
+ *        and a link running at 106 kbit/s.
+ *
+ * @param config The configuration to fill.
+ */
+void fido_sim_config_default(fido_sim_config_t *config);
+
+/**
+ * @brief Initialize a simulated authenticator. The large-blob array is empty afterwards.
+ *
+ * @param sim The simulator to initialize.
+ * @param config The configuration, is copied.
+ * @param seed The seed to derive the keys from, or NULL for an all-zero seed.
+ * @param large_blob_buffer The buffer for the serialized large-blob array.
+ * @param large_blob_buffer_len The length of the buffer, at least 17 bytes for the empty array.
+ * @return int FIDO_OK on success.
+ */
+int fido_sim_init(fido_sim_t *sim, const fido_sim_config_t *config, const uint8_t seed[FIDO_SIM_KEY_SIZE], uint8_t *large_blob_buffer, size_t large_blob_buffer_len);
+
+/**
+ * @brief Build a large-blob array with entry_count entries of the same size.
+ *        The entry at match_index is encrypted with the large-blob key of the credential,
+ *        the others hold the same data encrypted with keys that only the simulator knows.
+ *        The data is stored uncompressed in DEFLATE stored blocks.
+ *
+ * @param sim The simulator.
+ * @param entry_count The number of entries.
+ * @param match_index The index of the entry for the credential, entry_count for none.
+ * @param data The data of the entry for the credential.
+ * @param data_len The length of data.
+ * @return int FIDO_OK on success, FIDO_ERR_BUFFER_TOO_SHORT if the array does not fit into the buffer.
+ */
+int fido_sim_set_large_blobs(fido_sim_t *sim, size_t entry_count, size_t match_index, const uint8_t *data, size_t data_len);
+
+/**
+ * @brief Set the credBlob of the credential, returned if the credBlob extension is supported and requested.
+ *
+ * @param sim The simulator.
+ * @param data The credBlob.
+ * @param data_len The length of data, at most FIDO_SIM_MAX_CRED_BLOB_LEN.
+ * @return int FIDO_OK on success, FIDO_ERR_BUFFER_TOO_SHORT if the credBlob is too long.
+ */
+int fido_sim_set_cred_blob(fido_sim_t *sim, const uint8_t *data, size_t data_len);
+
+/**
+ * @brief Create the large blob of the stateless RP example:
+ *        the credential public key followed by its signature by the updater.
+ *
+ * @param sim The simulator.
+ * @param blob The buffer for the blob.
+ */
+void fido_sim_stateless_rp_blob(const fido_sim_t *sim, uint8_t blob[FIDO_SIM_KEY_SIZE + 64]);
+
+/**
+ * @brief Prepare a device that talks to the simulated authenticator via NFC.
+ *        As the I/O functions have no context, only one simulator can be attached at a time.
+ *
+ * @param sim The simulator.
+ * @param dev The device to prepare.
+ * @return int FIDO_OK on success.
+ */
+int fido_sim_prepare_device(fido_sim_t *sim, fido_dev_t *dev);
+
+/**
+ * @brief The I/O functions of the simulated authenticator, see fido_dev_io_t.
+ *        They are also bound at link time with STATIC_IO=fido_sim.
+ */
+fido_dev_io_open_t  fido_sim_open;
+fido_dev_io_close_t fido_sim_close;
+fido_dev_io_read_t  fido_sim_read;
+fido_dev_io_write_t fido_sim_write;
+
+/**
+ * @brief Reset the virtual clock and the traffic counters.
+ *
+ * @param sim The simulator.
+ */
+void fido_sim_reset_clock(fido_sim_t *sim);
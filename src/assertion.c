@@ -21,9 +21,10 @@
  * @param assert The assertion request to encode.
  * @param buffer A pointer to the buffer to store the CBOR-encoded assertion request into.
  * @param buffer_len The length of the buffer.
+ * @param cdh_offset A pointer to store the offset of the client data hash in buffer to, may be NULL.
  * @return int A negative value (FIDO_ERR_*) when encoding failed, otherwise the length of the encoded assertion request.
  */
-static int build_get_assert_cbor(fido_assert_t *assert, uint8_t *buffer, size_t buffer_len) {
+static int build_get_assert_cbor(const fido_assert_t *assert, uint8_t *buffer, size_t buffer_len, size_t *cdh_offset) {
     cbor_writer_s writer;
     cbor_writer_reset(&writer, buffer, buffer_len);
 
@@ -32,6 +33,9 @@ static int build_get_assert_cbor(fido_assert_t *assert, uint8_t *buffer, size_t
     int ext_set_count = __builtin_popcount(assert->ext);
     int opt_set_count = __builtin_popcount(assert->opt);
 
+    if(assert->allow_cred.ptr != NULL){
+        map_elements++;
+    }
     if(ext_set_count != 0){
         map_elements++;
     }
@@ -48,12 +52,30 @@ static int build_get_assert_cbor(fido_assert_t *assert, uint8_t *buffer, size_t
     // Parameter clientDataHash (0x02)
     CBOR_ASSERT_WRITER_STATUS_OK(writer, cbor_encode_uint, 0x02);
     CBOR_ASSERT_WRITER_STATUS_OK(writer, cbor_encode_bytestring, assert->cdh, sizeof(assert->cdh));
+    if (cdh_offset != NULL) {
+        *cdh_offset = writer.length - sizeof(assert->cdh);
+    }
+
+    if(assert->allow_cred.ptr != NULL){
+        // Parameter allowList (0x03) with a single PublicKeyCredentialDescriptor.
+        const unsigned char key_id[] = "id";
+        const unsigned char key_type[] = "type";
+        const unsigned char type_public_key[] = "public-key";
+        CBOR_ASSERT_WRITER_STATUS_OK(writer, cbor_encode_uint, 0x03);
+        CBOR_ASSERT_WRITER_STATUS_OK(writer, cbor_encode_array_start, 1);
+        CBOR_ASSERT_WRITER_STATUS_OK(writer, cbor_encode_map_start, 2);
+        CBOR_ASSERT_WRITER_STATUS_OK(writer, cbor_encode_string, key_id, sizeof(key_id) - 1);
+        CBOR_ASSERT_WRITER_STATUS_OK(writer, cbor_encode_bytestring, assert->allow_cred.ptr, assert->allow_cred.len);
+        CBOR_ASSERT_WRITER_STATUS_OK(writer, cbor_encode_string, key_type, sizeof(key_type) - 1);
+        CBOR_ASSERT_WRITER_STATUS_OK(writer, cbor_encode_string, type_public_key, sizeof(type_public_key) - 1);
+    }
 
     if(ext_set_count != 0){
         // Parameter extensions (0x04)
         CBOR_ASSERT_WRITER_STATUS_OK(writer, cbor_encode_uint, 0x04);
         CBOR_ASSERT_WRITER_STATUS_OK(writer, cbor_encode_map_start, ext_set_count);
 
+#ifndef FIDO_NO_LARGEBLOB
         if(assert->ext & FIDO_ASSERT_EXTENSION_LARGE_BLOB_KEY){
             const unsigned char fido_extension_large_blob_key[] = "largeBlobKey";
             CBOR_ASSERT_WRITER_STATUS_OK(
@@ -68,6 +90,22 @@ static int build_get_assert_cbor(fido_assert_t *assert, uint8_t *buffer, size_t
                 true
             );
         }
+#endif
+        if(assert->ext & FIDO_ASSERT_EXTENSION_CRED_BLOB){
+            // The input of credBlob at getAssertion is "getCredBlob", only the output is "credBlob".
+            const unsigned char fido_extension_get_cred_blob[] = "getCredBlob";
+            CBOR_ASSERT_WRITER_STATUS_OK(
+                writer,
+                cbor_encode_string,
+                fido_extension_get_cred_blob,
+                sizeof(fido_extension_get_cred_blob) - 1
+            );
+            CBOR_ASSERT_WRITER_STATUS_OK(
+                writer,
+                cbor_encode_boolean,
+                true
+            );
+        }
     }
 
     if(opt_set_count != 0){
@@ -111,6 +149,7 @@ static int build_get_assert_cbor(fido_assert_t *assert, uint8_t *buffer, size_t
 static const uint8_t KEY_TYPE[] PROGMEM_MARKER = "type";
 static const uint8_t KEY_TYPE_PUBLIC_KEY[] PROGMEM_MARKER = "public-key";
 static const uint8_t KEY_ID[] PROGMEM_MARKER = "id";
+static const uint8_t KEY_CRED_BLOB[] PROGMEM_MARKER = "credBlob";
 
 /**
  * @brief CBOR decode the credential's data such as its type and ID.
@@ -152,16 +191,46 @@ static int cbor_assert_decode_credential(const cb0r_t key, const cb0r_t value, v
 }
 
 /**
- * @brief CBOR decode the auth data such as the RP ID hash and signature count.
+ * @brief CBOR decode an extension output of the auth data. Only credBlob is supported,
+ *        which is not copied but referenced by its offset in the raw auth data.
+ *
+ * @param key The CBOR key, the extension identifier.
+ * @param value The CBOR value, the extension output.
+ * @param arg The assert reply argument to store the parsed data to.
+ * @return int FIDO_OK if the operation was successful.
+ */
+static int cbor_assert_decode_auth_data_extension(const cb0r_t key, const cb0r_t value, void *arg) {
+    if (!cbor_utf8string_is_definite(key) || !CBOR_STR_MEMCMP(key, KEY_CRED_BLOB)) {
+        return FIDO_OK;
+    }
+
+    fido_assert_reply_t *ca = (fido_assert_reply_t*)arg;
+
+    if (!cbor_bytestring_is_definite(value)) {
+        return FIDO_ERR_CBOR_UNEXPECTED_TYPE;
+    }
+    ca->cred_blob_offset = (uint16_t)(cb0r_value(value) - ca->auth_data_raw);
+    ca->cred_blob_length = (uint16_t)cb0r_vlen(value);
+    ca->has_cred_blob = true;
+    return FIDO_OK;
+}
+
+/**
+ * @brief CBOR decode the auth data such as the RP ID hash, signature count and extensions.
  *        See https://www.w3.org/TR/webauthn-2/#authenticator-data
  *
- * @param auth_data_raw The raw auth data.
+ * @param auth_data_raw The raw auth data of ca->auth_data_length bytes.
  * @param ca The reply entry to store the parsed data to.
  * @return int FIDO_OK if the operation was successful.
  */
 static int cbor_assert_decode_auth_data_inner(void* auth_data_raw, fido_assert_reply_t *ca) {
     uint8_t* auth_data_bytes = (uint8_t*) auth_data_raw;
 
+    // rpIdHash, flags and signature count are mandatory.
+    if (ca->auth_data_length < ASSERTION_AUTH_DATA_RPID_HASH_LEN + 1 + 4) {
+        return FIDO_ERR_CBOR_UNEXPECTED_TYPE;
+    }
+
     // 32 byte rpIdHash
     memcpy(ca->auth_data.rp_id_hash, auth_data_bytes, ASSERTION_AUTH_DATA_RPID_HASH_LEN);
     auth_data_bytes += ASSERTION_AUTH_DATA_RPID_HASH_LEN;
@@ -174,9 +243,18 @@ static int cbor_assert_decode_auth_data_inner(void* auth_data_raw, fido_assert_r
     ca->auth_data.sign_count = be32toh(*((uint32_t*)auth_data_bytes));
     auth_data_bytes += 4;
 
-    // attested credential data and extension unsupported for now.
+    // Attested credential data is not part of assertions. As its length is only known
+    // after decoding the credential public key, the extensions after it are ignored.
+    if ((ca->auth_data.flags & FIDO_AUTH_DATA_FLAGS_AT) || !(ca->auth_data.flags & FIDO_AUTH_DATA_FLAGS_ED)) {
+        return FIDO_OK;
+    }
 
-    return FIDO_OK;
+    cb0r_s extensions;
+    const size_t extensions_len = ca->auth_data_length - (auth_data_bytes - (uint8_t*) auth_data_raw);
+    if (!cb0r_read(auth_data_bytes, extensions_len, &extensions) || extensions.type != CB0R_MAP) {
+        return FIDO_ERR_CBOR_UNEXPECTED_TYPE;
+    }
+    return cbor_iter_map(&extensions, cbor_assert_decode_auth_data_extension, ca);
 }
 
 /**
@@ -191,7 +269,7 @@ static int cbor_assert_decode_auth_data(const cb0r_t auth_data, fido_assert_repl
         return FIDO_ERR_CBOR_UNEXPECTED_TYPE;
     }
     size_t auth_data_len = cb0r_vlen(auth_data);
-    if(auth_data_len > sizeof(ca->auth_data)) {
+    if(auth_data_len > sizeof(ca->auth_data_raw)) {
         return FIDO_ERR_BUFFER_TOO_SHORT;
     }
     memcpy(ca->auth_data_raw, cb0r_value(auth_data), auth_data_len);
@@ -216,9 +294,11 @@ static int cbor_assert_decode_signature(const cb0r_t signature, fido_assert_repl
         return FIDO_ERR_BUFFER_TOO_SHORT;
     }
     memcpy(ca->signature, cb0r_value(signature), cb0r_vlen(signature));
+    ca->signature_length = cb0r_vlen(signature);
     return FIDO_OK;
 }
 
+#ifndef FIDO_NO_LARGEBLOB
 /**
  * @brief Decode the large blob key from the CBOR entry.
  *
@@ -238,6 +318,7 @@ static int cbor_assert_decode_large_blob_key(const cb0r_t large_blob_key, fido_a
     ca->has_large_blob_key = true;
     return FIDO_OK;
 }
+#endif
 
 /**
  * @brief Parse an entry of the authenticatorGetAssertion CBOR map.
@@ -268,14 +349,38 @@ static int parse_get_assert_reply_entry(const cb0r_t key, const cb0r_t value, vo
             return FIDO_OK;
         case 6: // userSelected --ignore for now
             return FIDO_OK;
+#ifndef FIDO_NO_LARGEBLOB
         case 7: // large blob key
             return cbor_assert_decode_large_blob_key(value, ca);
+#endif
         default: // ignore
             fido_log_debug("%s: cbor type", __func__);
             return FIDO_OK;
     }
 }
 
+/**
+ * @brief Transmit a prepared request with the client data hash of the assertion to the authenticator.
+ *
+ * @param dev The device to communicate to.
+ * @param assert The assertion request data.
+ * @param request The request prepared from assert.
+ * @return int FIDO_OK if the operation was successful.
+ */
+static int fido_dev_get_assert_tx_request(
+    fido_dev_t *dev,
+    const fido_assert_t *assert,
+    const fido_assert_request_t *request
+) {
+    // Only the client data hash changes between taps.
+    memcpy(request->buffer + request->cdh_offset, assert->cdh, sizeof(assert->cdh));
+    if (fido_tx(dev, CTAP_CMD_CBOR, request->buffer, request->len) != FIDO_OK) {
+        fido_log_debug("%s: fido_tx", __func__);
+        return FIDO_ERR_TX;
+    }
+    return FIDO_OK;
+}
+
 /**
  * @brief Transmit the request data to the authenticator.
  *
@@ -290,9 +395,13 @@ static int fido_dev_get_assert_tx(
     // We do not know the size of the command buffer, yet, as extensions can have different length.
     // So we start with a sane value and try our luck until the buffer is large enough.
 
-    // 1 byte command + 1 byte map header + maximum of 4 supported keys, 1 byte each + rpid (incl. max two bytes of cbor prefix) +
+    // 1 byte command + 1 byte map header + maximum of 5 supported keys, 1 byte each + rpid (incl. max two bytes of cbor prefix) +
     // client data hash (incl 2 bytes cbor prefix) + 9 bytes for options, 32 bytes for extensions.
-    int command_buffer_len = 1 + 1 + 4 + (assert->rp_id.len + 2) + sizeof(assert->cdh) + 9 + 32;
+    int command_buffer_len = 1 + 1 + 5 + (assert->rp_id.len + 2) + sizeof(assert->cdh) + 9 + 32;
+    if (assert->allow_cred.ptr != NULL) {
+        // array and map header + "id" + credential id (incl. max two bytes of cbor prefix) + "type" + "public-key"
+        command_buffer_len += 2 + 3 + (assert->allow_cred.len + 2) + 5 + 11;
+    }
     int cbor_len;
     int ret;
 
@@ -301,7 +410,7 @@ static int fido_dev_get_assert_tx(
         uint8_t command_buffer[command_buffer_len];
         while (
             command_buffer_len < GET_ASSERTION_MAX_COMMAND_BUFFER_LEN &&
-            (cbor_len = build_get_assert_cbor(assert, command_buffer + 1, sizeof(command_buffer) - 1)) == FIDO_ERR_BUFFER_TOO_SHORT
+            (cbor_len = build_get_assert_cbor(assert, command_buffer + 1, sizeof(command_buffer) - 1, NULL)) == FIDO_ERR_BUFFER_TOO_SHORT
         ) {
             command_buffer_len += GET_ASSERTION_COMMAND_BUFFER_LEN_INCREMENT;
         }
@@ -310,7 +419,7 @@ static int fido_dev_get_assert_tx(
     uint8_t command_buffer[command_buffer_len];
 
     command_buffer[0] = CTAP_CBOR_ASSERT;
-    if ((cbor_len = build_get_assert_cbor(assert, command_buffer + 1, sizeof(command_buffer) - 1)) <= 0) {
+    if ((cbor_len = build_get_assert_cbor(assert, command_buffer + 1, sizeof(command_buffer) - 1, NULL)) <= 0) {
         fido_log_debug("%s: cbor encode", __func__);
         ret = FIDO_ERR_INTERNAL;
         goto out;
@@ -356,12 +465,13 @@ static int fido_dev_get_assert_rx(
     }
 
     cb0r_s map;
+    FIDO_TRACE_BEGIN(FIDO_TRACE_CBOR, msglen - 1);
     if (!cb0r_read(msg + 1, msglen - 1, &map) || map.type != CB0R_MAP) {
         ret = FIDO_ERR_CBOR_UNEXPECTED_TYPE;
-        goto out;
+    } else {
+        ret = cbor_iter_map(&map, &parse_get_assert_reply_entry, reply);
     }
-
-    ret = cbor_iter_map(&map, &parse_get_assert_reply_entry, reply);
+    FIDO_TRACE_END(FIDO_TRACE_CBOR, msglen - 1);
 out:
     memset(msg, 0, dev->maxmsgsize);
     return ret;
@@ -372,17 +482,19 @@ out:
  *
  * @param dev The device to communicate to.
  * @param assert The assertion request data.
+ * @param request The request prepared from assert, or NULL to encode it now.
  * @param reply A pointer to the structure to store the parsed data to.
  * @return int 0, if the check is successful
  */
 static int fido_dev_get_assert_wait(
     fido_dev_t *dev,
     fido_assert_t *assert,
+    const fido_assert_request_t *request,
     fido_assert_reply_t *reply
 ) {
     int r;
 
-    if ((r = fido_dev_get_assert_tx(dev, assert)) != FIDO_OK ||
+    if ((r = request != NULL ? fido_dev_get_assert_tx_request(dev, assert, request) : fido_dev_get_assert_tx(dev, assert)) != FIDO_OK ||
         (r = fido_dev_get_assert_rx(dev, assert, reply)) != FIDO_OK)
         return r;
 
@@ -402,7 +514,15 @@ void fido_assert_reset(fido_assert_t *assert) {
     memset(assert, 0, sizeof(*assert));
 }
 
-int fido_dev_get_assert(fido_dev_t *dev, fido_assert_t *assert) {
+/**
+ * @brief Get an assertion from a device, see fido_dev_get_assert and fido_dev_get_assert_request.
+ *
+ * @param dev The device to read from.
+ * @param assert Options for the assertion.
+ * @param request The request prepared from assert, or NULL to encode it now.
+ * @return success or failure
+ */
+static int fido_dev_get_assert_common(fido_dev_t *dev, fido_assert_t *assert, const fido_assert_request_t *request) {
     int             r;
 
     if (assert->rp_id.ptr == NULL) {
@@ -415,27 +535,176 @@ int fido_dev_get_assert(fido_dev_t *dev, fido_assert_t *assert) {
     }
 
     if (fido_dev_is_fido(dev) == false) {
+#ifndef FIDO_NO_U2F
+        return fido_dev_u2f_authenticate(dev, assert);
+#else
         return FIDO_ERR_INVALID_ARGUMENT;
+#endif
     }
 
+#ifndef FIDO_NO_LARGEBLOB
+    // Speculatively read the large-blob array, which does not depend on the assertion,
+    // so that the large blob of the credential can be decrypted right after it.
+    // If that fails, fido_dev_largeblob_get reads the array again.
+    if (dev->largeblob_prefetch != NULL && dev->largeblob_prefetch_len == 0 &&
+        (assert->ext & FIDO_ASSERT_EXTENSION_LARGE_BLOB_KEY) && (dev->flags & FIDO_DEV_LARGE_BLOB)) {
+        if ((r = fido_dev_largeblob_prefetch(dev)) != FIDO_OK) {
+            fido_log_debug("%s: fido_dev_largeblob_prefetch: %d", __func__, r);
+        }
+    }
+#endif
+
     fido_assert_reply_reset(&assert->reply);
-    r = fido_dev_get_assert_wait(dev, assert, &assert->reply);
+    r = fido_dev_get_assert_wait(dev, assert, request, &assert->reply);
 
     return r;
 }
 
+int fido_dev_get_assert(fido_dev_t *dev, fido_assert_t *assert) {
+    return fido_dev_get_assert_common(dev, assert, NULL);
+}
+
+int fido_assert_prepare_request(fido_assert_request_t *request, const fido_assert_t *assert, uint8_t *buffer, size_t buffer_len) {
+    int cbor_len;
+    size_t cdh_offset;
+
+    if (assert->rp_id.ptr == NULL || buffer_len < 1) {
+        return FIDO_ERR_INVALID_ARGUMENT;
+    }
+
+    buffer[0] = CTAP_CBOR_ASSERT;
+    if ((cbor_len = build_get_assert_cbor(assert, buffer + 1, buffer_len - 1, &cdh_offset)) < 0) {
+        fido_log_debug("%s: cbor encode", __func__);
+        return cbor_len;
+    }
+
+    request->buffer = buffer;
+    request->len = 1 + (size_t)cbor_len;
+    request->cdh_offset = 1 + cdh_offset;
+    return FIDO_OK;
+}
+
+int fido_dev_get_assert_request(fido_dev_t *dev, fido_assert_t *assert, const fido_assert_request_t *request) {
+    return fido_dev_get_assert_common(dev, assert, request);
+}
+
 void fido_assert_set_rp(fido_assert_t *assert, const char* id) {
     const size_t len = strlen(id);
     assert->rp_id.len = len;
     assert->rp_id.ptr = (uint8_t*)id;
 }
 
+int fido_assert_set_allow_credential(fido_assert_t *assert, const uint8_t *id, const size_t id_len) {
+    if (id_len > ASSERTION_MAX_KEY_HANDLE_LENGTH) {
+        return FIDO_ERR_INVALID_ARGUMENT;
+    }
+    assert->allow_cred.len = id_len;
+    assert->allow_cred.ptr = id;
+    return FIDO_OK;
+}
+
 void fido_assert_set_client_data_hash(fido_assert_t *assert, const uint8_t hash[ASSERTION_CLIENT_DATA_HASH_LEN]) {
     memcpy(assert->cdh, hash, sizeof(assert->cdh));
 }
 
 void fido_assert_set_client_data(fido_assert_t *assert, const uint8_t *client_data, const size_t client_data_len) {
-    fido_sha256(client_data, client_data_len, assert->cdh);
+    FIDO_TRACE_BEGIN(FIDO_TRACE_HASH, client_data_len);
+    FIDO_CRYPTO_CALL(sha256)(client_data, client_data_len, assert->cdh);
+    FIDO_TRACE_END(FIDO_TRACE_HASH, client_data_len);
+}
+
+static const uint8_t CLIENT_DATA_PREFIX[] PROGMEM_MARKER = "{\"type\":\"webauthn.get\",\"challenge\":\"";
+static const uint8_t CLIENT_DATA_ORIGIN[] PROGMEM_MARKER = "\",\"origin\":\"";
+static const uint8_t CLIENT_DATA_CROSS_ORIGIN_TRUE[] PROGMEM_MARKER = "\",\"crossOrigin\":true}";
+static const uint8_t CLIENT_DATA_CROSS_ORIGIN_FALSE[] PROGMEM_MARKER = "\",\"crossOrigin\":false}";
+static const uint8_t CLIENT_DATA_BASE64URL[] PROGMEM_MARKER = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-_";
+static const uint8_t CLIENT_DATA_ESCAPE[] PROGMEM_MARKER = "\\u00";
+static const uint8_t CLIENT_DATA_HEX[] PROGMEM_MARKER = "0123456789abcdef";
+
+#define CLIENT_DATA_CHUNK_SIZE 16
+
+/**
+ * The client data serialized so far. The bytes are collected in a small chunk,
+ * so that the hash is not updated for every single byte.
+ */
+typedef struct client_data_writer {
+    fido_sha256_ctx_t hash;
+    uint8_t chunk[CLIENT_DATA_CHUNK_SIZE];
+    size_t chunk_len;
+} client_data_writer_t;
+
+static void client_data_write_byte(client_data_writer_t *writer, uint8_t byte) {
+    writer->chunk[writer->chunk_len++] = byte;
+    if (writer->chunk_len == sizeof(writer->chunk)) {
+        FIDO_CRYPTO_CALL(sha256_update)(&writer->hash, writer->chunk, writer->chunk_len);
+        writer->chunk_len = 0;
+    }
+}
+
+static void client_data_write_progmem(client_data_writer_t *writer, const uint8_t *str, size_t len) {
+    for (size_t i = 0; i < len; i++) {
+        client_data_write_byte(writer, read_progmem_byte(str + i));
+    }
+}
+
+/**
+ * @brief Serialize data as base64url without padding.
+ */
+static void client_data_write_base64url(client_data_writer_t *writer, const uint8_t *data, size_t len) {
+    for (size_t i = 0; i < len; i += 3) {
+        const size_t n = len - i < 3 ? len - i : 3;
+        const uint32_t group = (uint32_t)data[i] << 16 | (n > 1 ? (uint32_t)data[i + 1] << 8 : 0) | (n > 2 ? data[i + 2] : 0);
+        for (size_t j = 0; j <= n; j++) {
+            client_data_write_byte(writer, read_progmem_byte(CLIENT_DATA_BASE64URL + ((group >> (18 - 6 * j)) & 0x3f)));
+        }
+    }
+}
+
+/**
+ * @brief Serialize a string as the contents of a JSON string, escaping like CCDToString of WebAuthn.
+ */
+static void client_data_write_string(client_data_writer_t *writer, const char *str) {
+    for (; *str != '\0'; str++) {
+        const uint8_t c = (uint8_t) *str;
+        if (c == '"' || c == '\\') {
+            client_data_write_byte(writer, '\\');
+            client_data_write_byte(writer, c);
+        } else if (c < 0x20) {
+            client_data_write_progmem(writer, CLIENT_DATA_ESCAPE, sizeof(CLIENT_DATA_ESCAPE) - 1);
+            client_data_write_byte(writer, read_progmem_byte(CLIENT_DATA_HEX + (c >> 4)));
+            client_data_write_byte(writer, read_progmem_byte(CLIENT_DATA_HEX + (c & 0xf)));
+        } else {
+            client_data_write_byte(writer, c);
+        }
+    }
+}
+
+int fido_assert_set_client_data_json(fido_assert_t *assert, const uint8_t *challenge, const size_t challenge_len, const char *origin, const bool cross_origin) {
+    client_data_writer_t writer;
+
+    if ((challenge == NULL && challenge_len != 0) || origin == NULL) {
+        return FIDO_ERR_INVALID_ARGUMENT;
+    }
+    if (!FIDO_CRYPTO_IS_SET(sha256_stream)) {
+        return FIDO_ERR_INTERNAL;
+    }
+
+    FIDO_TRACE_BEGIN(FIDO_TRACE_HASH, challenge_len);
+    FIDO_CRYPTO_CALL(sha256_init)(&writer.hash);
+    writer.chunk_len = 0;
+    client_data_write_progmem(&writer, CLIENT_DATA_PREFIX, sizeof(CLIENT_DATA_PREFIX) - 1);
+    client_data_write_base64url(&writer, challenge, challenge_len);
+    client_data_write_progmem(&writer, CLIENT_DATA_ORIGIN, sizeof(CLIENT_DATA_ORIGIN) - 1);
+    client_data_write_string(&writer, origin);
+    if (cross_origin) {
+        client_data_write_progmem(&writer, CLIENT_DATA_CROSS_ORIGIN_TRUE, sizeof(CLIENT_DATA_CROSS_ORIGIN_TRUE) - 1);
+    } else {
+        client_data_write_progmem(&writer, CLIENT_DATA_CROSS_ORIGIN_FALSE, sizeof(CLIENT_DATA_CROSS_ORIGIN_FALSE) - 1);
+    }
+    FIDO_CRYPTO_CALL(sha256_update)(&writer.hash, writer.chunk, writer.chunk_len);
+    FIDO_CRYPTO_CALL(sha256_final)(&writer.hash, assert->cdh);
+    FIDO_TRACE_END(FIDO_TRACE_HASH, challenge_len);
+    return FIDO_OK;
 }
 
 
@@ -444,9 +713,32 @@ void fido_assert_set_options(fido_assert_t *assert, const fido_assert_opt_t opti
 }
 
 void fido_assert_set_extensions(fido_assert_t *assert, const fido_assert_ext_t extensions) {
+#ifdef FIDO_NO_LARGEBLOB
+    // The extension is not encoded, keep the size of the extension map right.
+    assert->ext = extensions & ~FIDO_ASSERT_EXTENSION_LARGE_BLOB_KEY;
+#else
     assert->ext = extensions;
+#endif
+}
+
+const uint8_t *fido_assert_cred_blob_ptr(const fido_assert_t *assert) {
+    return assert->reply.has_cred_blob ? assert->reply.auth_data_raw + assert->reply.cred_blob_offset : NULL;
+}
+
+size_t fido_assert_cred_blob_len(const fido_assert_t *assert) {
+    return assert->reply.has_cred_blob ? assert->reply.cred_blob_length : 0;
+}
+
+const uint8_t *fido_assert_id_ptr(const fido_assert_t *assert) {
+    return assert->reply.credential.id_length != 0 ? assert->reply.credential.id : assert->allow_cred.ptr;
+}
+
+size_t fido_assert_id_len(const fido_assert_t *assert) {
+    return assert->reply.credential.id_length != 0 ? assert->reply.credential.id_length : assert->allow_cred.len;
 }
 
+#ifndef FIDO_NO_ASSERT_VERIFY
+
 /**
  * @brief Check, that user presence or verification are performed successfully, when desired.
  *
@@ -481,18 +773,78 @@ static int fido_check_flags(fido_assert_auth_data_flags_t auth_data_flags, fido_
  */
 static int fido_check_rp_id(const fido_assert_blob_t *rp_id, const uint8_t *obtained_hash) {
     uint8_t expected_hash[ASSERTION_AUTH_DATA_RPID_HASH_LEN] = {0};
-    if(fido_sha256 == NULL) {
+    if(!FIDO_CRYPTO_IS_SET(sha256)) {
         return FIDO_ERR_INTERNAL;
     }
-    fido_sha256(rp_id->ptr, rp_id->len, expected_hash);
+    FIDO_TRACE_BEGIN(FIDO_TRACE_HASH, rp_id->len);
+    FIDO_CRYPTO_CALL(sha256)(rp_id->ptr, rp_id->len, expected_hash);
+    FIDO_TRACE_END(FIDO_TRACE_HASH, rp_id->len);
 
     int res = memcmp(expected_hash, obtained_hash, SHA256_BLOCK_SIZE);
     memset(expected_hash, 0, ASSERTION_AUTH_DATA_RPID_HASH_LEN);
     return res;
 }
 
+/**
+ * @brief Read a DER encoded INTEGER into a big endian number of half the raw ES256 signature length.
+ *
+ * @param der A pointer to the pointer to the DER data, advanced behind the INTEGER.
+ * @param der_len A pointer to the remaining length of the DER data, reduced accordingly.
+ * @param out The buffer to write the number to.
+ * @return int 0 if the INTEGER could be read, -1 otherwise.
+ */
+static int fido_decode_der_integer(const uint8_t **der, size_t *der_len, uint8_t out[ASSERTION_ES256_SIGNATURE_LENGTH / 2]) {
+    const size_t out_len = ASSERTION_ES256_SIGNATURE_LENGTH / 2;
+    if (*der_len < 2 || (*der)[0] != 0x02) {
+        return -1;
+    }
+    size_t len = (*der)[1];
+    const uint8_t *value = *der + 2;
+    if (len == 0 || len > *der_len - 2) {
+        return -1;
+    }
+    *der += 2 + len;
+    *der_len -= 2 + len;
+
+    // Positive INTEGERs with the highest bit set have a leading zero byte.
+    while (len > out_len && *value == 0) {
+        value++;
+        len--;
+    }
+    if (len > out_len) {
+        return -1;
+    }
+    memset(out, 0, out_len - len);
+    memcpy(out + out_len - len, value, len);
+    return 0;
+}
+
+/**
+ * @brief Convert a DER encoded ECDSA signature (SEQUENCE of the INTEGERs r and s) to r and s with 32 bytes each.
+ *
+ * @param der The DER encoded signature.
+ * @param der_len The length of the DER encoded signature.
+ * @param signature The buffer to write r and s to.
+ * @return int 0 if the signature could be converted, -1 otherwise.
+ */
+static int fido_decode_es256_signature(const uint8_t *der, size_t der_len, uint8_t signature[ASSERTION_ES256_SIGNATURE_LENGTH]) {
+    // The signature is at most 72 bytes long, so the SEQUENCE always has a short length.
+    if (der_len < 2 || der[0] != 0x30 || der[1] != der_len - 2) {
+        return -1;
+    }
+    der += 2;
+    der_len -= 2;
+
+    if (fido_decode_der_integer(&der, &der_len, signature) != 0 ||
+        fido_decode_der_integer(&der, &der_len, signature + ASSERTION_ES256_SIGNATURE_LENGTH / 2) != 0) {
+        return -1;
+    }
+    return der_len == 0 ? 0 : -1;
+}
+
 /**
  * @brief Create the data that was signed by the authenticator.
+ *        For ES256, this is the SHA256 hash of the data, as ECDSA signs the hash.
  *
  * @param cose_alg The COSE algorithm identifier.
  * @param buf A buffer to place the result in.
@@ -517,6 +869,20 @@ static int fido_get_signed_hash(
             memcpy(buf + auth_data_length, client_data_hash, ASSERTION_CLIENT_DATA_HASH_LEN);
             return auth_data_length + ASSERTION_CLIENT_DATA_HASH_LEN;
         }
+        case COSE_ALGORITHM_ES256: {
+            uint8_t pre_image[ASSERTION_PRE_IMAGE_LENGTH];
+            const size_t pre_image_length = auth_data_length + ASSERTION_CLIENT_DATA_HASH_LEN;
+            if(!FIDO_CRYPTO_IS_SET(sha256)) {
+                return -1;
+            }
+            memcpy(pre_image, auth_data, auth_data_length);
+            memcpy(pre_image + auth_data_length, client_data_hash, ASSERTION_CLIENT_DATA_HASH_LEN);
+            FIDO_TRACE_BEGIN(FIDO_TRACE_HASH, pre_image_length);
+            FIDO_CRYPTO_CALL(sha256)(pre_image, pre_image_length, buf);
+            FIDO_TRACE_END(FIDO_TRACE_HASH, pre_image_length);
+            memset(pre_image, 0, sizeof(pre_image));
+            return SHA256_DIGEST_SIZE;
+        }
         default:
             fido_log_debug(
                 "%s: unsupported cose_alg %d",
@@ -527,35 +893,28 @@ static int fido_get_signed_hash(
     }
 }
 
-int fido_assert_verify(const fido_assert_t *assert, const int cose_alg, const uint8_t *pk) {
+/**
+ * @brief Verify the signature of an assertion reply with any of the given public keys.
+ *
+ * @param reply The assertion reply.
+ * @param client_data_hash The client data hash of the request.
+ * @param cose_alg The COSE algorithm identifier.
+ * @param public_keys The consecutive public keys.
+ * @param public_key_count The number of public keys.
+ * @return int FIDO_OK if the signature is valid for one of the keys.
+ */
+static int fido_assert_verify_signature(
+    const fido_assert_reply_t *reply,
+    const uint8_t *client_data_hash,
+    const int cose_alg,
+    const uint8_t *public_keys,
+    size_t public_key_count
+) {
     int r;
     uint8_t hash_buf[ASSERTION_PRE_IMAGE_LENGTH] = { 0 }; // Authdata + Client data hash
 
-    if(pk == NULL) {
-        return FIDO_ERR_INVALID_ARGUMENT;
-    }
-
-    const fido_assert_reply_t *reply = &(assert->reply);
-
-    /* do we have everything we need? */
-    if (assert->rp_id.ptr == NULL) {
-        return FIDO_ERR_INVALID_ARGUMENT;
-    }
-
-    if (fido_check_flags(reply->auth_data.flags, assert->opt) < 0) {
-        fido_log_debug("%s: fido_check_flags", __func__);
-        return FIDO_ERR_INVALID_PARAM;
-    }
-
-    // TODO: Extensions not supported for now.
-
-    if (fido_check_rp_id(&(assert->rp_id), reply->auth_data.rp_id_hash) != 0) {
-        fido_log_debug("%s: fido_check_rp_id", __func__);
-        return FIDO_ERR_INVALID_PARAM;
-    }
-
     int hash_buf_len;
-    if ((hash_buf_len = fido_get_signed_hash(cose_alg, hash_buf, assert->cdh,
+    if ((hash_buf_len = fido_get_signed_hash(cose_alg, hash_buf, client_data_hash,
         reply->auth_data_raw, reply->auth_data_length)) < 0) {
         fido_log_debug("%s: fido_get_signed_hash", __func__);
         r =  FIDO_ERR_INTERNAL;
@@ -565,12 +924,41 @@ int fido_assert_verify(const fido_assert_t *assert, const int cose_alg, const ui
     int ok = -1;
     switch(cose_alg) {
         case COSE_ALGORITHM_EdDSA: {
-            if(fido_ed25519_verify == NULL) {
+            if(!FIDO_CRYPTO_IS_SET(ed25519_verify)) {
                 r = FIDO_ERR_INTERNAL;
                 goto out;
             }
 
-            ok = fido_ed25519_verify(reply->signature, pk, hash_buf, hash_buf_len);
+            if (reply->signature_length != ASSERTION_ED25519_SIGNATURE_LENGTH) {
+                break;
+            }
+
+            for (size_t i = 0; i < public_key_count && ok < 0; i++) {
+                const uint8_t *pk = public_keys + i * ASSERTION_ED25519_PUBLIC_KEY_LENGTH;
+                FIDO_TRACE_BEGIN(FIDO_TRACE_VERIFY, cose_alg);
+                ok = FIDO_CRYPTO_CALL(ed25519_verify)(reply->signature, pk, hash_buf, hash_buf_len) == 0 ? 0 : -1;
+                FIDO_TRACE_END(FIDO_TRACE_VERIFY, cose_alg);
+            }
+            break;
+        }
+        case COSE_ALGORITHM_ES256: {
+            if(!FIDO_CRYPTO_IS_SET(es256_verify)) {
+                r = FIDO_ERR_INTERNAL;
+                goto out;
+            }
+
+            uint8_t signature[ASSERTION_ES256_SIGNATURE_LENGTH];
+            if (fido_decode_es256_signature(reply->signature, reply->signature_length, signature) != 0) {
+                fido_log_debug("%s: fido_decode_es256_signature", __func__);
+                break;
+            }
+
+            for (size_t i = 0; i < public_key_count && ok < 0; i++) {
+                const uint8_t *pk = public_keys + i * ASSERTION_ES256_PUBLIC_KEY_LENGTH;
+                FIDO_TRACE_BEGIN(FIDO_TRACE_VERIFY, cose_alg);
+                ok = FIDO_CRYPTO_CALL(es256_verify)(signature, pk, hash_buf) == 0 ? 0 : -1;
+                FIDO_TRACE_END(FIDO_TRACE_VERIFY, cose_alg);
+            }
             break;
         }
         default:
@@ -593,3 +981,62 @@ out:
     memset(hash_buf, 0, sizeof(hash_buf));
     return r;
 }
+
+int fido_assert_verify(const fido_assert_t *assert, const int cose_alg, const uint8_t *pk) {
+    if(pk == NULL) {
+        return FIDO_ERR_INVALID_ARGUMENT;
+    }
+
+    const fido_assert_reply_t *reply = &(assert->reply);
+
+    /* do we have everything we need? */
+    if (assert->rp_id.ptr == NULL) {
+        return FIDO_ERR_INVALID_ARGUMENT;
+    }
+
+    if (fido_check_flags(reply->auth_data.flags, assert->opt) < 0) {
+        fido_log_debug("%s: fido_check_flags", __func__);
+        return FIDO_ERR_INVALID_PARAM;
+    }
+
+    // TODO: Extensions not supported for now.
+
+    if (fido_check_rp_id(&(assert->rp_id), reply->auth_data.rp_id_hash) != 0) {
+        fido_log_debug("%s: fido_check_rp_id", __func__);
+        return FIDO_ERR_INVALID_PARAM;
+    }
+
+    return fido_assert_verify_signature(reply, assert->cdh, cose_alg, pk, 1);
+}
+
+#ifndef FIDO_NO_RP_REGISTRY
+int fido_assert_verify_rp_registry(const fido_assert_t *assert, const fido_rp_registry_t *registry, const fido_rp_t **rp) {
+    const fido_assert_reply_t *reply = &(assert->reply);
+
+    if (fido_check_flags(reply->auth_data.flags, assert->opt) < 0) {
+        fido_log_debug("%s: fido_check_flags", __func__);
+        return FIDO_ERR_INVALID_PARAM;
+    }
+
+    // The rpIdHash resolves the RP, whose hash was computed when it was added.
+    const fido_rp_t *found = fido_rp_registry_find(registry, reply->auth_data.rp_id_hash);
+    if (found == NULL) {
+        fido_log_debug("%s: fido_rp_registry_find", __func__);
+        return FIDO_ERR_NOTFOUND;
+    }
+
+    // The RP the assertion was requested for must be the one the authenticator signed for.
+    if (assert->rp_id.ptr != NULL &&
+        (assert->rp_id.len != found->id_len || memcmp(assert->rp_id.ptr, found->id, found->id_len) != 0)) {
+        fido_log_debug("%s: rp_id", __func__);
+        return FIDO_ERR_INVALID_PARAM;
+    }
+
+    if (rp != NULL) {
+        *rp = found;
+    }
+    return fido_assert_verify_signature(reply, assert->cdh, found->cose_alg, found->public_keys, found->public_key_count);
+}
+#endif
+
+#endif
@@ -8,6 +8,8 @@
  */
 
 #include "fido.h"
+#include "utils.h"
+
 #include <string.h>
 
 int fido_buf_read(const unsigned char **buf, size_t *len, void *dst, size_t count) {
@@ -33,3 +35,23 @@ int fido_buf_write(unsigned char **buf, size_t *len, const void *src, size_t cou
 
     return FIDO_OK;
 }
+
+#if !defined(FIDO_NO_CRED_STORE) || !defined(FIDO_NO_REVOCATION)
+uint32_t fido_buf_read_le_progmem(const uint8_t *ptr, size_t len) {
+    uint32_t value = 0;
+    while (len-- > 0) {
+        value = value << 8 | read_progmem_byte(ptr + len);
+    }
+    return value;
+}
+
+bool fido_buf_has_magic_progmem(const uint8_t *image, const uint8_t *magic, size_t len) {
+    // Only one of the arguments of memcmp_progmem may be in program memory, so the image is compared byte by byte.
+    for (size_t i = 0; i < len; i++) {
+        if (read_progmem_byte(image + i) != read_progmem_byte(magic + i)) {
+            return false;
+        }
+    }
+    return true;
+}
+#endif
@@ -0,0 +1,108 @@
+/*
+ * Copyright (c) 2022 Felix Gohla, Konrad Hanff, Tobias Kantusch,
+ *                    Quentin Kuth, Felix Roth. All rights reserved.
+ *
+ * Use of this source code is governed by a BSD-style
+ * license that can be found in the LICENSE file.
+ */
+
+#include "fido.h"
+#include "utils.h"
+
+#include <string.h>
+
+#ifndef FIDO_NO_CRED_STORE
+
+static const uint8_t cred_store_magic[] PROGMEM_MARKER = "FCS1";
+
+int fido_cred_store_init(fido_cred_store_t *store, const uint8_t *image, size_t image_len) {
+    if (image_len < FIDO_CRED_STORE_HEADER_SIZE) {
+        return FIDO_ERR_INVALID_ARGUMENT;
+    }
+    if (!fido_buf_has_magic_progmem(image, cred_store_magic, sizeof(cred_store_magic) - 1)) {
+        fido_log_debug("%s: magic", __func__);
+        return FIDO_ERR_INVALID_ARGUMENT;
+    }
+
+    const size_t slot_count = fido_buf_read_le_progmem(image + 4, 4);
+    const size_t record_count = fido_buf_read_le_progmem(image + 8, 4);
+    const size_t metadata_size = fido_buf_read_le_progmem(image + 12, 4);
+    const size_t available = image_len - FIDO_CRED_STORE_HEADER_SIZE;
+
+    // At least one slot stays empty, so that lookups of unknown credentials terminate.
+    if (slot_count == 0 || (slot_count & (slot_count - 1)) != 0 || record_count >= slot_count || record_count > UINT16_MAX ||
+        slot_count > available / FIDO_CRED_STORE_SLOT_SIZE || metadata_size > available) {
+        fido_log_debug("%s: sizes", __func__);
+        return FIDO_ERR_INVALID_ARGUMENT;
+    }
+    const size_t record_size = FIDO_CRED_STORE_RECORD_SIZE(metadata_size);
+    if (record_count > (available - slot_count * FIDO_CRED_STORE_SLOT_SIZE) / record_size) {
+        fido_log_debug("%s: image_len", __func__);
+        return FIDO_ERR_INVALID_ARGUMENT;
+    }
+
+    store->slots = image + FIDO_CRED_STORE_HEADER_SIZE;
+    store->records = store->slots + slot_count * FIDO_CRED_STORE_SLOT_SIZE;
+    store->slot_mask = slot_count - 1;
+    store->record_count = record_count;
+    store->metadata_size = metadata_size;
+    return FIDO_OK;
+}
+
+int fido_cred_store_find(const fido_cred_store_t *store, const uint8_t *id, size_t id_len, fido_cred_store_entry_t *entry) {
+    uint8_t hash[SHA256_DIGEST_SIZE];
+
+    if (!FIDO_CRYPTO_IS_SET(sha256)) {
+        return FIDO_ERR_INTERNAL;
+    }
+    FIDO_TRACE_BEGIN(FIDO_TRACE_HASH, id_len);
+    FIDO_CRYPTO_CALL(sha256)(id, id_len, hash);
+    FIDO_TRACE_END(FIDO_TRACE_HASH, id_len);
+
+    const size_t record_size = FIDO_CRED_STORE_RECORD_SIZE(store->metadata_size);
+    size_t slot = ((uint32_t)hash[0] | (uint32_t)hash[1] << 8 | (uint32_t)hash[2] << 16 | (uint32_t)hash[3] << 24) & store->slot_mask;
+    // A valid image has an empty slot, which ends the probing. A malformed one may not, so every slot is probed at most once.
+    for (size_t probes = 0; probes <= store->slot_mask; probes++) {
+        const size_t index = fido_buf_read_le_progmem(store->slots + slot * FIDO_CRED_STORE_SLOT_SIZE, FIDO_CRED_STORE_SLOT_SIZE);
+        if (index == 0) {
+            break;
+        }
+        const uint8_t *record = store->records + (index - 1) * record_size;
+        if (index <= store->record_count && memcmp_progmem(hash, record, FIDO_CRED_STORE_ID_HASH_SIZE) == 0) {
+            const uint8_t *public_key = record + FIDO_CRED_STORE_ID_HASH_SIZE + 4;
+            entry->cose_alg = (int16_t)fido_buf_read_le_progmem(record + FIDO_CRED_STORE_ID_HASH_SIZE, 2);
+            for (size_t i = 0; i < FIDO_CRED_STORE_PUBLIC_KEY_SIZE; i++) {
+                entry->public_key[i] = read_progmem_byte(public_key + i);
+            }
+            entry->metadata = public_key + FIDO_CRED_STORE_PUBLIC_KEY_SIZE;
+            entry->metadata_len = store->metadata_size;
+            return FIDO_OK;
+        }
+        slot = (slot + 1) & store->slot_mask;
+    }
+    return FIDO_ERR_NOTFOUND;
+}
+
+#ifndef FIDO_NO_ASSERT_VERIFY
+int fido_assert_verify_cred_store(const fido_assert_t *assert, const fido_cred_store_t *store, fido_cred_store_entry_t *entry) {
+    fido_cred_store_entry_t found;
+    int r;
+
+    const uint8_t *id = fido_assert_id_ptr(assert);
+    const size_t id_len = fido_assert_id_len(assert);
+    if (id == NULL || id_len == 0) {
+        return FIDO_ERR_INVALID_ARGUMENT;
+    }
+
+    if ((r = fido_cred_store_find(store, id, id_len, &found)) != FIDO_OK) {
+        fido_log_debug("%s: fido_cred_store_find", __func__);
+        return r;
+    }
+    if (entry != NULL) {
+        *entry = found;
+    }
+    return fido_assert_verify(assert, found.cose_alg, found.public_key);
+}
+#endif
+
+#endif
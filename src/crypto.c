@@ -9,50 +9,189 @@
 #include <aes_gcm.h>
 #include <sha256.h>
 #include <monocypher-ed25519.h>
+#include <p256.h>
 
 #include "crypto.h"
 
-#if defined(NO_SOFTWARE_CRYPTO_AES_GCM_ENCRYPT)
+#ifdef FIDO_CRYPTO_BACKEND
+#include FIDO_CRYPTO_BACKEND
+#endif
+
+#if defined(FIDO_CRYPTO_AES_GCM_ENCRYPT)
+fido_aes_gcm_encrypt_t fido_aes_gcm_encrypt = &FIDO_CRYPTO_AES_GCM_ENCRYPT;
+#elif defined(NO_SOFTWARE_CRYPTO_AES_GCM_ENCRYPT)
 fido_aes_gcm_encrypt_t fido_aes_gcm_encrypt = NULL;
 #else
 fido_aes_gcm_encrypt_t fido_aes_gcm_encrypt = &aes_gcm_ae;
 #endif
 
-#if defined(NO_SOFTWARE_CRYPTO_AES_GCM_DECRYPT)
+#if defined(FIDO_CRYPTO_AES_GCM_DECRYPT)
+fido_aes_gcm_decrypt_t fido_aes_gcm_decrypt = &FIDO_CRYPTO_AES_GCM_DECRYPT;
+#elif defined(NO_SOFTWARE_CRYPTO_AES_GCM_DECRYPT)
 fido_aes_gcm_decrypt_t fido_aes_gcm_decrypt = NULL;
 #else
 fido_aes_gcm_decrypt_t fido_aes_gcm_decrypt = &aes_gcm_ad;
 #endif
 
-#if defined(NO_SOFTWARE_CRYPTO_ED25519_SIGN)
-fido_ed25519_sign_t fido_ed25519_sign = NULL;
-#else
+#if !defined(NO_SOFTWARE_CRYPTO_ED25519_SIGN)
 void crypto_ed25519_sign_wrapper(uint8_t *signature,
                                  const uint8_t *secret_key,
                                  const uint8_t *message, size_t message_len) {
     crypto_ed25519_sign(signature, secret_key, NULL, message, (int) message_len);
 }
+#endif
+
+#if defined(FIDO_CRYPTO_ED25519_SIGN)
+fido_ed25519_sign_t fido_ed25519_sign = &FIDO_CRYPTO_ED25519_SIGN;
+#elif defined(NO_SOFTWARE_CRYPTO_ED25519_SIGN)
+fido_ed25519_sign_t fido_ed25519_sign = NULL;
+#else
 fido_ed25519_sign_t fido_ed25519_sign = &crypto_ed25519_sign_wrapper;
 #endif
 
-#if defined(NO_SOFTWARE_CRYPTO_ED25519_VERIFY)
+#if !defined(NO_SOFTWARE_CRYPTO_ED25519_VERIFY)
+/**
+ * The context of a signature check of Monocypher with the SHA512 of fido_sha512_{init|update|final}.
+ * Monocypher passes the whole context to the hash functions, the state of the hash follows its own.
+ */
+typedef struct ed25519_check_ctx {
+    crypto_check_ctx_abstract check;
+    fido_sha512_ctx_t hash;
+} ed25519_check_ctx_t;
+
+// Only used by Monocypher for signing.
+static void ed25519_check_hash(uint8_t hash[64], const uint8_t *message, size_t message_size) {
+    fido_sha512(message, message_size, hash);
+}
+
+static void ed25519_check_hash_init(void *ctx) {
+    fido_sha512_init(&((ed25519_check_ctx_t *) ctx)->hash);
+}
+
+static void ed25519_check_hash_update(void *ctx, const uint8_t *message, size_t message_size) {
+    fido_sha512_update(&((ed25519_check_ctx_t *) ctx)->hash, message, message_size);
+}
+
+static void ed25519_check_hash_final(void *ctx, uint8_t hash[64]) {
+    fido_sha512_final(&((ed25519_check_ctx_t *) ctx)->hash, hash);
+}
+
+static const crypto_sign_vtable ed25519_check_vtable = {
+    ed25519_check_hash,
+    ed25519_check_hash_init,
+    ed25519_check_hash_update,
+    ed25519_check_hash_final,
+    sizeof(ed25519_check_ctx_t),
+};
+
+int crypto_ed25519_check_wrapper(const uint8_t *signature,
+                                 const uint8_t *public_key,
+                                 const uint8_t *message, size_t message_len) {
+    // The functions are called through their pointers, which a crypto backend binds as well.
+    if (fido_sha512_init == NULL || fido_sha512_update == NULL || fido_sha512_final == NULL) {
+        return crypto_ed25519_check(signature, public_key, message, message_len);
+    }
+
+    ed25519_check_ctx_t ctx;
+    crypto_check_init_custom_hash(&ctx.check, signature, public_key, &ed25519_check_vtable);
+    crypto_check_update(&ctx.check, message, message_len);
+    return crypto_check_final(&ctx.check);
+}
+#endif
+
+#if defined(FIDO_CRYPTO_ED25519_VERIFY)
+fido_ed25519_verify_t fido_ed25519_verify = &FIDO_CRYPTO_ED25519_VERIFY;
+#elif defined(NO_SOFTWARE_CRYPTO_ED25519_VERIFY)
 fido_ed25519_verify_t fido_ed25519_verify = NULL;
 #else
-fido_ed25519_verify_t fido_ed25519_verify = &crypto_ed25519_check;
+fido_ed25519_verify_t fido_ed25519_verify = &crypto_ed25519_check_wrapper;
+#endif
+
+#if defined(FIDO_CRYPTO_ES256_VERIFY)
+fido_es256_verify_t fido_es256_verify = &FIDO_CRYPTO_ES256_VERIFY;
+#elif defined(NO_SOFTWARE_CRYPTO_ES256_VERIFY)
+fido_es256_verify_t fido_es256_verify = NULL;
+#else
+fido_es256_verify_t fido_es256_verify = &p256_ecdsa_verify;
 #endif
 
-#if defined(NO_SOFTWARE_CRYPTO_SHA256)
+#if defined(FIDO_CRYPTO_SHA256)
+fido_sha256_t fido_sha256 = &FIDO_CRYPTO_SHA256;
+#elif defined(NO_SOFTWARE_CRYPTO_SHA256)
 fido_sha256_t fido_sha256 = NULL;
 #else
 fido_sha256_t fido_sha256 = &sha256;
 #endif
 
-#if defined(NO_SOFTWARE_CRYPTO_SHA512)
-fido_sha512_t fido_sha512 = NULL;
+#if !defined(NO_SOFTWARE_CRYPTO_SHA256)
+_Static_assert(sizeof(SHA256_CTX) <= sizeof(fido_sha256_ctx_t), "FIDO_SHA256_CTX_SIZE is too small for the software SHA256");
+
+void sha256_init_wrapper(fido_sha256_ctx_t *ctx) {
+    sha256_init((SHA256_CTX *) ctx->state);
+}
+
+void sha256_update_wrapper(fido_sha256_ctx_t *ctx, const uint8_t *data, size_t data_len) {
+    sha256_update((SHA256_CTX *) ctx->state, data, data_len);
+}
+
+void sha256_final_wrapper(fido_sha256_ctx_t *ctx, uint8_t *hash) {
+    sha256_final((SHA256_CTX *) ctx->state, hash);
+}
+#endif
+
+#if defined(FIDO_CRYPTO_SHA256_INIT) && defined(FIDO_CRYPTO_SHA256_UPDATE) && defined(FIDO_CRYPTO_SHA256_FINAL)
+fido_sha256_init_t fido_sha256_init = &FIDO_CRYPTO_SHA256_INIT;
+fido_sha256_update_t fido_sha256_update = &FIDO_CRYPTO_SHA256_UPDATE;
+fido_sha256_final_t fido_sha256_final = &FIDO_CRYPTO_SHA256_FINAL;
+#elif defined(NO_SOFTWARE_CRYPTO_SHA256)
+fido_sha256_init_t fido_sha256_init = NULL;
+fido_sha256_update_t fido_sha256_update = NULL;
+fido_sha256_final_t fido_sha256_final = NULL;
 #else
+fido_sha256_init_t fido_sha256_init = &sha256_init_wrapper;
+fido_sha256_update_t fido_sha256_update = &sha256_update_wrapper;
+fido_sha256_final_t fido_sha256_final = &sha256_final_wrapper;
+#endif
+
+#if !defined(NO_SOFTWARE_CRYPTO_SHA512)
 void crypto_sha512_wrapper(const uint8_t *data, size_t data_len,
                            uint8_t *hash) {
     crypto_sha512(hash, data, (int) data_len);
 }
+
+_Static_assert(sizeof(crypto_sha512_ctx) <= sizeof(fido_sha512_ctx_t), "FIDO_SHA512_CTX_SIZE is too small for Monocypher");
+
+void crypto_sha512_init_wrapper(fido_sha512_ctx_t *ctx) {
+    crypto_sha512_init((crypto_sha512_ctx *) ctx->state);
+}
+
+void crypto_sha512_update_wrapper(fido_sha512_ctx_t *ctx, const uint8_t *data, size_t data_len) {
+    crypto_sha512_update((crypto_sha512_ctx *) ctx->state, data, data_len);
+}
+
+void crypto_sha512_final_wrapper(fido_sha512_ctx_t *ctx, uint8_t *hash) {
+    crypto_sha512_final((crypto_sha512_ctx *) ctx->state, hash);
+}
+#endif
+
+#if defined(FIDO_CRYPTO_SHA512)
+fido_sha512_t fido_sha512 = &FIDO_CRYPTO_SHA512;
+#elif defined(NO_SOFTWARE_CRYPTO_SHA512)
+fido_sha512_t fido_sha512 = NULL;
+#else
 fido_sha512_t fido_sha512 = &crypto_sha512_wrapper;
 #endif
+
+#if defined(FIDO_CRYPTO_SHA512_INIT) && defined(FIDO_CRYPTO_SHA512_UPDATE) && defined(FIDO_CRYPTO_SHA512_FINAL)
+fido_sha512_init_t fido_sha512_init = &FIDO_CRYPTO_SHA512_INIT;
+fido_sha512_update_t fido_sha512_update = &FIDO_CRYPTO_SHA512_UPDATE;
+fido_sha512_final_t fido_sha512_final = &FIDO_CRYPTO_SHA512_FINAL;
+#elif defined(NO_SOFTWARE_CRYPTO_SHA512)
+fido_sha512_init_t fido_sha512_init = NULL;
+fido_sha512_update_t fido_sha512_update = NULL;
+fido_sha512_final_t fido_sha512_final = NULL;
+#else
+fido_sha512_init_t fido_sha512_init = &crypto_sha512_init_wrapper;
+fido_sha512_update_t fido_sha512_update = &crypto_sha512_update_wrapper;
+fido_sha512_final_t fido_sha512_final = &crypto_sha512_final_wrapper;
+#endif
@@ -27,6 +27,9 @@ static void fido_dev_set_extension_flags(fido_dev_t *dev, const fido_cbor_info_t
     if (info->extensions & FIDO_EXTENSION_LARGE_BLOB_KEY) {
         dev->flags |= FIDO_DEV_LARGE_BLOB_KEY;
     }
+    if (info->extensions & FIDO_EXTENSION_CRED_BLOB) {
+        dev->flags |= FIDO_DEV_CRED_BLOB;
+    }
 }
 
 /**
@@ -91,6 +94,23 @@ void fido_dev_init(fido_dev_t *dev) {
     dev->flags = 0;
     dev->maxmsgsize = FIDO_MAXMSG;
     dev->maxlargeblob = 0;
+    dev->maxcredbloblen = 0;
+    dev->inflate_tables = NULL;
+#ifndef FIDO_NO_VERIFY_CACHE
+    dev->verify_cache = NULL;
+#endif
+#ifndef FIDO_NO_REVOCATION
+    dev->revocation = NULL;
+#endif
+#ifndef FIDO_NO_LARGEBLOB
+    dev->largeblob_prefetch = NULL;
+    dev->largeblob_prefetch_size = 0;
+    dev->largeblob_prefetch_len = 0;
+#endif
+#ifndef FIDO_NO_DEV_STATS
+    dev->stats_clock = NULL;
+    fido_dev_reset_stats(dev);
+#endif
 
     memset(&(dev->io),        0, sizeof(fido_dev_io_t));
     memset(&(dev->attr),      0, sizeof(fido_ctap_info_t));
@@ -106,11 +126,49 @@ void fido_dev_set_transport(fido_dev_t *dev, const fido_dev_transport_t *transpo
     dev->transport = *transport;
 }
 
+void fido_dev_set_inflate_tables(fido_dev_t *dev, fido_inflate_tables_t *tables) {
+    dev->inflate_tables = tables;
+}
+
+#ifndef FIDO_NO_DEV_STATS
+void fido_dev_set_stats_clock(fido_dev_t *dev, fido_dev_clock_t clock) {
+    dev->stats_clock = clock;
+}
+
+void fido_dev_get_stats(const fido_dev_t *dev, fido_dev_stats_t *stats) {
+    *stats = dev->stats;
+}
+
+void fido_dev_reset_stats(fido_dev_t *dev) {
+    memset(&(dev->stats), 0, sizeof(fido_dev_stats_t));
+}
+
+uint64_t fido_dev_stats_now(const fido_dev_t *d) {
+    return d != NULL && d->stats_clock != NULL ? d->stats_clock() : 0;
+}
+
+void fido_dev_stats_add_time(fido_dev_t *d, fido_dev_stats_phase_t phase, uint64_t start) {
+    if (d != NULL && d->stats_clock != NULL) {
+        d->stats.time_us[phase] += d->stats_clock() - start;
+    }
+}
+#endif
+
+#ifndef FIDO_NO_U2F
+void fido_dev_force_u2f(fido_dev_t *dev) {
+    dev->flags |= FIDO_DEV_FORCE_U2F;
+}
+#endif
+
 bool fido_dev_is_fido(fido_dev_t *dev) {
     // TODO: Check whether this is standard conform.
     return dev->attr.flags & FIDO_CAP_CBOR;
 }
 
+bool fido_dev_supports_cred_blob(const fido_dev_t *dev, size_t len) {
+    return (dev->flags & FIDO_DEV_CRED_BLOB) && dev->maxcredbloblen >= len;
+}
+
 /**
  * @brief Open a FIDO device sending an initialization command.
  *
@@ -126,7 +184,7 @@ static int fido_dev_open_tx(fido_dev_t *dev) {
         return FIDO_ERR_INVALID_ARGUMENT;
     }*/
 
-    if (dev->io.open == NULL || dev->io.close == NULL) {
+    if (!FIDO_IO_IS_SET(dev, open) || !FIDO_IO_IS_SET(dev, close)) {
         fido_log_debug("%s: NULL open/close", __func__);
         return FIDO_ERR_INVALID_ARGUMENT;
     }
@@ -141,7 +199,7 @@ static int fido_dev_open_tx(fido_dev_t *dev) {
         return FIDO_ERR_INTERNAL;
     }
 
-    if ((dev->io_handle = dev->io.open()) == NULL) {
+    if ((dev->io_handle = FIDO_IO_OPEN(dev)) == NULL) {
         fido_log_debug("%s: dev->io.open", __func__);
         return FIDO_ERR_INTERNAL;
     }
@@ -154,7 +212,7 @@ static int fido_dev_open_tx(fido_dev_t *dev) {
 
     return FIDO_OK;
 fail:
-    dev->io.close(dev->io_handle);
+    FIDO_IO_CLOSE(dev);
     dev->io_handle = NULL;
 
     return r;
@@ -185,25 +243,46 @@ static int fido_dev_open_rx(fido_dev_t *dev) {
         goto fail;
     }
 
+#ifndef FIDO_NO_U2F
+    if (fido_dev_is_fido(dev) && (dev->flags & FIDO_DEV_FORCE_U2F)) {
+        if (dev->attr.flags & FIDO_CAP_NMSG) {
+            fido_log_debug("%s: device without U2F", __func__);
+            r = FIDO_ERR_INVALID_ARGUMENT;
+            goto fail;
+        }
+        dev->attr.flags &= ~FIDO_CAP_CBOR;
+    }
+#endif
+
     if (fido_dev_is_fido(dev)) {
         fido_cbor_info_reset(&info);
         if ((r = fido_dev_get_cbor_info_wait(dev, &info)) != FIDO_OK) {
             fido_log_debug("%s: fido_dev_cbor_info_wait: %d", __func__, r);
+#ifndef FIDO_NO_U2F
+            if (dev->attr.flags & FIDO_CAP_NMSG) {
+                // This device does not support U2F to fall back to, error out.
+                goto fail;
+            }
+            // A U2F device without CTAP2, use it with U2F.
+            dev->attr.flags &= ~FIDO_CAP_CBOR;
+#else
             // This device does not support FIDO2, error out.
             goto fail;
+#endif
         } else {
             fido_dev_set_flags(dev, &info);
             dev->maxmsgsize = info.maxmsgsize < FIDO_MAXMSG ? info.maxmsgsize : FIDO_MAXMSG;
             fido_log_debug("%s: FIDO_MAXMSG=%d, maxmsgsize=%lu", __func__,
                 FIDO_MAXMSG, (unsigned long)dev->maxmsgsize);
             dev->maxlargeblob = info.maxlargeblob;
+            dev->maxcredbloblen = info.maxcredbloblen;
         }
     }
 
     r = FIDO_OK;
 fail:
     if (r != FIDO_OK) {
-        dev->io.close(dev->io_handle);
+        FIDO_IO_CLOSE(dev);
         dev->io_handle = NULL;
     }
 
@@ -213,6 +292,10 @@ fail:
 int fido_dev_open(fido_dev_t *dev) {
     int r;
 
+#ifndef FIDO_NO_LARGEBLOB
+    // A large-blob array prefetched in an earlier session may be outdated.
+    dev->largeblob_prefetch_len = 0;
+#endif
     if (
         (r = fido_dev_open_tx(dev)) != FIDO_OK ||
         (r = fido_dev_open_rx(dev)) != FIDO_OK
@@ -224,12 +307,15 @@ int fido_dev_open(fido_dev_t *dev) {
 }
 
 int fido_dev_close(fido_dev_t * dev) {
-    if (dev->io.close == NULL) {
+    if (!FIDO_IO_IS_SET(dev, close)) {
         fido_log_debug("%s: device without close function", __func__);
         return FIDO_ERR_INVALID_ARGUMENT;
     }
-    dev->io.close(dev->io_handle);
+    FIDO_IO_CLOSE(dev);
     dev->io_handle = NULL;
+#ifndef FIDO_NO_LARGEBLOB
+    dev->largeblob_prefetch_len = 0;
+#endif
 
     return FIDO_OK;
 }
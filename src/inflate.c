@@ -0,0 +1,712 @@
+/*
+ * Copyright (c) 2022 Felix Gohla, Konrad Hanff, Tobias Kantusch,
+ *                    Quentin Kuth, Felix Roth. All rights reserved.
+ *
+ * Use of this source code is governed by a BSD-style
+ * license that can be found in the LICENSE file.
+ */
+
+#include "inflate.h"
+#include "inflate_tables.h"
+#include "error.h"
+#include "utils.h"
+#include <stdbool.h>
+#include <string.h>
+
+#define INFLATE_MAX_BITS          FIDO_INFLATE_MAX_BITS
+#define INFLATE_NUM_LITLEN_CODES  FIDO_INFLATE_NUM_LITLEN_CODES
+#define INFLATE_NUM_DIST_CODES    FIDO_INFLATE_NUM_DIST_CODES
+#define INFLATE_NUM_CODELEN_CODES 19
+
+#define INFLATE_BLOCK_STORED  0
+#define INFLATE_BLOCK_FIXED   1
+#define INFLATE_BLOCK_DYNAMIC 2
+
+#define INFLATE_END_OF_BLOCK 256
+
+#ifdef FIDO_FAST_INFLATE
+// Number of bits resolved by the first table lookup, as in zlib.
+#define INFLATE_LITLEN_ROOT_BITS 9
+#define INFLATE_DIST_ROOT_BITS   6
+
+#define INFLATE_LITLEN_TABLE_SIZE FIDO_INFLATE_LITLEN_TABLE_SIZE
+#define INFLATE_DIST_TABLE_SIZE   FIDO_INFLATE_DIST_TABLE_SIZE
+
+/**
+ * Table entries are 16 bits wide:
+ * - bits 0..3: number of bits of the code, relative to the root bits for second level tables,
+ *              or the number of index bits of the second level table for links
+ * - bits 4..5: type of the entry
+ * - bits 6..15: the symbol or the offset of the second level table
+ */
+#define INFLATE_ENTRY_SYMBOL  0
+#define INFLATE_ENTRY_LINK    1
+#define INFLATE_ENTRY_INVALID 2
+
+#define INFLATE_ENTRY(type, bits, value) ((uint16_t) (((value) << 6) | ((type) << 4) | (bits)))
+#define INFLATE_ENTRY_BITS(entry)        ((entry) & 0x0f)
+#define INFLATE_ENTRY_TYPE(entry)        (((entry) >> 4) & 0x03)
+#define INFLATE_ENTRY_VALUE(entry)       ((entry) >> 6)
+#endif
+
+// Base values and extra bits of the length codes 257..285.
+static const uint16_t inflate_length_base[] PROGMEM_MARKER = {
+    3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+    35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258
+};
+static const uint8_t inflate_length_extra[] PROGMEM_MARKER = {
+    0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+    3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0
+};
+
+// Base values and extra bits of the distance codes 0..29.
+static const uint16_t inflate_dist_base[] PROGMEM_MARKER = {
+    1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+    257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577
+};
+static const uint8_t inflate_dist_extra[] PROGMEM_MARKER = {
+    0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6,
+    7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13
+};
+
+// Order in which the code length code lengths are stored in a dynamic block header.
+static const uint8_t inflate_codelen_order[INFLATE_NUM_CODELEN_CODES] PROGMEM_MARKER = {
+    16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15
+};
+
+/**
+ * Read an element of a decoding structure, which is in flash for the fixed codes.
+ */
+#define inflate_read(progmem, ptr) ((progmem) ? read_progmem_word(ptr) : *(ptr))
+
+/**
+ * @brief A canonical Huffman code, stored as the number of codes per length and the symbols ordered by code.
+ */
+typedef struct inflate_huffman {
+    const uint16_t *counts;
+    const uint16_t *symbols;
+    bool progmem;
+} inflate_huffman_t;
+
+#ifdef FIDO_FAST_INFLATE
+/**
+ * @brief A Huffman code as a two level lookup table, indexed by the next bits of the input.
+ */
+typedef struct inflate_table {
+    const uint16_t *entries;
+    uint8_t root_bits;
+    bool progmem;
+} inflate_table_t;
+
+typedef inflate_table_t inflate_code_t;
+#else
+typedef inflate_huffman_t inflate_code_t;
+#endif
+
+void fido_inflate_init(fido_inflate_t *inflate, uint8_t *window, size_t window_len, fido_inflate_output_t output, void *output_ctx) {
+    memset(inflate, 0, sizeof(*inflate));
+    inflate->window = window;
+    inflate->window_len = window_len;
+    inflate->output = output;
+    inflate->output_ctx = output_ctx;
+}
+
+void fido_inflate_set_tables(fido_inflate_t *inflate, fido_inflate_tables_t *tables) {
+    inflate->tables = tables;
+}
+
+/**
+ * @brief Read bits from the input, least significant bit first.
+ *
+ * @param inflate The inflate state.
+ * @param count The number of bits to read, at most 16.
+ * @return int32_t The bits, or -1 if the input ended.
+ */
+static int32_t inflate_bits(fido_inflate_t *inflate, uint8_t count) {
+    while (inflate->bit_count < count) {
+        if (inflate->in_pos >= inflate->in_len) {
+            return -1;
+        }
+        inflate->bit_buffer |= (fido_inflate_bit_buffer_t) inflate->in[inflate->in_pos++] << inflate->bit_count;
+        inflate->bit_count += 8;
+    }
+    uint32_t bits = inflate->bit_buffer & ((1UL << count) - 1);
+    inflate->bit_buffer >>= count;
+    inflate->bit_count -= count;
+    return (int32_t) bits;
+}
+
+/**
+ * @brief Return the whole bytes in the bit buffer to the input and drop the remaining bits,
+ *        so that reading continues at the next byte boundary.
+ *
+ * @param inflate The inflate state.
+ */
+static void inflate_align(fido_inflate_t *inflate) {
+    inflate->in_pos -= inflate->bit_count / 8;
+    inflate->bit_buffer = 0;
+    inflate->bit_count = 0;
+}
+
+/**
+ * @brief Pass the data in the window that was not passed yet to the output callback.
+ *
+ * @param inflate The inflate state.
+ * @return int FIDO_OK or the error of the callback.
+ */
+static int inflate_flush(fido_inflate_t *inflate) {
+    int r = FIDO_OK;
+    if (inflate->output != NULL && inflate->window_pos > inflate->flushed) {
+        r = inflate->output(inflate->window + inflate->flushed, inflate->window_pos - inflate->flushed, inflate->output_ctx);
+    }
+    inflate->flushed = inflate->window_pos;
+    return r;
+}
+
+/**
+ * @brief Append a byte to the output, flushing and wrapping the window if it is full.
+ *
+ * @param inflate The inflate state.
+ * @param byte The byte to append.
+ * @return int FIDO_OK if the operation was successful.
+ */
+static int inflate_put(fido_inflate_t *inflate, uint8_t byte) {
+    if (inflate->window_pos == inflate->window_len) {
+        if (inflate->output == NULL) {
+            return FIDO_ERR_BUFFER_TOO_SHORT;
+        }
+        int r;
+        if ((r = inflate_flush(inflate)) != FIDO_OK) {
+            return r;
+        }
+        inflate->window_pos = 0;
+        inflate->flushed = 0;
+    }
+    inflate->window[inflate->window_pos++] = byte;
+    inflate->total_out++;
+    return FIDO_OK;
+}
+
+/**
+ * @brief Build a canonical Huffman code from the code lengths of its symbols.
+ *
+ * @param huffman The code to build.
+ * @param counts Buffer for the number of codes per length, must hold INFLATE_MAX_BITS + 1 entries.
+ * @param symbols Buffer for the symbols ordered by code, must hold symbol_count entries.
+ * @param lengths The code length of each symbol, 0 if the symbol is not used.
+ * @param symbol_count The number of symbols.
+ * @return int FIDO_OK if the lengths describe a valid code.
+ */
+static int inflate_build_huffman(inflate_huffman_t *huffman, uint16_t *counts, uint16_t *symbols, const uint8_t *lengths, uint16_t symbol_count) {
+    uint16_t offsets[INFLATE_MAX_BITS + 1];
+
+    huffman->counts = counts;
+    huffman->symbols = symbols;
+    huffman->progmem = false;
+
+    memset(counts, 0, (INFLATE_MAX_BITS + 1) * sizeof(uint16_t));
+    for (uint16_t symbol = 0; symbol < symbol_count; symbol++) {
+        counts[lengths[symbol]]++;
+    }
+    counts[0] = 0;
+
+    // Reject over-subscribed codes. Incomplete codes are fine, decoding fails if an unused code shows up.
+    int32_t left = 1;
+    for (uint8_t len = 1; len <= INFLATE_MAX_BITS; len++) {
+        left <<= 1;
+        left -= counts[len];
+        if (left < 0) {
+            return FIDO_ERR_DECOMPRESS;
+        }
+    }
+
+    offsets[1] = 0;
+    for (uint8_t len = 1; len < INFLATE_MAX_BITS; len++) {
+        offsets[len + 1] = offsets[len] + counts[len];
+    }
+    for (uint16_t symbol = 0; symbol < symbol_count; symbol++) {
+        if (lengths[symbol] != 0) {
+            symbols[offsets[lengths[symbol]]++] = symbol;
+        }
+    }
+    return FIDO_OK;
+}
+
+/**
+ * @brief Decode a single symbol, reading the code bit by bit.
+ *
+ * @param inflate The inflate state.
+ * @param huffman The code to use.
+ * @return int32_t The symbol, or -1 on error.
+ */
+static int32_t inflate_decode(fido_inflate_t *inflate, const inflate_huffman_t *huffman) {
+    int32_t code = 0;  // Bits read so far.
+    int32_t first = 0; // First code of the current length.
+    int32_t index = 0; // Index of the first symbol of the current length.
+
+    for (uint8_t len = 1; len <= INFLATE_MAX_BITS; len++) {
+        int32_t bit = inflate_bits(inflate, 1);
+        if (bit < 0) {
+            return -1;
+        }
+        code |= bit;
+        int32_t count = inflate_read(huffman->progmem, &huffman->counts[len]);
+        if (code - first < count) {
+            return inflate_read(huffman->progmem, &huffman->symbols[index + code - first]);
+        }
+        index += count;
+        first = (first + count) << 1;
+        code <<= 1;
+    }
+    return -1;
+}
+
+#ifdef FIDO_FAST_INFLATE
+/**
+ * @brief Reverse the order of the lowest bits of a code, as Huffman codes are stored starting with their most significant bit.
+ *
+ * @param code The code.
+ * @param length The number of bits of the code.
+ * @return uint16_t The reversed code.
+ */
+static uint16_t inflate_reverse(uint16_t code, uint8_t length) {
+    uint16_t reversed = 0;
+    for (uint8_t i = 0; i < length; i++) {
+        reversed = (reversed << 1) | (code & 1);
+        code >>= 1;
+    }
+    return reversed;
+}
+
+/**
+ * @brief Build a lookup table for a canonical Huffman code.
+ *        Codes of at most root_bits bits are resolved by a single lookup. Longer codes share a root entry
+ *        with all codes that have the same first root_bits bits, which links to a second level table.
+ *
+ * @param table The table to build.
+ * @param entries Buffer for the table entries.
+ * @param size The number of entries that fit into the buffer.
+ * @param root_bits The number of bits resolved by the first lookup.
+ * @param huffman The canonical Huffman code, not in flash.
+ * @return int FIDO_OK if the table was built.
+ */
+static int inflate_build_table(inflate_table_t *table, uint16_t *entries, uint16_t size, uint8_t root_bits, const inflate_huffman_t *huffman) {
+    const uint16_t root_size = 1 << root_bits;
+    uint8_t sub_bits[1 << INFLATE_LITLEN_ROOT_BITS];
+    uint16_t code;
+    uint16_t index;
+
+    table->entries = entries;
+    table->root_bits = root_bits;
+    table->progmem = false;
+
+    for (uint16_t i = 0; i < root_size; i++) {
+        entries[i] = INFLATE_ENTRY(INFLATE_ENTRY_INVALID, 0, 0);
+    }
+
+    // Determine the size of the second level tables, given by the longest code sharing a root entry.
+    memset(sub_bits, 0, root_size);
+    code = 0;
+    index = 0;
+    for (uint8_t len = 1; len <= INFLATE_MAX_BITS; len++) {
+        for (uint16_t i = 0; i < huffman->counts[len]; i++, code++, index++) {
+            if (len > root_bits) {
+                uint16_t root = inflate_reverse(code >> (len - root_bits), root_bits);
+                sub_bits[root] = len - root_bits;
+            }
+        }
+        code <<= 1;
+    }
+
+    uint16_t next = root_size;
+    for (uint16_t root = 0; root < root_size; root++) {
+        if (sub_bits[root] == 0) {
+            continue;
+        }
+        uint16_t sub_size = 1 << sub_bits[root];
+        if (next + sub_size > size) {
+            return FIDO_ERR_DECOMPRESS;
+        }
+        entries[root] = INFLATE_ENTRY(INFLATE_ENTRY_LINK, sub_bits[root], next);
+        for (uint16_t i = 0; i < sub_size; i++) {
+            entries[next + i] = INFLATE_ENTRY(INFLATE_ENTRY_INVALID, 0, 0);
+        }
+        next += sub_size;
+    }
+
+    // Fill in the symbols. Every entry whose index starts with the (reversed) code gets the symbol.
+    code = 0;
+    index = 0;
+    for (uint8_t len = 1; len <= INFLATE_MAX_BITS; len++) {
+        for (uint16_t i = 0; i < huffman->counts[len]; i++, code++, index++) {
+            uint16_t symbol = huffman->symbols[index];
+            uint16_t reversed = inflate_reverse(code, len);
+            uint16_t *fill_entries = entries;
+            uint8_t bits = len;
+            uint8_t size_bits = root_bits;
+            if (len > root_bits) {
+                uint16_t link = entries[reversed & (root_size - 1)];
+                fill_entries += INFLATE_ENTRY_VALUE(link);
+                reversed >>= root_bits;
+                bits = len - root_bits;
+                size_bits = INFLATE_ENTRY_BITS(link);
+            }
+            for (uint16_t fill = reversed; fill < (1U << size_bits); fill += 1U << bits) {
+                fill_entries[fill] = INFLATE_ENTRY(INFLATE_ENTRY_SYMBOL, bits, symbol);
+            }
+        }
+        code <<= 1;
+    }
+    return FIDO_OK;
+}
+
+/**
+ * @brief Fill the bit buffer with as many whole bytes as fit.
+ *
+ * @param inflate The inflate state.
+ */
+static inline void inflate_refill(fido_inflate_t *inflate) {
+    while (inflate->bit_count <= sizeof(inflate->bit_buffer) * 8 - 8 && inflate->in_pos < inflate->in_len) {
+        inflate->bit_buffer |= (fido_inflate_bit_buffer_t) inflate->in[inflate->in_pos++] << inflate->bit_count;
+        inflate->bit_count += 8;
+    }
+}
+
+/**
+ * @brief Decode a single symbol with at most two table lookups.
+ *
+ * @param inflate The inflate state.
+ * @param table The table of the code to use.
+ * @return int32_t The symbol, or -1 on error.
+ */
+static inline int32_t inflate_decode_symbol(fido_inflate_t *inflate, const inflate_table_t *table) {
+    if (inflate->bit_count < INFLATE_MAX_BITS) {
+        inflate_refill(inflate);
+    }
+
+    uint16_t entry = inflate_read(table->progmem, &table->entries[inflate->bit_buffer & ((1U << table->root_bits) - 1)]);
+    uint8_t bits = INFLATE_ENTRY_BITS(entry);
+    if (INFLATE_ENTRY_TYPE(entry) == INFLATE_ENTRY_LINK) {
+        uint16_t sub_index = (inflate->bit_buffer >> table->root_bits) & ((1U << bits) - 1);
+        entry = inflate_read(table->progmem, &table->entries[INFLATE_ENTRY_VALUE(entry) + sub_index]);
+        bits = table->root_bits + INFLATE_ENTRY_BITS(entry);
+    }
+    // If the input ended, the missing bits are zero and the code is longer than the bits we have.
+    if (INFLATE_ENTRY_TYPE(entry) != INFLATE_ENTRY_SYMBOL || bits > inflate->bit_count) {
+        return -1;
+    }
+
+    inflate->bit_buffer >>= bits;
+    inflate->bit_count -= bits;
+    return INFLATE_ENTRY_VALUE(entry);
+}
+
+#else
+#define inflate_decode_symbol inflate_decode
+#endif
+
+/**
+ * @brief Inflate a stored (uncompressed) block.
+ *
+ * @param inflate The inflate state.
+ * @return int FIDO_OK if the operation was successful.
+ */
+static int inflate_stored(fido_inflate_t *inflate) {
+    // Stored blocks start at a byte boundary.
+    inflate_align(inflate);
+
+    if (inflate->in_len - inflate->in_pos < 4) {
+        return FIDO_ERR_DECOMPRESS;
+    }
+    const uint8_t *header = inflate->in + inflate->in_pos;
+    uint16_t len = header[0] | (uint16_t) header[1] << 8;
+    uint16_t nlen = header[2] | (uint16_t) header[3] << 8;
+    inflate->in_pos += 4;
+    if ((uint16_t) (len ^ nlen) != 0xffff || inflate->in_len - inflate->in_pos < len) {
+        return FIDO_ERR_DECOMPRESS;
+    }
+
+    int r;
+    for (uint16_t i = 0; i < len; i++) {
+        if ((r = inflate_put(inflate, inflate->in[inflate->in_pos++])) != FIDO_OK) {
+            return r;
+        }
+    }
+    return FIDO_OK;
+}
+
+/**
+ * @brief Inflate the compressed data of a block, until the end of block symbol.
+ *
+ * @param inflate The inflate state.
+ * @param litlen The literal/length code.
+ * @param dist The distance code.
+ * @return int FIDO_OK if the operation was successful.
+ */
+static int inflate_codes(fido_inflate_t *inflate, const inflate_code_t *litlen, const inflate_code_t *dist) {
+    int r;
+    for (;;) {
+        int32_t symbol = inflate_decode_symbol(inflate, litlen);
+        if (symbol < 0) {
+            return FIDO_ERR_DECOMPRESS;
+        }
+        if (symbol < INFLATE_END_OF_BLOCK) {
+            if ((r = inflate_put(inflate, (uint8_t) symbol)) != FIDO_OK) {
+                return r;
+            }
+            continue;
+        }
+        if (symbol == INFLATE_END_OF_BLOCK) {
+            return FIDO_OK;
+        }
+
+        symbol -= INFLATE_END_OF_BLOCK + 1;
+        if (symbol >= (int32_t) sizeof(inflate_length_extra)) {
+            return FIDO_ERR_DECOMPRESS;
+        }
+        int32_t extra = inflate_bits(inflate, read_progmem_byte(&inflate_length_extra[symbol]));
+        if (extra < 0) {
+            return FIDO_ERR_DECOMPRESS;
+        }
+        uint16_t length = read_progmem_word(&inflate_length_base[symbol]) + extra;
+
+        symbol = inflate_decode_symbol(inflate, dist);
+        if (symbol < 0 || symbol >= INFLATE_NUM_DIST_CODES) {
+            return FIDO_ERR_DECOMPRESS;
+        }
+        extra = inflate_bits(inflate, read_progmem_byte(&inflate_dist_extra[symbol]));
+        if (extra < 0) {
+            return FIDO_ERR_DECOMPRESS;
+        }
+        size_t distance = read_progmem_word(&inflate_dist_base[symbol]) + extra;
+        if (distance > inflate->total_out || distance > inflate->window_len) {
+            return FIDO_ERR_DECOMPRESS;
+        }
+
+        size_t from = inflate->window_pos >= distance
+            ? inflate->window_pos - distance
+            : inflate->window_pos + inflate->window_len - distance;
+#ifdef FIDO_FAST_INFLATE
+        if (from < inflate->window_pos && inflate->window_len - inflate->window_pos >= length) {
+            // Neither source nor destination wrap around, copy without checking every byte.
+            // The copy has to go forward byte by byte, as the regions overlap for distance < length.
+            uint8_t *to = inflate->window + inflate->window_pos;
+            const uint8_t *src = inflate->window + from;
+            for (uint16_t i = 0; i < length; i++) {
+                to[i] = src[i];
+            }
+            inflate->window_pos += length;
+            inflate->total_out += length;
+            continue;
+        }
+#endif
+        while (length-- > 0) {
+            if ((r = inflate_put(inflate, inflate->window[from])) != FIDO_OK) {
+                return r;
+            }
+            if (++from == inflate->window_len) {
+                from = 0;
+            }
+        }
+    }
+}
+
+/**
+ * @brief The literal/length and distance codes of a block.
+ */
+typedef struct inflate_block_codes {
+    inflate_huffman_t litlen_huffman;
+    inflate_huffman_t dist_huffman;
+#ifdef FIDO_FAST_INFLATE
+    inflate_table_t litlen_table;
+    inflate_table_t dist_table;
+#endif
+} inflate_block_codes_t;
+
+/**
+ * @brief Build the literal/length and distance codes of a block from the code lengths of their symbols.
+ *
+ * @param codes The block codes.
+ * @param tables The buffers to build the codes in.
+ * @param litlen_count The number of literal/length symbols.
+ * @param dist_count The number of distance symbols. Their lengths follow the literal/length lengths.
+ * @return int FIDO_OK if the lengths describe valid codes.
+ */
+static int inflate_block_codes_build(inflate_block_codes_t *codes, fido_inflate_tables_t *tables, uint16_t litlen_count, uint16_t dist_count) {
+    if (inflate_build_huffman(&codes->litlen_huffman, tables->litlen_counts, tables->litlen_symbols, tables->lengths, litlen_count) != FIDO_OK ||
+        inflate_build_huffman(&codes->dist_huffman, tables->dist_counts, tables->dist_symbols, tables->lengths + litlen_count, dist_count) != FIDO_OK) {
+        return FIDO_ERR_DECOMPRESS;
+    }
+#ifdef FIDO_FAST_INFLATE
+    if (inflate_build_table(&codes->litlen_table, tables->litlen_entries, INFLATE_LITLEN_TABLE_SIZE, INFLATE_LITLEN_ROOT_BITS, &codes->litlen_huffman) != FIDO_OK ||
+        inflate_build_table(&codes->dist_table, tables->dist_entries, INFLATE_DIST_TABLE_SIZE, INFLATE_DIST_ROOT_BITS, &codes->dist_huffman) != FIDO_OK) {
+        return FIDO_ERR_DECOMPRESS;
+    }
+#endif
+    return FIDO_OK;
+}
+
+/**
+ * @brief Inflate the compressed data of a block with the given codes.
+ *
+ * @param inflate The inflate state.
+ * @param codes The codes of the block.
+ * @return int FIDO_OK if the operation was successful.
+ */
+static int inflate_block(fido_inflate_t *inflate, const inflate_block_codes_t *codes) {
+#ifdef FIDO_FAST_INFLATE
+    return inflate_codes(inflate, &codes->litlen_table, &codes->dist_table);
+#else
+    return inflate_codes(inflate, &codes->litlen_huffman, &codes->dist_huffman);
+#endif
+}
+
+/**
+ * @brief Inflate a block compressed with the fixed Huffman codes.
+ *        Their decoding structures are precomputed, see tools/gen_inflate_tables.py.
+ *
+ * @param inflate The inflate state.
+ * @return int FIDO_OK if the operation was successful.
+ */
+static int inflate_fixed(fido_inflate_t *inflate) {
+#ifdef FIDO_FAST_INFLATE
+    static const inflate_block_codes_t codes = {
+        .litlen_table = { .entries = inflate_fixed_litlen_table, .root_bits = INFLATE_LITLEN_ROOT_BITS, .progmem = true },
+        .dist_table = { .entries = inflate_fixed_dist_table, .root_bits = INFLATE_DIST_ROOT_BITS, .progmem = true },
+    };
+#else
+    static const inflate_block_codes_t codes = {
+        .litlen_huffman = { .counts = inflate_fixed_litlen_counts, .symbols = inflate_fixed_litlen_symbols, .progmem = true },
+        .dist_huffman = { .counts = inflate_fixed_dist_counts, .symbols = inflate_fixed_dist_symbols, .progmem = true },
+    };
+#endif
+    return inflate_block(inflate, &codes);
+}
+
+/**
+ * @brief Inflate a block compressed with Huffman codes that are stored in the block header.
+ *
+ * @param inflate The inflate state.
+ * @param tables The buffers to build the codes in.
+ * @return int FIDO_OK if the operation was successful.
+ */
+static int inflate_dynamic(fido_inflate_t *inflate, fido_inflate_tables_t *tables) {
+    uint8_t *lengths = tables->lengths;
+    inflate_block_codes_t codes;
+
+    int32_t hlit = inflate_bits(inflate, 5);
+    int32_t hdist = inflate_bits(inflate, 5);
+    int32_t hclen = inflate_bits(inflate, 4);
+    if (hlit < 0 || hdist < 0 || hclen < 0) {
+        return FIDO_ERR_DECOMPRESS;
+    }
+    uint16_t litlen_count = hlit + 257;
+    uint16_t dist_count = hdist + 1;
+    uint8_t codelen_count = hclen + 4;
+    if (litlen_count > 286 || dist_count > INFLATE_NUM_DIST_CODES) {
+        return FIDO_ERR_DECOMPRESS;
+    }
+
+    // The code for the code lengths is only used for the header, it reuses the literal/length buffers.
+    inflate_huffman_t *codelen = &codes.litlen_huffman;
+    memset(lengths, 0, INFLATE_NUM_CODELEN_CODES);
+    for (uint8_t i = 0; i < codelen_count; i++) {
+        int32_t len = inflate_bits(inflate, 3);
+        if (len < 0) {
+            return FIDO_ERR_DECOMPRESS;
+        }
+        lengths[read_progmem_byte(&inflate_codelen_order[i])] = (uint8_t) len;
+    }
+    if (inflate_build_huffman(codelen, tables->litlen_counts, tables->litlen_symbols, lengths, INFLATE_NUM_CODELEN_CODES) != FIDO_OK) {
+        return FIDO_ERR_DECOMPRESS;
+    }
+
+    uint16_t index = 0;
+    while (index < litlen_count + dist_count) {
+        int32_t symbol = inflate_decode(inflate, codelen);
+        if (symbol < 0) {
+            return FIDO_ERR_DECOMPRESS;
+        }
+        if (symbol < 16) {
+            lengths[index++] = (uint8_t) symbol;
+            continue;
+        }
+
+        uint8_t len = 0;
+        int32_t repeat;
+        if (symbol == 16) {
+            // Repeat the previous length 3..6 times.
+            if (index == 0) {
+                return FIDO_ERR_DECOMPRESS;
+            }
+            len = lengths[index - 1];
+            repeat = inflate_bits(inflate, 2);
+            repeat = repeat < 0 ? repeat : repeat + 3;
+        } else if (symbol == 17) {
+            // Repeat zero 3..10 times.
+            repeat = inflate_bits(inflate, 3);
+            repeat = repeat < 0 ? repeat : repeat + 3;
+        } else {
+            // Repeat zero 11..138 times.
+            repeat = inflate_bits(inflate, 7);
+            repeat = repeat < 0 ? repeat : repeat + 11;
+        }
+        if (repeat < 0 || index + repeat > litlen_count + dist_count) {
+            return FIDO_ERR_DECOMPRESS;
+        }
+        memset(lengths + index, len, repeat);
+        index += repeat;
+    }
+
+    if (lengths[INFLATE_END_OF_BLOCK] == 0) {
+        return FIDO_ERR_DECOMPRESS;
+    }
+    if (inflate_block_codes_build(&codes, tables, litlen_count, dist_count) != FIDO_OK) {
+        return FIDO_ERR_DECOMPRESS;
+    }
+
+    return inflate_block(inflate, &codes);
+}
+
+int fido_inflate(fido_inflate_t *inflate, const uint8_t *in, size_t in_len) {
+    inflate->in = in;
+    inflate->in_len = in_len;
+    inflate->in_pos = 0;
+    inflate->bit_buffer = 0;
+    inflate->bit_count = 0;
+
+    int r;
+    int32_t final;
+    do {
+        final = inflate_bits(inflate, 1);
+        int32_t type = inflate_bits(inflate, 2);
+        if (final < 0 || type < 0) {
+            return FIDO_ERR_DECOMPRESS;
+        }
+
+        switch (type) {
+        case INFLATE_BLOCK_STORED:
+            r = inflate_stored(inflate);
+            break;
+        case INFLATE_BLOCK_FIXED:
+            r = inflate_fixed(inflate);
+            break;
+        case INFLATE_BLOCK_DYNAMIC:
+            if (inflate->tables != NULL) {
+                r = inflate_dynamic(inflate, inflate->tables);
+            } else {
+                fido_inflate_tables_t tables;
+                r = inflate_dynamic(inflate, &tables);
+            }
+            break;
+        default:
+            r = FIDO_ERR_DECOMPRESS;
+            break;
+        }
+        if (r != FIDO_OK) {
+            return r;
+        }
+    } while (!final);
+
+    return inflate_flush(inflate);
+}
@@ -14,36 +14,45 @@
 #include "cb0r.h"
 #include "cbor.h"
 
+#ifndef FIDO_NO_INFO_DETAILS
 // versions
 static const char fido_2_1_version[] PROGMEM_MARKER        = "FIDO_2_1";
 static const char fido_2_0_version[] PROGMEM_MARKER        = "FIDO_2_0";
 static const char fido_2_1_pre_version[] PROGMEM_MARKER    = "FIDO_2_1_PRE";
 static const char fido_u2f_v2_version[] PROGMEM_MARKER     = "U2F_V2";
+#endif
 
 // extensions
-static const char fido_extension_cred_blob[] PROGMEM_MARKER       = "credBlob";
-static const char fido_extension_hmac_secret[] PROGMEM_MARKER     = "hmac-secret";
 static const char fido_extension_cred_protect[] PROGMEM_MARKER    = "credProtect";
+#ifndef FIDO_NO_LARGEBLOB
 static const char fido_extension_large_blob_key[] PROGMEM_MARKER  = "largeBlobKey";
+#endif
+static const char fido_extension_cred_blob[] PROGMEM_MARKER       = "credBlob";
+#ifndef FIDO_NO_INFO_DETAILS
+static const char fido_extension_hmac_secret[] PROGMEM_MARKER     = "hmac-secret";
 static const char fido_extension_min_pin_length[] PROGMEM_MARKER  = "minPinLength";
+#endif
 
 // options
-static const char fido_option_plat[] PROGMEM_MARKER                                 = "plat";
-static const char fido_option_rk[] PROGMEM_MARKER                                   = "rk";
 static const char fido_option_client_pin[] PROGMEM_MARKER                           = "clientPin";
-static const char fido_option_up[] PROGMEM_MARKER                                   = "up";
 static const char fido_option_uv[] PROGMEM_MARKER                                   = "uv";
 static const char fido_option_pin_uv_auth_token[] PROGMEM_MARKER                    = "pinUvAuthToken";
-static const char fido_option_no_mc_ga_permissions_with_client_pin[] PROGMEM_MARKER = "noMcGaPermissionsWithClientPin";
+static const char fido_option_cred_mgmt[] PROGMEM_MARKER                            = "credMgmt";
+static const char fido_option_credential_management_preview[] PROGMEM_MARKER        = "credentialMgmtPreview";
+#ifndef FIDO_NO_LARGEBLOB
 static const char fido_option_large_blobs[] PROGMEM_MARKER                          = "largeBlobs";
+#endif
+#ifndef FIDO_NO_INFO_DETAILS
+static const char fido_option_plat[] PROGMEM_MARKER                                 = "plat";
+static const char fido_option_rk[] PROGMEM_MARKER                                   = "rk";
+static const char fido_option_up[] PROGMEM_MARKER                                   = "up";
+static const char fido_option_no_mc_ga_permissions_with_client_pin[] PROGMEM_MARKER = "noMcGaPermissionsWithClientPin";
 static const char fido_option_ep[] PROGMEM_MARKER                                   = "ep";
 static const char fido_option_bio_enroll[] PROGMEM_MARKER                           = "bioEnroll";
 static const char fido_option_user_verification_mgmt_preview[] PROGMEM_MARKER       = "userVerificationMgmtPreview";
 static const char fido_option_uv_bio_enroll[] PROGMEM_MARKER                        = "uvBioEnroll";
 static const char fido_option_authnr_config[] PROGMEM_MARKER                        = "authnrCfg";
 static const char fido_option_uv_acfg[] PROGMEM_MARKER                              = "uvAcfg";
-static const char fido_option_cred_mgmt[] PROGMEM_MARKER                            = "credMgmt";
-static const char fido_option_credential_management_preview[] PROGMEM_MARKER        = "credentialMgmtPreview";
 static const char fido_option_set_min_pin_length[] PROGMEM_MARKER                   = "setMinPINLength";
 static const char fido_option_make_cred_uv_not_rqd[] PROGMEM_MARKER                 = "makeCredUvNotRqd";
 static const char fido_option_always_uv[] PROGMEM_MARKER                            = "alwaysUv";
@@ -56,11 +65,13 @@ static const char fido_transport_internal[] PROGMEM_MARKER  = "internal";
 
 // algorithm
 static const char fido_algorithm_key[] PROGMEM_MARKER  = "alg";
+#endif
 
 void fido_cbor_info_reset(fido_cbor_info_t *ci) {
     memset(ci, 0x0, sizeof(*ci));
 }
 
+#ifndef FIDO_NO_INFO_DETAILS
 /**
  * @brief Extract the AAGUID from the CBOR response.
  * 
@@ -75,6 +86,7 @@ static int copy_aaguid(const cb0r_t value, fido_cbor_info_t *ci) {
     memcpy(ci->aaguid, value->start + value->header, value->length);
     return FIDO_OK;
 }
+#endif
 
 /**
  * @brief Decode an unsigned integer from the CBOR response.
@@ -91,6 +103,7 @@ static int decode_uint64(const cb0r_t value, uint64_t *target) {
     return FIDO_OK;
 }
 
+#ifndef FIDO_NO_INFO_DETAILS
 /**
  * @brief Parse the versions array from the CBOR response.
  * 
@@ -119,6 +132,7 @@ static int cbor_info_decode_versions(const cb0r_t element, void *ci) {
 
     return FIDO_OK;
 }
+#endif
 
 /**
  * @brief Parse the extensions array from the CBOR response.
@@ -134,16 +148,20 @@ static int cbor_info_decode_extensions(const cb0r_t element, void *ci) {
 
     fido_cbor_info_t* info = (fido_cbor_info_t*) ci;
 
-    if(CBOR_STR_MEMCMP(element, fido_extension_cred_blob)) {
-        info->extensions |= FIDO_EXTENSION_CRED_BLOB;
-    } else if(CBOR_STR_MEMCMP(element, fido_extension_hmac_secret)) {
-        info->extensions |= FIDO_EXTENSION_HMAC_SECRET;
-    } else if(CBOR_STR_MEMCMP(element, fido_extension_cred_protect)) {
+    if(CBOR_STR_MEMCMP(element, fido_extension_cred_protect)) {
         info->extensions |= FIDO_EXTENSION_CRED_PROTECT;
+#ifndef FIDO_NO_LARGEBLOB
     } else if(CBOR_STR_MEMCMP(element, fido_extension_large_blob_key)) {
         info->extensions |= FIDO_EXTENSION_LARGE_BLOB_KEY;
+#endif
+    } else if(CBOR_STR_MEMCMP(element, fido_extension_cred_blob)) {
+        info->extensions |= FIDO_EXTENSION_CRED_BLOB;
+#ifndef FIDO_NO_INFO_DETAILS
+    } else if(CBOR_STR_MEMCMP(element, fido_extension_hmac_secret)) {
+        info->extensions |= FIDO_EXTENSION_HMAC_SECRET;
     } else if(CBOR_STR_MEMCMP(element, fido_extension_min_pin_length)) {
         info->extensions |= FIDO_EXTENSION_MIN_PIN_LENGTH;
+#endif
     }
 
     return FIDO_OK;
@@ -174,26 +192,33 @@ static int cbor_info_decode_options(const cb0r_t key, const cb0r_t value, void *
 
     fido_cbor_info_t* info = (fido_cbor_info_t*) ci;
 
-    if(CBOR_STR_MEMCMP(key, fido_option_plat)) {
-        info->options |= FIDO_OPTION_PLAT;
-    } else if(CBOR_STR_MEMCMP(key, fido_option_rk)) {
-        info->options |= FIDO_OPTION_RK;
-    } else if(CBOR_STR_MEMCMP(key, fido_option_client_pin)) {
+    if(CBOR_STR_MEMCMP(key, fido_option_client_pin)) {
         /* NOTE: We loose information here on whether a PIN is supported but unset (value is False),
          *       or not supported at all (option unset). However, this library is intended to be
          *       minimal and hence only interested in whether a PIN is set at all. */
         info->options |= FIDO_OPTION_CLIENT_PIN;
-    } else if(CBOR_STR_MEMCMP(key, fido_option_up)) {
-        info->options |= FIDO_OPTION_UP;
     } else if(CBOR_STR_MEMCMP(key, fido_option_uv)) {
         // Same issue as with fido_option_client_pin here
         info->options |= FIDO_OPTION_UV;
     } else if(CBOR_STR_MEMCMP(key, fido_option_pin_uv_auth_token)) {
         info->options |= FIDO_OPTION_PIN_UV_AUTH_TOKEN;
-    } else if(CBOR_STR_MEMCMP(key, fido_option_no_mc_ga_permissions_with_client_pin)) {
-        info->options |= FIDO_OPTION_NO_MC_GA_PERMISSIONS_WITH_CLIENT_PIN;
+    } else if(CBOR_STR_MEMCMP(key, fido_option_cred_mgmt)) {
+        info->options |= FIDO_OPTION_CRED_MGMT;
+    } else if(CBOR_STR_MEMCMP(key, fido_option_credential_management_preview)) {
+        info->options |= FIDO_OPTION_CREDENTIAL_MANAGEMENT_PREVIEW;
+#ifndef FIDO_NO_LARGEBLOB
     } else if(CBOR_STR_MEMCMP(key, fido_option_large_blobs)) {
         info->options |= FIDO_OPTION_LARGE_BLOBS;
+#endif
+#ifndef FIDO_NO_INFO_DETAILS
+    } else if(CBOR_STR_MEMCMP(key, fido_option_plat)) {
+        info->options |= FIDO_OPTION_PLAT;
+    } else if(CBOR_STR_MEMCMP(key, fido_option_rk)) {
+        info->options |= FIDO_OPTION_RK;
+    } else if(CBOR_STR_MEMCMP(key, fido_option_up)) {
+        info->options |= FIDO_OPTION_UP;
+    } else if(CBOR_STR_MEMCMP(key, fido_option_no_mc_ga_permissions_with_client_pin)) {
+        info->options |= FIDO_OPTION_NO_MC_GA_PERMISSIONS_WITH_CLIENT_PIN;
     } else if(CBOR_STR_MEMCMP(key, fido_option_ep)) {
         info->options |= FIDO_OPTION_EP;
     } else if(CBOR_STR_MEMCMP(key, fido_option_bio_enroll)) {
@@ -206,16 +231,13 @@ static int cbor_info_decode_options(const cb0r_t key, const cb0r_t value, void *
         info->options |= FIDO_OPTION_AUTHNR_CONFIG;
     } else if(CBOR_STR_MEMCMP(key, fido_option_uv_acfg)) {
         info->options |= FIDO_OPTION_UV_ACFG;
-    } else if(CBOR_STR_MEMCMP(key, fido_option_cred_mgmt)) {
-        info->options |= FIDO_OPTION_CRED_MGMT;
-    } else if(CBOR_STR_MEMCMP(key, fido_option_credential_management_preview)) {
-        info->options |= FIDO_OPTION_CREDENTIAL_MANAGEMENT_PREVIEW;
     } else if(CBOR_STR_MEMCMP(key, fido_option_set_min_pin_length)) {
         info->options |= FIDO_OPTION_SET_MIN_PIN_LENGTH;
     } else if(CBOR_STR_MEMCMP(key, fido_option_make_cred_uv_not_rqd)) {
         info->options |= FIDO_OPTION_MAKE_CRED_UV_NOT_RQD;
     } else if(CBOR_STR_MEMCMP(key, fido_option_always_uv)) {
         info->options |= FIDO_OPTION_ALWAYS_UV;
+#endif
     }
 
     return FIDO_OK;
@@ -248,6 +270,7 @@ static int cbor_info_decode_protocol(const cb0r_t element, void *arg) {
     return FIDO_OK;
 }
 
+#ifndef FIDO_NO_INFO_DETAILS
 /**
  * @brief Parse a cb0r element containing a supported CTAP transport.
  * 
@@ -336,6 +359,7 @@ static int cbor_info_decode_algorithm(const cb0r_t element, void *arg) {
 
     return cbor_iter_map(element, cbor_info_decode_algorithm_entry, arg);
 }
+#endif
 
 /**
  * @brief Parse an entry of the authenticatorGetInfo CBOR map.
@@ -354,18 +378,23 @@ static int parse_info_reply_entry(const cb0r_t key, const cb0r_t value, void *ar
     fido_cbor_info_t *ci = (fido_cbor_info_t*)arg;
 
     switch (key->value) {
+#ifndef FIDO_NO_INFO_DETAILS
         case 1: // versions
             return cbor_iter_array(value, cbor_info_decode_versions, ci);
+#endif
         case 2: // extensions
             return cbor_iter_array(value, cbor_info_decode_extensions, ci);
+#ifndef FIDO_NO_INFO_DETAILS
         case 3: // aaguid
             return copy_aaguid(value, ci);
+#endif
         case 4: // options
             return cbor_iter_map(value, cbor_info_decode_options, ci);
         case 5: // maxMsgSize
             return decode_uint64(value, &ci->maxmsgsize);
         case 6: // pinProtocols
             return cbor_iter_array(value, cbor_info_decode_protocol, ci);
+#ifndef FIDO_NO_INFO_DETAILS
         case 7: // maxCredentialCountInList
             return decode_uint64(value, &ci->maxcredcntlst);
         case 8: // maxCredentialIdLength
@@ -374,10 +403,13 @@ static int parse_info_reply_entry(const cb0r_t key, const cb0r_t value, void *ar
             return cbor_iter_array(value, cbor_info_decode_transport, ci);
         case 10: // algorithms
             return cbor_iter_array(value, cbor_info_decode_algorithm, ci);
+#endif
         case 11: // maxSerializedLargeBlobArray
             return decode_uint64(value, &ci->maxlargeblob);
+#ifndef FIDO_NO_INFO_DETAILS
         case 14: // fwVersion
             return decode_uint64(value, &ci->fwversion);
+#endif
         case 15: // maxCredBlobLen
             return decode_uint64(value, &ci->maxcredbloblen);
         default: // ignore
@@ -430,13 +462,18 @@ static int fido_dev_get_cbor_info_rx(fido_dev_t *dev, fido_cbor_info_t *ci) {
     }
 
     cb0r_s map;
+    int r;
     // This should always be a map.
+    FIDO_TRACE_BEGIN(FIDO_TRACE_CBOR, msglen - 1);
     if (!cb0r_read(msg+1, msglen-1, &map) || map.type != CB0R_MAP) {
-        return  FIDO_ERR_CBOR_UNEXPECTED_TYPE;
+        r = FIDO_ERR_CBOR_UNEXPECTED_TYPE;
+    } else {
+        // The next step parses the response.
+        r = cbor_iter_map(&map, &parse_info_reply_entry, ci);
     }
+    FIDO_TRACE_END(FIDO_TRACE_CBOR, msglen - 1);
 
-    // The next step parses the response.
-    return cbor_iter_map(&map, &parse_info_reply_entry, ci);
+    return r;
 }
 
 int fido_dev_get_cbor_info_wait(fido_dev_t *dev, fido_cbor_info_t *ci) {
@@ -12,28 +12,50 @@
 #include <string.h>
 
 int fido_tx(fido_dev_t *d, const uint8_t cmd, const void *buf, const size_t len) {
+    int r;
     fido_log_debug("%s: dev=%p, cmd=0x%02x", __func__, (void *)d, cmd);
     fido_log_xxd(buf, len, "%s", __func__);
 
-    if (d->io_handle == NULL || d->io.write == NULL || d->transport.tx == NULL || len > UINT16_MAX) {
+    if (d->io_handle == NULL || !FIDO_IO_IS_SET(d, write) || !FIDO_TRANSPORT_IS_SET(d, tx) || len > UINT16_MAX) {
         fido_log_debug("%s: invalid argument", __func__);
         return FIDO_ERR_INVALID_ARGUMENT;
     }
 
-    return d->transport.tx(d, cmd, buf, len);
+    FIDO_STATS_START(d, start);
+    FIDO_TRACE_BEGIN(FIDO_TRACE_TX, cmd);
+    r = FIDO_TRANSPORT_TX(d, cmd, buf, len);
+    FIDO_TRACE_END(FIDO_TRACE_TX, cmd);
+    FIDO_STATS_STOP(d, FIDO_DEV_STATS_TX, start);
+
+    FIDO_STATS_INC(d, commands);
+    if (r != FIDO_OK) {
+        FIDO_STATS_INC(d, errors);
+    }
+
+    return r;
 }
 
 int fido_rx(fido_dev_t *d, const uint8_t cmd, void *buf, const size_t len) {
     int n;
     fido_log_debug("%s: dev=%p, cmd=0x%02x", __func__, (void *)d, cmd);
 
-    if (d->io_handle == NULL || d->io.read == NULL || d->transport.rx == NULL || len > UINT16_MAX) {
+    if (d->io_handle == NULL || !FIDO_IO_IS_SET(d, read) || !FIDO_TRANSPORT_IS_SET(d, rx) || len > UINT16_MAX) {
         fido_log_debug("%s: invalid argument", __func__);
         return FIDO_ERR_INVALID_ARGUMENT;
     }
 
+    FIDO_STATS_START(d, start);
+    FIDO_TRACE_BEGIN(FIDO_TRACE_RX, cmd);
+    n = FIDO_TRANSPORT_RX(d, cmd, buf, len);
+    FIDO_TRACE_END(FIDO_TRACE_RX, cmd);
+    FIDO_STATS_STOP(d, FIDO_DEV_STATS_RX, start);
+
+    if (n < 0) {
+        FIDO_STATS_INC(d, errors);
+    }
+
     // Values below 0 are errors.
-    if ((n = d->transport.rx(d, cmd, buf, len)) >= 0)
+    if (n >= 0)
         fido_log_xxd(buf, (size_t)n, "%s", __func__);
 
     return n;
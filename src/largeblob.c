@@ -14,23 +14,30 @@
 #include "cbor.h"
 #include "dev.h"
 #include "crypto.h"
-#include <tinf.h>
+#include "inflate.h"
 #include <stdint.h>
 #include <string.h>
 
+#ifdef FIDO_PARALLEL_LARGEBLOB
+#include <pthread.h>
+#include <unistd.h>
+#endif
+
 #define LARGEBLOB_TAG_SIZE               AES_GCM_TAG_SIZE
 #define LARGEBLOB_DIGEST_SIZE            SHA256_BLOCK_SIZE
 #define LARGEBLOB_DIGEST_COMPARISON_SIZE 16
 
-// Empty CBOR array (80) followed by LEFT(SHA-256(h'80'), 16)
-static const uint8_t fido_largeblob_initial_array[] PROGMEM_MARKER = {0x80, 0x76, 0xbe, 0x8b, 0x52, 0x8d, 0x00, 0x75, 0xf7, 0xaa, 0xe9, 0x8d, 0x6f, 0xa5, 0x7a, 0x6d, 0x3c};
-
 void fido_blob_reset(fido_blob_t *blob, uint8_t *buffer, size_t buffer_len) {
     blob->buffer = buffer;
     blob->max_length = buffer_len;
     blob->length = 0;
 }
 
+#ifndef FIDO_NO_LARGEBLOB
+
+// Empty CBOR array (80) followed by LEFT(SHA-256(h'80'), 16)
+static const uint8_t fido_largeblob_initial_array[] PROGMEM_MARKER = {0x80, 0x76, 0xbe, 0x8b, 0x52, 0x8d, 0x00, 0x75, 0xf7, 0xaa, 0xe9, 0x8d, 0x6f, 0xa5, 0x7a, 0x6d, 0x3c};
+
 /**
  * @brief Return the length of a chunk when reading the large blob.
  *        Repeated requests to the large blob are used to read out the desired
@@ -94,11 +101,13 @@ static bool largeblob_array_digest(uint8_t out[LARGEBLOB_DIGEST_SIZE], const uin
         return false;
     }
 
-    if(fido_sha256 == NULL) {
+    if(!FIDO_CRYPTO_IS_SET(sha256)) {
         return FIDO_ERR_INTERNAL;
     }
 
-    fido_sha256(data, len, out);
+    FIDO_TRACE_BEGIN(FIDO_TRACE_HASH, len);
+    FIDO_CRYPTO_CALL(sha256)(data, len, out);
+    FIDO_TRACE_END(FIDO_TRACE_HASH, len);
     return true;
 }
 
@@ -211,12 +220,13 @@ static int largeblob_get_rx(fido_dev_t *dev, fido_blob_t *chunk) {
     }
 
     cb0r_s map;
+    FIDO_TRACE_BEGIN(FIDO_TRACE_CBOR, msglen - 1);
     if (!cb0r_read(msg+1, msglen-1, &map) || map.type != CB0R_MAP) {
         ret = FIDO_ERR_CBOR_UNEXPECTED_TYPE;
-        goto out;
+    } else {
+        ret = cbor_iter_map(&map, &parse_largeblob_reply, chunk);
     }
-
-    ret = cbor_iter_map(&map, &parse_largeblob_reply, chunk);
+    FIDO_TRACE_END(FIDO_TRACE_CBOR, msglen - 1);
 
 out:
     memset(msg, 0, dev->maxmsgsize);
@@ -246,6 +256,7 @@ int fido_dev_largeblob_get_array(fido_dev_t *dev, fido_blob_t *largeblob_array)
                 fido_log_debug("%s: largeblob_get_wait %zu/%zu", __func__, largeblob_array->length, get_len);
                 return r;
         }
+        FIDO_STATS_INC(dev, largeblob_chunks);
         // Receiving the chunk of data was successful.
         // The data was automatically appended to largeblob_array, because chunk uses the same buffer.
         largeblob_array->length += chunk.length;
@@ -264,8 +275,11 @@ int fido_dev_largeblob_get_array(fido_dev_t *dev, fido_blob_t *largeblob_array)
 }
 
 typedef struct largeblob_array_lookup_param {
-    fido_blob_t *result;
+    fido_blob_t *result;    // Used if stream is NULL.
+    fido_inflate_t *stream; // Receives the data of the matching entry, if not NULL.
+    fido_inflate_tables_t *tables; // Buffers for decompression, may be NULL.
     uint8_t *key;
+    fido_dev_t *dev; // For the statistics.
     bool success;
 } largeblob_array_lookup_param_t;
 
@@ -279,27 +293,73 @@ typedef struct largeblob_array_entry {
 } largeblob_array_entry_t;
 
 /**
- * @brief Uncompress the compressed data using tinf and store it in the provided buffer.
+ * @brief Uncompress the compressed data and store it in the provided buffer.
  *
  * @param out Pointer to a buffer to store the uncompressed data to.
  * @param compressed Pointer to the compressed data.
  * @param compressed_len Length of the compressed data.
  * @param uncompressed_len_expected Expected length of the uncompressed data, to ensure that we got everything.
+ * @param tables Buffers for the dynamic Huffman codes, may be NULL.
  * @return int FIDO_OK if the operation was successful.
  */
-static int fido_uncompress(fido_blob_t* out, uint8_t *compressed, size_t compressed_len, size_t uncompressed_len_expected) {
-    uint32_t uncompressed_len_actual = out->max_length;
+static int fido_uncompress(fido_blob_t* out, uint8_t *compressed, size_t compressed_len, size_t uncompressed_len_expected, fido_inflate_tables_t *tables) {
+    int r;
     if(out->max_length < uncompressed_len_expected) {
         return FIDO_ERR_INVALID_ARGUMENT;
     }
-    if(tinf_uncompress(out->buffer, &uncompressed_len_actual, compressed, compressed_len) != TINF_OK ||
-       uncompressed_len_actual != uncompressed_len_expected) {
+    // Without an output callback, the output buffer is the window.
+    fido_inflate_t inflate;
+    fido_inflate_init(&inflate, out->buffer, out->max_length, NULL, NULL);
+    fido_inflate_set_tables(&inflate, tables);
+    FIDO_TRACE_BEGIN(FIDO_TRACE_INFLATE, compressed_len);
+    r = fido_inflate(&inflate, compressed, compressed_len);
+    FIDO_TRACE_END(FIDO_TRACE_INFLATE, compressed_len);
+    if(r != FIDO_OK || inflate.total_out != uncompressed_len_expected) {
+        return FIDO_ERR_DECOMPRESS;
+    }
+    out->length = inflate.total_out;
+    return FIDO_OK;
+}
+
+/**
+ * @brief Uncompress the compressed data and pass it to the output of the inflate state.
+ *
+ * @param stream The initialized inflate state.
+ * @param compressed Pointer to the compressed data.
+ * @param compressed_len Length of the compressed data.
+ * @param uncompressed_len_expected Expected length of the uncompressed data, to ensure that we got everything.
+ * @return int FIDO_OK if the operation was successful.
+ */
+static int fido_uncompress_stream(fido_inflate_t *stream, uint8_t *compressed, size_t compressed_len, size_t uncompressed_len_expected) {
+    int r;
+    FIDO_TRACE_BEGIN(FIDO_TRACE_INFLATE, compressed_len);
+    r = fido_inflate(stream, compressed, compressed_len);
+    FIDO_TRACE_END(FIDO_TRACE_INFLATE, compressed_len);
+    if(r != FIDO_OK) {
+        return r;
+    }
+    if(stream->total_out != uncompressed_len_expected) {
         return FIDO_ERR_DECOMPRESS;
     }
-    out->length = uncompressed_len_actual;
     return FIDO_OK;
 }
 
+/**
+ * @brief Set the original size of an entry and the associated data that depends on it.
+ *
+ * @param entry The largeblob array entry.
+ * @param origSize The original size of the uncompressed data.
+ */
+static void largeblob_set_associated_data(largeblob_array_entry_t *entry, uint64_t origSize) {
+    entry->origSize = origSize;
+    entry->associated_data[0] = 'b';
+    entry->associated_data[1] = 'l';
+    entry->associated_data[2] = 'o';
+    entry->associated_data[3] = 'b';
+    uint64_t little_endian_orig_size = htole64(entry->origSize);
+    memcpy(entry->associated_data + 4, &little_endian_orig_size, sizeof(uint64_t));
+}
+
 /**
  * @brief Parse an entry in the largeblob array.
  *
@@ -341,14 +401,7 @@ static int largeblob_parse_array_entry(cb0r_t key, cb0r_t value, void *data) {
         if (value->type != CB0R_INT || value->value > SIZE_MAX) {
             return FIDO_ERR_CBOR_UNEXPECTED_TYPE;
         }
-        entry->origSize = (size_t)value->value;
-        entry->associated_data[0] = 'b';
-        entry->associated_data[1] = 'l';
-        entry->associated_data[2] = 'o';
-        entry->associated_data[3] = 'b';
-        uint64_t little_endian_orig_size = htole64(entry->origSize);
-        memcpy(entry->associated_data + 4, &little_endian_orig_size, sizeof(uint64_t));
-
+        largeblob_set_associated_data(entry, (size_t)value->value);
         return FIDO_OK;
     default: // ignore
         fido_log_debug("%s: cbor type", __func__);
@@ -356,6 +409,67 @@ static int largeblob_parse_array_entry(cb0r_t key, cb0r_t value, void *data) {
     }
 }
 
+/**
+ * @brief Parse a single element of the largeblob array into an entry.
+ *
+ * @param value The CBOR encoded array element.
+ * @param entry The largeblob array entry object to store the parsed data to.
+ * @return int FIDO_OK if the operation was successful.
+ */
+static int largeblob_read_array_entry(cb0r_t value, largeblob_array_entry_t *entry) {
+    memset(entry, 0, sizeof(*entry));
+
+    cb0r_s map;
+    int r;
+    FIDO_TRACE_BEGIN(FIDO_TRACE_CBOR, value->end - value->start);
+    if (!cb0r_read(value->start, value->end - value->start, &map) || map.type != CB0R_MAP) {
+        r = FIDO_ERR_CBOR_UNEXPECTED_TYPE;
+    } else {
+        r = cbor_iter_map(&map, largeblob_parse_array_entry, (void*) entry);
+    }
+    FIDO_TRACE_END(FIDO_TRACE_CBOR, value->end - value->start);
+
+    return r;
+}
+
+/**
+ * @brief Check whether a parsed entry contains all fields needed to decrypt it.
+ *
+ * @param entry The entry to check.
+ * @return bool true if ciphertext, tag and nonce are present.
+ */
+static inline bool largeblob_array_entry_is_complete(const largeblob_array_entry_t *entry) {
+    return entry->ciphertext != NULL && entry->nonce != NULL;
+}
+
+/**
+ * @brief Try to decrypt an entry of the largeblob array with the given key.
+ *
+ * @param key The AES key to use for decryption.
+ * @param entry The entry to decrypt.
+ * @param plaintext Pointer to where to write the plaintext to. May be the entry's ciphertext.
+ * @return int FIDO_OK if the authentication tag matched.
+ */
+static int largeblob_array_entry_decrypt(const uint8_t *key, const largeblob_array_entry_t *entry, uint8_t *plaintext) {
+    int r;
+    if(!FIDO_CRYPTO_IS_SET(aes_gcm_decrypt)) {
+        return FIDO_ERR_INTERNAL;
+    }
+
+    FIDO_TRACE_BEGIN(FIDO_TRACE_AES_GCM, entry->ciphertext_len);
+    r = FIDO_CRYPTO_CALL(aes_gcm_decrypt)(key, LARGEBLOB_KEY_SIZE,
+        entry->nonce, LARGEBLOB_NONCE_SIZE,
+        entry->ciphertext, entry->ciphertext_len,
+        entry->associated_data, sizeof(entry->associated_data),
+        entry->tag,
+        plaintext);
+    FIDO_TRACE_END(FIDO_TRACE_AES_GCM, entry->ciphertext_len);
+    if(r != 0) {
+        return FIDO_ERR_INVALID_SIG;
+    }
+    return FIDO_OK;
+}
+
 /**
  * @brief Iterate the largeblob array and check if we find an entry that matches the expected key,
  *        uncompress the data if we find an entry.
@@ -373,31 +487,39 @@ static int largeblob_array_lookup(cb0r_t value, void* data) {
         return FIDO_OK;
     }
 
-    cb0r_s map;
-    if (!cb0r_read(value->start, value->end - value->start, &map) || map.type != CB0R_MAP) {
-        return FIDO_ERR_CBOR_UNEXPECTED_TYPE;
-    }
-
     int r;
-    if((r = cbor_iter_map(&map, largeblob_parse_array_entry, (void*) &entry)) != FIDO_OK) {
+    if((r = largeblob_read_array_entry(value, &entry)) != FIDO_OK) {
         return r;
     }
 
-    if(fido_aes_gcm_decrypt == NULL) {
-        return FIDO_ERR_INTERNAL;
+    if(!largeblob_array_entry_is_complete(&entry)) {
+        // Malformed entry. Ignore it.
+        return FIDO_OK;
     }
 
-    if(fido_aes_gcm_decrypt(param->key, LARGEBLOB_KEY_SIZE,
-        entry.nonce, LARGEBLOB_NONCE_SIZE,
-        entry.ciphertext, entry.ciphertext_len,
-        entry.associated_data, sizeof(entry.associated_data),
-        entry.tag,
-        entry.ciphertext /* Decrypt in-place */) != 0) {
-            // Decryption failed. Ignore this entry.
-            return FIDO_OK;
-        }
+    FIDO_STATS_START(param->dev, decrypt_start);
+    r = largeblob_array_entry_decrypt(param->key, &entry, entry.ciphertext /* Decrypt in-place */);
+    FIDO_STATS_STOP(param->dev, FIDO_DEV_STATS_LARGEBLOB_DECRYPT, decrypt_start);
+    FIDO_STATS_INC(param->dev, largeblob_decrypts);
+    if(r != FIDO_OK) {
+        // Decryption failed. Ignore this entry, unless decryption is not possible at all.
+        return r == FIDO_ERR_INTERNAL ? r : FIDO_OK;
+    }
 
-    if((r = fido_uncompress(param->result, entry.ciphertext, entry.ciphertext_len, entry.origSize)) != FIDO_OK) {
+    if(param->stream != NULL) {
+        // The tag matched, so this is the entry we are looking for. As parts of it may already
+        // have been passed to the output, errors are not ignored and no other entry is tried.
+        param->success = true;
+        FIDO_STATS_START(param->dev, inflate_start);
+        r = fido_uncompress_stream(param->stream, entry.ciphertext, entry.ciphertext_len, entry.origSize);
+        FIDO_STATS_STOP(param->dev, FIDO_DEV_STATS_LARGEBLOB_INFLATE, inflate_start);
+        return r;
+    }
+
+    FIDO_STATS_START(param->dev, inflate_start);
+    r = fido_uncompress(param->result, entry.ciphertext, entry.ciphertext_len, entry.origSize, param->tables);
+    FIDO_STATS_STOP(param->dev, FIDO_DEV_STATS_LARGEBLOB_INFLATE, inflate_start);
+    if(r != FIDO_OK) {
         // Decompression failed. Ignore this entry.
         return FIDO_OK;
     }
@@ -406,46 +528,507 @@ static int largeblob_array_lookup(cb0r_t value, void* data) {
     return FIDO_OK;
 }
 
-int fido_dev_largeblob_get(fido_dev_t *dev, uint8_t *key, size_t key_len, fido_blob_t *blob) {
-    fido_blob_t largeblob_array;
-    uint8_t largeblob_array_buffer[dev->maxlargeblob];
+/**
+ * @brief Overwrite a buffer that contained plaintext, without the compiler optimizing it away.
+ *
+ * @param buffer The buffer to clear.
+ * @param length The length of the buffer.
+ */
+static void largeblob_wipe(uint8_t *buffer, size_t length) {
+    volatile uint8_t *wipe = buffer;
+    for(size_t i = 0; i < length; i++) {
+        wipe[i] = 0;
+    }
+}
+
+void fido_largeblob_index_reset(fido_largeblob_index_t *index, fido_largeblob_entry_t *entries, size_t max_entries, uint8_t *scratch, size_t scratch_len) {
+    index->array = NULL;
+    index->entries = entries;
+    index->max_count = max_entries;
+    index->count = 0;
+    index->max_ciphertext_len = 0;
+    index->scratch = scratch;
+    index->scratch_len = scratch != NULL ? scratch_len : 0;
+    index->inflate_tables = NULL;
+}
+
+void fido_largeblob_index_set_inflate_tables(fido_largeblob_index_t *index, fido_inflate_tables_t *tables) {
+    index->inflate_tables = tables;
+}
+
+/**
+ * @brief Add an element of the largeblob array to the index. Malformed entries are skipped.
+ *
+ * @param value The CBOR encoded value.
+ * @param data The index to add the entry to.
+ * @return int FIDO_OK if the operation was successful.
+ */
+static int largeblob_index_add_entry(cb0r_t value, void *data) {
+    fido_largeblob_index_t *index = (fido_largeblob_index_t*) data;
+    largeblob_array_entry_t entry;
+
+    int r;
+    if((r = largeblob_read_array_entry(value, &entry)) != FIDO_OK) {
+        return r;
+    }
+    if(!largeblob_array_entry_is_complete(&entry)) {
+        return FIDO_OK;
+    }
+    if(index->count >= index->max_count) {
+        return FIDO_ERR_BUFFER_TOO_SHORT;
+    }
+    if(entry.ciphertext_len > UINT32_MAX) {
+        return FIDO_ERR_INVALID_ARGUMENT;
+    }
+    if(entry.ciphertext_len > index->scratch_len) {
+        return FIDO_ERR_BUFFER_TOO_SHORT;
+    }
+
+    fido_largeblob_entry_t *descriptor = &index->entries[index->count++];
+    descriptor->ciphertext_offset = (uint32_t) (entry.ciphertext - index->array);
+    descriptor->ciphertext_len = (uint32_t) entry.ciphertext_len;
+    descriptor->nonce_offset = (uint32_t) (entry.nonce - index->array);
+    descriptor->orig_size = entry.origSize;
+
+    if(entry.ciphertext_len > index->max_ciphertext_len) {
+        index->max_ciphertext_len = entry.ciphertext_len;
+    }
+    return FIDO_OK;
+}
+
+int fido_largeblob_index_build(fido_largeblob_index_t *index, const fido_blob_t *largeblob_array) {
+    if (index == NULL || largeblob_array == NULL || largeblob_array->length > UINT32_MAX) {
+        return FIDO_ERR_INVALID_ARGUMENT;
+    }
+
+    index->array = largeblob_array->buffer;
+    index->count = 0;
+    index->max_ciphertext_len = 0;
+
+    cb0r_s array;
+    int r;
+    FIDO_TRACE_BEGIN(FIDO_TRACE_CBOR, largeblob_array->length);
+    if (!cb0r_read(largeblob_array->buffer, largeblob_array->length, &array) || array.type != CB0R_ARRAY) {
+        r = FIDO_ERR_CBOR_UNEXPECTED_TYPE;
+    } else {
+        r = cbor_iter_array(&array, largeblob_index_add_entry, index);
+    }
+    FIDO_TRACE_END(FIDO_TRACE_CBOR, largeblob_array->length);
+
+    return r;
+}
+
+/**
+ * @brief Expand an entry descriptor of the index, so that it can be decrypted.
+ *
+ * @param index The index.
+ * @param i The number of the entry in the index.
+ * @param entry The entry to fill.
+ */
+static void largeblob_index_get_entry(const fido_largeblob_index_t *index, size_t i, largeblob_array_entry_t *entry) {
+    const fido_largeblob_entry_t *descriptor = &index->entries[i];
+    entry->ciphertext = index->array + descriptor->ciphertext_offset;
+    entry->ciphertext_len = descriptor->ciphertext_len;
+    entry->tag = entry->ciphertext + entry->ciphertext_len;
+    entry->nonce = index->array + descriptor->nonce_offset;
+    largeblob_set_associated_data(entry, descriptor->orig_size);
+}
+
+#ifdef FIDO_PARALLEL_LARGEBLOB
+/**
+ * Number of worker threads for trial decryption. 0 uses the number of online processors.
+ */
+#ifndef FIDO_LARGEBLOB_THREADS
+#define FIDO_LARGEBLOB_THREADS 0
+#endif
+
+/**
+ * Upper bound for the number of worker threads, as the thread handles live on the stack.
+ */
+#ifndef FIDO_LARGEBLOB_MAX_THREADS
+#define FIDO_LARGEBLOB_MAX_THREADS 16
+#endif
+
+/**
+ * Indexes with less entries are searched sequentially, as spawning threads would cost more than it saves.
+ */
+#ifndef FIDO_LARGEBLOB_PARALLEL_MIN_ENTRIES
+#define FIDO_LARGEBLOB_PARALLEL_MIN_ENTRIES 4
+#endif
+
+/**
+ * Size of the scratch buffer of fido_dev_largeblob_get for decrypting entries in parallel, on the stack.
+ * The threads are limited to the number of largest ciphertexts that fit, with none, the search is sequential.
+ */
+#ifndef FIDO_LARGEBLOB_PARALLEL_SCRATCH_SIZE
+#define FIDO_LARGEBLOB_PARALLEL_SCRATCH_SIZE 32768
+#endif
+
+/**
+ * Number of entry descriptors of fido_dev_largeblob_get for decrypting entries in parallel, on the stack.
+ * Arrays with more entries are searched sequentially.
+ */
+#ifndef FIDO_LARGEBLOB_PARALLEL_MAX_ENTRIES
+#define FIDO_LARGEBLOB_PARALLEL_MAX_ENTRIES 256
+#endif
+
+typedef struct largeblob_parallel_search {
+    const fido_largeblob_index_t *index;
+    const uint8_t *key;
+    size_t slots; // Next part of the scratch buffer to be claimed by a worker. Accessed atomically.
+    size_t next;  // Next entry to be claimed by a worker. Accessed atomically.
+    size_t found; // Lowest number of an entry that could be decrypted. Accessed atomically.
+    size_t decrypts; // Entries tried by all workers. Accessed atomically.
+    int error;    // Accessed atomically.
+} largeblob_parallel_search_t;
+
+/**
+ * @brief Claim entries of the index one by one and try to decrypt them with the key.
+ *        The plaintext is written to a private part of the scratch buffer, so the array itself is not modified.
+ *        Workers stop as soon as all entries before the lowest match have been tried.
+ *
+ * @param data The shared search state.
+ * @return void* Always NULL.
+ */
+static void *largeblob_parallel_worker(void *data) {
+    largeblob_parallel_search_t *search = (largeblob_parallel_search_t*) data;
+    const fido_largeblob_index_t *index = search->index;
+    const size_t slot = __atomic_fetch_add(&search->slots, 1, __ATOMIC_RELAXED);
+    uint8_t *scratch = index->scratch + slot * index->max_ciphertext_len;
+    largeblob_array_entry_t entry;
+    size_t decrypts = 0;
+
+    for(;;) {
+        size_t i = __atomic_fetch_add(&search->next, 1, __ATOMIC_RELAXED);
+        if(i >= index->count || i > __atomic_load_n(&search->found, __ATOMIC_ACQUIRE)) {
+            break;
+        }
+
+        largeblob_index_get_entry(index, i, &entry);
+        int r = largeblob_array_entry_decrypt(search->key, &entry, scratch);
+        decrypts++;
+        if(r == FIDO_ERR_INTERNAL) {
+            __atomic_store_n(&search->error, r, __ATOMIC_RELEASE);
+            break;
+        }
+        if(r != FIDO_OK) {
+            continue;
+        }
+
+        size_t found = __atomic_load_n(&search->found, __ATOMIC_ACQUIRE);
+        while(i < found &&
+              !__atomic_compare_exchange_n(&search->found, &found, i, false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+        }
+    }
+
+    // Do not leave plaintext behind.
+    largeblob_wipe(scratch, index->max_ciphertext_len);
+    __atomic_fetch_add(&search->decrypts, decrypts, __ATOMIC_RELAXED);
+    return NULL;
+}
+
+/**
+ * @brief Determine how many threads to use for searching an index.
+ *
+ * @param index The index.
+ * @return size_t The number of threads, including the calling thread.
+ */
+static size_t largeblob_parallel_thread_count(const fido_largeblob_index_t *index) {
+    const size_t slot_count = index->max_ciphertext_len > 0 ? index->scratch_len / index->max_ciphertext_len : index->count;
+    long threads = FIDO_LARGEBLOB_THREADS;
+    if(threads <= 0) {
+        threads = sysconf(_SC_NPROCESSORS_ONLN);
+    }
+    if(threads < 1) {
+        threads = 1;
+    }
+    if((size_t) threads > FIDO_LARGEBLOB_MAX_THREADS) {
+        threads = FIDO_LARGEBLOB_MAX_THREADS;
+    }
+    if((size_t) threads > index->count) {
+        threads = index->count;
+    }
+    if((size_t) threads > slot_count) {
+        threads = slot_count;
+    }
+    return (size_t) threads;
+}
+
+/**
+ * @brief Find the first entry of the index that can be decrypted with the key, trying multiple entries in parallel.
+ *
+ * @param index The index to search.
+ * @param key The largeblob key.
+ * @param found Pointer to store the number of the first matching entry to, or index->count if none matched.
+ * @param decrypts Pointer to store the number of entries tried to.
+ * @return int FIDO_OK if the search could be performed.
+ */
+static int largeblob_index_search_parallel(const fido_largeblob_index_t *index, const uint8_t *key, size_t *found, size_t *decrypts) {
+    largeblob_parallel_search_t search = {
+        .index = index,
+        .key = key,
+        .slots = 0,
+        .next = 0,
+        .found = index->count,
+        .decrypts = 0,
+        .error = FIDO_OK,
+    };
+
+    size_t thread_count = largeblob_parallel_thread_count(index);
+    pthread_t threads[FIDO_LARGEBLOB_MAX_THREADS];
+    size_t started = 0;
+    for(; started + 1 < thread_count; started++) {
+        if(pthread_create(&threads[started], NULL, largeblob_parallel_worker, &search) != 0) {
+            // Continue with the threads we have, the calling thread works as well.
+            fido_log_debug("%s: pthread_create", __func__);
+            break;
+        }
+    }
+    largeblob_parallel_worker(&search);
+    for(size_t i = 0; i < started; i++) {
+        pthread_join(threads[i], NULL);
+    }
+
+    *found = search.found;
+    *decrypts = search.decrypts;
+    return search.error;
+}
+#endif
+
+/**
+ * @brief Find the first entry of the index that can be decrypted with the key and uncompress it.
+ *
+ * @param index The index to search.
+ * @param key The largeblob key, 32 bytes.
+ * @param blob The buffer for the uncompressed data.
+ * @param dev The device to count the decryptions and their time for, may be NULL.
+ * @return int FIDO_OK if the entry was found and uncompressed.
+ */
+static int largeblob_index_lookup(const fido_largeblob_index_t *index, const uint8_t *key, fido_blob_t *blob, fido_dev_t *dev) {
+    size_t start = 0;
+    size_t decrypts = 0;
+    int r;
+
+#ifdef FIDO_PARALLEL_LARGEBLOB
+    if (index->count >= FIDO_LARGEBLOB_PARALLEL_MIN_ENTRIES) {
+        // The entries are decrypted by multiple threads, so only the total time is measured.
+        FIDO_STATS_START(dev, search_start);
+        r = largeblob_index_search_parallel(index, key, &start, &decrypts);
+        FIDO_STATS_STOP(dev, FIDO_DEV_STATS_LARGEBLOB_DECRYPT, search_start);
+        if (r != FIDO_OK) {
+            if (dev != NULL) {
+                FIDO_STATS_ADD(dev, largeblob_decrypts, decrypts);
+            }
+            return r;
+        }
+    }
+#endif
+
+    // Decrypt out of place, so that the index can be used with other keys afterwards.
+    uint8_t *plaintext = index->scratch;
+    largeblob_array_entry_t entry;
+
+    r = FIDO_ERR_NOTFOUND;
+    for (size_t i = start; i < index->count; i++) {
+        largeblob_index_get_entry(index, i, &entry);
+        FIDO_STATS_START(dev, decrypt_start);
+        int decrypt_r = largeblob_array_entry_decrypt(key, &entry, plaintext);
+        FIDO_STATS_STOP(dev, FIDO_DEV_STATS_LARGEBLOB_DECRYPT, decrypt_start);
+        decrypts++;
+        if (decrypt_r == FIDO_ERR_INTERNAL) {
+            r = decrypt_r;
+            break;
+        }
+        if (decrypt_r != FIDO_OK) {
+            continue;
+        }
+        FIDO_STATS_START(dev, inflate_start);
+        int inflate_r = fido_uncompress(blob, plaintext, entry.ciphertext_len, entry.origSize, index->inflate_tables);
+        FIDO_STATS_STOP(dev, FIDO_DEV_STATS_LARGEBLOB_INFLATE, inflate_start);
+        if (inflate_r == FIDO_OK) {
+            r = FIDO_OK;
+            break;
+        }
+    }
 
+    largeblob_wipe(plaintext, index->max_ciphertext_len);
+    if (dev != NULL) {
+        FIDO_STATS_ADD(dev, largeblob_decrypts, decrypts);
+    }
+    return r;
+}
+
+int fido_largeblob_index_find(const fido_largeblob_index_t *index, const uint8_t *key, size_t key_len, fido_blob_t *blob) {
     if (key_len != LARGEBLOB_KEY_SIZE) {
         fido_log_debug("%s: invalid key len %zu", __func__, key_len);
         return FIDO_ERR_INVALID_ARGUMENT;
     }
 
-    if (blob == NULL) {
-        fido_log_debug("%s: invalid blob_ptr=%p, blob_len=%p", __func__,
-            (const void *)blob_ptr, (const void *)blob_len);
+    if (index == NULL || key == NULL || blob == NULL) {
         return FIDO_ERR_INVALID_ARGUMENT;
     }
 
-    fido_blob_reset(&largeblob_array, largeblob_array_buffer, sizeof(largeblob_array_buffer));
+    return largeblob_index_lookup(index, key, blob, NULL);
+}
+
+void fido_dev_set_largeblob_prefetch(fido_dev_t *dev, uint8_t *buffer, size_t buffer_len) {
+    dev->largeblob_prefetch = buffer;
+    dev->largeblob_prefetch_size = buffer != NULL ? buffer_len : 0;
+    dev->largeblob_prefetch_len = 0;
+}
+
+int fido_dev_largeblob_prefetch(fido_dev_t *dev) {
+    fido_blob_t largeblob_array;
+
+    if (dev->largeblob_prefetch == NULL) {
+        return FIDO_ERR_INVALID_ARGUMENT;
+    }
+
+    dev->largeblob_prefetch_len = 0;
+    fido_blob_reset(&largeblob_array, dev->largeblob_prefetch, dev->largeblob_prefetch_size);
 
     int r;
     if ((r = fido_dev_largeblob_get_array(dev, &largeblob_array)) != FIDO_OK) {
         fido_log_debug("%s: largeblob_get_array", __func__);
         return r;
     }
+    dev->largeblob_prefetch_len = largeblob_array.length;
+    return FIDO_OK;
+}
 
+#ifdef FIDO_PARALLEL_LARGEBLOB
+/**
+ * @brief Index a large-blob array and look up the entry that matches the key with multiple threads.
+ *        Kept out of largeblob_lookup, so that the buffers are only on the stack when used.
+ *
+ * @param dev The device the array was read from.
+ * @param largeblob_array The serialized large-blob array, with at most FIDO_LARGEBLOB_PARALLEL_MAX_ENTRIES entries.
+ * @param key The AES key to use for decryption, 32 bytes.
+ * @param param The lookup parameters, determining where the data goes.
+ * @return int FIDO_OK if the entry was found and uncompressed, FIDO_ERR_BUFFER_TOO_SHORT if the array does not fit.
+ */
+static __attribute__((noinline)) int largeblob_lookup_parallel(fido_dev_t *dev, const fido_blob_t *largeblob_array, const uint8_t *key, largeblob_array_lookup_param_t *param) {
+    fido_largeblob_entry_t entries[FIDO_LARGEBLOB_PARALLEL_MAX_ENTRIES];
+    uint8_t scratch[FIDO_LARGEBLOB_PARALLEL_SCRATCH_SIZE];
+    fido_largeblob_index_t index;
+    fido_largeblob_index_reset(&index, entries, FIDO_LARGEBLOB_PARALLEL_MAX_ENTRIES, scratch, sizeof(scratch));
+    fido_largeblob_index_set_inflate_tables(&index, param->tables);
+
+    int r;
+    if ((r = fido_largeblob_index_build(&index, largeblob_array)) != FIDO_OK) {
+        return r;
+    }
+    return largeblob_index_lookup(&index, key, param->result, dev);
+}
+#endif
+
+/**
+ * @brief Look up the entry that matches the key in a large-blob array.
+ *
+ * @param dev The device the array was read from.
+ * @param largeblob_array The serialized large-blob array.
+ * @param key The AES key to use for decryption, 32 bytes.
+ * @param param The lookup parameters, determining where the data goes.
+ * @return int FIDO_OK if the entry was found and uncompressed.
+ */
+static int largeblob_lookup(fido_dev_t *dev, const fido_blob_t *largeblob_array, uint8_t *key, largeblob_array_lookup_param_t *param) {
+    int r;
     cb0r_s array;
-    if (!cb0r_read(largeblob_array.buffer, largeblob_array.length, &array) || array.type != CB0R_ARRAY) {
+    if (!cb0r_read(largeblob_array->buffer, largeblob_array->length, &array) || array.type != CB0R_ARRAY) {
         return FIDO_ERR_CBOR_UNEXPECTED_TYPE;
     }
 
-    largeblob_array_lookup_param_t param = {
-        .result = blob,
-        .key = key,
-        .success = false,
-    };
+#ifdef FIDO_PARALLEL_LARGEBLOB
+    if (param->stream == NULL && array.count >= FIDO_LARGEBLOB_PARALLEL_MIN_ENTRIES &&
+        array.count <= FIDO_LARGEBLOB_PARALLEL_MAX_ENTRIES) {
+        // If a ciphertext does not fit into the scratch buffer, the entries are decrypted in place below.
+        if ((r = largeblob_lookup_parallel(dev, largeblob_array, key, param)) != FIDO_ERR_BUFFER_TOO_SHORT) {
+            return r;
+        }
+    }
+#endif
+
+    param->key = key;
+    param->dev = dev;
+    param->success = false;
 
-    if ((r = cbor_iter_array(&array, largeblob_array_lookup, &param)) != FIDO_OK) {
+    if ((r = cbor_iter_array(&array, largeblob_array_lookup, param)) != FIDO_OK) {
         return r;
     }
-    if (!param.success) {
+    if (!param->success) {
         return FIDO_ERR_NOTFOUND;
     }
 
     return FIDO_OK;
 }
+
+/**
+ * @brief Read the largeblob array, unless it was prefetched, and look up the entry that matches the key.
+ *
+ * @param dev The device to read from.
+ * @param key The AES key to use for decryption.
+ * @param key_len The length of the AES key. Must be 32 byte.
+ * @param param The lookup parameters, determining where the data goes.
+ * @return int FIDO_OK if the entry was found and uncompressed.
+ */
+static int largeblob_get(fido_dev_t *dev, uint8_t *key, size_t key_len, largeblob_array_lookup_param_t *param) {
+    fido_blob_t largeblob_array;
+
+    if (key_len != LARGEBLOB_KEY_SIZE) {
+        fido_log_debug("%s: invalid key len %zu", __func__, key_len);
+        return FIDO_ERR_INVALID_ARGUMENT;
+    }
+
+    if (dev->largeblob_prefetch_len != 0) {
+        FIDO_STATS_INC(dev, cache_hits);
+        fido_blob_reset(&largeblob_array, dev->largeblob_prefetch, dev->largeblob_prefetch_size);
+        largeblob_array.length = dev->largeblob_prefetch_len;
+        // The entries are decrypted in place, so the array can only be used once.
+        dev->largeblob_prefetch_len = 0;
+        return largeblob_lookup(dev, &largeblob_array, key, param);
+    }
+
+    uint8_t largeblob_array_buffer[dev->maxlargeblob];
+    fido_blob_reset(&largeblob_array, largeblob_array_buffer, sizeof(largeblob_array_buffer));
+
+    int r;
+    if ((r = fido_dev_largeblob_get_array(dev, &largeblob_array)) != FIDO_OK) {
+        fido_log_debug("%s: largeblob_get_array", __func__);
+        return r;
+    }
+    return largeblob_lookup(dev, &largeblob_array, key, param);
+}
+
+int fido_dev_largeblob_get(fido_dev_t *dev, uint8_t *key, size_t key_len, fido_blob_t *blob) {
+    if (blob == NULL) {
+        fido_log_debug("%s: invalid blob_ptr=%p, blob_len=%p", __func__,
+            (const void *)blob_ptr, (const void *)blob_len);
+        return FIDO_ERR_INVALID_ARGUMENT;
+    }
+
+    largeblob_array_lookup_param_t param = {
+        .result = blob,
+        .stream = NULL,
+        .tables = dev->inflate_tables,
+    };
+    return largeblob_get(dev, key, key_len, &param);
+}
+
+int fido_dev_largeblob_get_stream(fido_dev_t *dev, uint8_t *key, size_t key_len, uint8_t *window, size_t window_len, fido_inflate_output_t output, void *output_ctx) {
+    if (window == NULL || window_len == 0 || output == NULL) {
+        return FIDO_ERR_INVALID_ARGUMENT;
+    }
+
+    fido_inflate_t stream;
+    fido_inflate_init(&stream, window, window_len, output, output_ctx);
+    fido_inflate_set_tables(&stream, dev->inflate_tables);
+
+    largeblob_array_lookup_param_t param = {
+        .result = NULL,
+        .stream = &stream,
+        .tables = dev->inflate_tables,
+    };
+    return largeblob_get(dev, key, key_len, &param);
+}
+
+#endif
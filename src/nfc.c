@@ -40,8 +40,16 @@ static int rx_init(fido_dev_t *dev, unsigned char *buf, const size_t len)
 
     memset(attr, 0, sizeof(*attr));
 
-    if ((n = dev->io.read(dev->io_handle, f, sizeof(f))) < 2 ||
-        (f[n - 2] << 8 | f[n - 1]) != SW_NO_ERROR) {
+    FIDO_TRACE_BEGIN(FIDO_TRACE_APDU_RX, 0);
+    n = FIDO_IO_READ(dev, f, sizeof(f));
+    FIDO_TRACE_END(FIDO_TRACE_APDU_RX, n < 0 ? 0 : n);
+
+    if (n >= 0) {
+        FIDO_STATS_INC(dev, apdus_rx);
+        FIDO_STATS_ADD(dev, bytes_rx, n);
+    }
+
+    if (n < 2 || (f[n - 2] << 8 | f[n - 1]) != SW_NO_ERROR) {
         fido_log_debug("%s: read", __func__);
         return FIDO_ERR_RX;
     }
@@ -49,8 +57,14 @@ static int rx_init(fido_dev_t *dev, unsigned char *buf, const size_t len)
     n -= 2;
 
     if (n == (sizeof(fido_version_u2f) - 1) && memcmp_progmem(f, fido_version_u2f, (sizeof(fido_version_u2f) - 1)) == 0) {
+#ifndef FIDO_NO_U2F
+        // Not FIDO_2_0, so use the device with U2F and skip the authenticatorGetInfo round trip.
+        attr->flags = 0;
+#else
+        // Devices with both U2F and CTAP2 answer U2F_V2 as well, so try CTAP2.
         attr->flags = FIDO_CAP_CBOR;
-    } else if (n == sizeof(fido_version_fido2) && memcmp_progmem(f, fido_version_fido2, (sizeof(fido_version_fido2) - 1)) == 0) {
+#endif
+    } else if (n == (sizeof(fido_version_fido2) - 1) && memcmp_progmem(f, fido_version_fido2, (sizeof(fido_version_fido2) - 1)) == 0) {
         attr->flags = FIDO_CAP_CBOR | FIDO_CAP_NMSG;
     } else {
         fido_log_debug("%s: unknown version string", __func__);
@@ -75,7 +89,16 @@ static int rx_apdu(fido_dev_t *dev, uint8_t sw[2], unsigned char **buf, size_t *
     uint8_t f[256 + 2];
     int n, ok = -1;
 
-    if ((n = dev->io.read(dev->io_handle, f, sizeof(f))) < 2) {
+    FIDO_TRACE_BEGIN(FIDO_TRACE_APDU_RX, 0);
+    n = FIDO_IO_READ(dev, f, sizeof(f));
+    FIDO_TRACE_END(FIDO_TRACE_APDU_RX, n < 0 ? 0 : n);
+
+    if (n >= 0) {
+        FIDO_STATS_INC(dev, apdus_rx);
+        FIDO_STATS_ADD(dev, bytes_rx, n);
+    }
+
+    if (n < 2) {
         fido_log_debug("%s: read", __func__);
         goto fail;
     }
@@ -104,16 +127,25 @@ fail:
 static int tx_get_response(fido_dev_t *dev, uint8_t count)
 {
     uint8_t apdu[5];
+    int n;
 
     memset(apdu, 0, sizeof(apdu));
     apdu[1] = 0xc0; /* GET_RESPONSE */
     apdu[4] = count;
 
-    if (dev->io.write(dev->io_handle, apdu, sizeof(apdu)) < 0) {
+    FIDO_TRACE_BEGIN(FIDO_TRACE_APDU_TX, sizeof(apdu));
+    n = FIDO_IO_WRITE(dev, apdu, sizeof(apdu));
+    FIDO_TRACE_END(FIDO_TRACE_APDU_TX, sizeof(apdu));
+
+    if (n < 0) {
         fido_log_debug("%s: write", __func__);
         return FIDO_ERR_TX;
     }
 
+    FIDO_STATS_INC(dev, apdus_tx);
+    FIDO_STATS_INC(dev, get_responses);
+    FIDO_STATS_ADD(dev, bytes_tx, sizeof(apdu));
+
     return FIDO_OK;
 }
 
@@ -185,7 +217,7 @@ static int rx_cbor(fido_dev_t *dev, unsigned char *buf, const size_t count) {
  * @param len The length of the buffer.
  * @return int FIDO_OK if the operation was successful.
  */
-static int nfc_rx(struct fido_dev *dev, const uint8_t cmd, unsigned char *buf, const size_t len) {
+int fido_nfc_rx(fido_dev_t *dev, const uint8_t cmd, unsigned char *buf, const size_t len) {
     switch (cmd) {
     case CTAP_CMD_INIT:
         return rx_init(dev, buf, len);
@@ -232,16 +264,23 @@ static int tx_short_apdu(
     memcpy(&apdu[5], payload, payload_len);
     apdu_len = (size_t)(5 + payload_len);
 
-    if (dev->io.write(dev->io_handle, apdu, apdu_len) < 0) {
+    FIDO_TRACE_BEGIN(FIDO_TRACE_APDU_TX, apdu_len);
+    if (FIDO_IO_WRITE(dev, apdu, apdu_len) < 0) {
         fido_log_debug("%s: write", __func__);
         goto fail;
     }
 
+    FIDO_STATS_INC(dev, apdus_tx);
+    FIDO_STATS_ADD(dev, bytes_tx, apdu_len);
+
     if (cla_flags & CLA_CHAIN_CONTINUE) {
-        if (dev->io.read(dev->io_handle, status_word, sizeof(status_word)) != 2) {
+        FIDO_STATS_INC(dev, chain_segments);
+        if (FIDO_IO_READ(dev, status_word, sizeof(status_word)) != 2) {
             fido_log_debug("%s: read", __func__);
             goto fail;
         }
+        FIDO_STATS_INC(dev, apdus_rx);
+        FIDO_STATS_ADD(dev, bytes_rx, sizeof(status_word));
         if ((status_word[0] << 8 | status_word[1]) != SW_NO_ERROR) {
             fido_log_debug("%s: unexpected status word", __func__);
             goto fail;
@@ -250,6 +289,7 @@ static int tx_short_apdu(
 
     ok = FIDO_OK;
 fail:
+    FIDO_TRACE_END(FIDO_TRACE_APDU_TX, apdu_len);
     memset(apdu, 0, sizeof(apdu));
 
     return ok;
@@ -293,7 +333,7 @@ static int nfc_do_tx(fido_dev_t *dev, const iso7816_apdu_t *apdu) {
  * @param len The length of the payload.
  * @return int FIDO_OK if the operation was successful.
  */
-static int nfc_tx(struct fido_dev *dev, const uint8_t cmd, const unsigned char *buf, const size_t len) {
+int fido_nfc_tx(fido_dev_t *dev, const uint8_t cmd, const unsigned char *buf, const size_t len) {
     iso7816_apdu_t apdu;
     int status = FIDO_ERR_TX;
 
@@ -324,8 +364,8 @@ fail:
 }
 
 static const fido_dev_transport_t nfc_transport = {
-    .rx = nfc_rx,
-    .tx = nfc_tx,
+    .rx = fido_nfc_rx,
+    .tx = fido_nfc_tx,
 };
 
 int fido_init_nfc_device(fido_dev_t *dev, const fido_dev_io_t *io) {
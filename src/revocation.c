@@ -0,0 +1,140 @@
+/*
+ * Copyright (c) 2022 Felix Gohla, Konrad Hanff, Tobias Kantusch,
+ *                    Quentin Kuth, Felix Roth. All rights reserved.
+ *
+ * Use of this source code is governed by a BSD-style
+ * license that can be found in the LICENSE file.
+ */
+
+#include "fido.h"
+#include "utils.h"
+
+#include <string.h>
+
+#ifndef FIDO_NO_REVOCATION
+
+static const uint8_t revocation_magic[] PROGMEM_MARKER = "FRV1";
+
+#define REVOCATION_BLOCK_BITS (FIDO_REVOCATION_BLOCK_SIZE * 8)
+
+int fido_revocation_init(fido_revocation_t *revocation, const uint8_t *image, size_t image_len, uint32_t min_version, const uint8_t *updater_public_key) {
+    if (image_len < FIDO_REVOCATION_HEADER_SIZE + FIDO_REVOCATION_SIGNATURE_SIZE) {
+        return FIDO_ERR_INVALID_ARGUMENT;
+    }
+    if (!fido_buf_has_magic_progmem(image, revocation_magic, sizeof(revocation_magic) - 1)) {
+        fido_log_debug("%s: magic", __func__);
+        return FIDO_ERR_INVALID_ARGUMENT;
+    }
+
+    const size_t key_count = fido_buf_read_le_progmem(image + 8, 4);
+    const size_t block_count = fido_buf_read_le_progmem(image + 12, 4);
+    const uint8_t hash_count = read_progmem_byte(image + 16);
+    const size_t available = image_len - FIDO_REVOCATION_HEADER_SIZE - FIDO_REVOCATION_SIGNATURE_SIZE;
+
+    if (block_count == 0 || (block_count & (block_count - 1)) != 0 || hash_count == 0 || hash_count > FIDO_REVOCATION_MAX_HASHES ||
+        block_count > available / FIDO_REVOCATION_BLOCK_SIZE ||
+        key_count != (available - block_count * FIDO_REVOCATION_BLOCK_SIZE) / FIDO_REVOCATION_KEY_SIZE ||
+        (available - block_count * FIDO_REVOCATION_BLOCK_SIZE) % FIDO_REVOCATION_KEY_SIZE != 0) {
+        fido_log_debug("%s: sizes", __func__);
+        return FIDO_ERR_INVALID_ARGUMENT;
+    }
+
+    // An older list, e.g. one that still lacks recently revoked keys, must not replace a newer one.
+    const uint32_t version = fido_buf_read_le_progmem(image + 4, 4);
+    if (version < min_version) {
+        fido_log_debug("%s: version", __func__);
+        return FIDO_ERR_INVALID_ARGUMENT;
+    }
+
+    if (updater_public_key != NULL) {
+        const size_t signed_len = image_len - FIDO_REVOCATION_SIGNATURE_SIZE;
+        if (!FIDO_CRYPTO_IS_SET(ed25519_verify)) {
+            return FIDO_ERR_INTERNAL;
+        }
+        FIDO_TRACE_BEGIN(FIDO_TRACE_VERIFY, COSE_ALGORITHM_EdDSA);
+        int r = FIDO_CRYPTO_CALL(ed25519_verify)(image + signed_len, updater_public_key, image, signed_len);
+        FIDO_TRACE_END(FIDO_TRACE_VERIFY, COSE_ALGORITHM_EdDSA);
+        if (r != 0) {
+            fido_log_debug("%s: signature", __func__);
+            return FIDO_ERR_INVALID_SIG;
+        }
+    }
+
+    revocation->salt = image + 20;
+    revocation->blocks = image + FIDO_REVOCATION_HEADER_SIZE;
+    revocation->keys = revocation->blocks + block_count * FIDO_REVOCATION_BLOCK_SIZE;
+    revocation->block_mask = block_count - 1;
+    revocation->key_count = key_count;
+    revocation->hash_count = hash_count;
+    revocation->version = version;
+    return FIDO_OK;
+}
+
+/**
+ * @brief Search the sorted revoked keys for a key.
+ *
+ * @param revocation The revocation list.
+ * @param public_key The public key (32 bytes).
+ * @return bool true if the key is revoked.
+ */
+static bool revocation_find_key(const fido_revocation_t *revocation, const uint8_t *public_key) {
+    size_t low = 0;
+    size_t high = revocation->key_count;
+    while (low < high) {
+        const size_t middle = low + (high - low) / 2;
+        const int c = memcmp_progmem(public_key, revocation->keys + middle * FIDO_REVOCATION_KEY_SIZE, FIDO_REVOCATION_KEY_SIZE);
+        if (c == 0) {
+            return true;
+        } else if (c < 0) {
+            high = middle;
+        } else {
+            low = middle + 1;
+        }
+    }
+    return false;
+}
+
+int fido_revocation_check(const fido_revocation_t *revocation, const uint8_t *public_key) {
+    uint8_t data[FIDO_REVOCATION_SALT_SIZE + FIDO_REVOCATION_KEY_SIZE];
+    uint8_t hash[SHA256_DIGEST_SIZE];
+
+    if (!FIDO_CRYPTO_IS_SET(sha256)) {
+        return FIDO_ERR_INTERNAL;
+    }
+    for (size_t i = 0; i < FIDO_REVOCATION_SALT_SIZE; i++) {
+        data[i] = read_progmem_byte(revocation->salt + i);
+    }
+    memcpy(data + FIDO_REVOCATION_SALT_SIZE, public_key, FIDO_REVOCATION_KEY_SIZE);
+    FIDO_TRACE_BEGIN(FIDO_TRACE_HASH, sizeof(data));
+    FIDO_CRYPTO_CALL(sha256)(data, sizeof(data), hash);
+    FIDO_TRACE_END(FIDO_TRACE_HASH, sizeof(data));
+
+    // The first 4 bytes of the hash select the block, each following 2 bytes a bit in it.
+    const size_t index = ((uint32_t)hash[0] | (uint32_t)hash[1] << 8 | (uint32_t)hash[2] << 16 | (uint32_t)hash[3] << 24) & revocation->block_mask;
+    const uint8_t *block = revocation->blocks + index * FIDO_REVOCATION_BLOCK_SIZE;
+    uint8_t all_set = 1;
+    for (uint8_t i = 0; i < revocation->hash_count; i++) {
+        const size_t bit = ((size_t)hash[4 + 2 * i] | (size_t)hash[5 + 2 * i] << 8) % REVOCATION_BLOCK_BITS;
+        all_set &= read_progmem_byte(block + bit / 8) >> (bit % 8);
+    }
+
+    if ((all_set & 1) && revocation_find_key(revocation, public_key)) {
+        return FIDO_ERR_REVOKED;
+    }
+    return FIDO_OK;
+}
+
+void fido_dev_set_revocation(fido_dev_t *dev, const fido_revocation_t *revocation) {
+    dev->revocation = revocation;
+}
+
+#endif
+
+int fido_dev_check_revocation(fido_dev_t *dev, const uint8_t *public_key) {
+#ifndef FIDO_NO_REVOCATION
+    if (dev->revocation != NULL) {
+        return fido_revocation_check(dev->revocation, public_key);
+    }
+#endif
+    return FIDO_OK;
+}
@@ -0,0 +1,82 @@
+/*
+ * Copyright (c) 2022 Felix Gohla, Konrad Hanff, Tobias Kantusch,
+ *                    Quentin Kuth, Felix Roth. All rights reserved.
+ *
+ * Use of this source code is governed by a BSD-style
+ * license that can be found in the LICENSE file.
+ */
+
+#include "fido.h"
+
+#include <string.h>
+
+#ifndef FIDO_NO_RP_REGISTRY
+
+/**
+ * @brief Get the first slot to probe for an rpIdHash. As SHA256 output is uniformly distributed,
+ *        its first bytes are used directly.
+ *
+ * @param registry The registry.
+ * @param rp_id_hash The rpIdHash.
+ * @return size_t The index of the slot.
+ */
+static size_t rp_registry_slot(const fido_rp_registry_t *registry, const uint8_t *rp_id_hash) {
+    return ((uint32_t)rp_id_hash[0] << 24 | (uint32_t)rp_id_hash[1] << 16 | (uint32_t)rp_id_hash[2] << 8 | rp_id_hash[3]) & registry->slot_mask;
+}
+
+int fido_rp_registry_init(fido_rp_registry_t *registry, fido_rp_t *rps, size_t max_count, uint16_t *slots, size_t slot_count) {
+    // At least one slot stays empty, so that lookups of unknown RPs terminate.
+    if (max_count > UINT16_MAX || slot_count <= max_count || (slot_count & (slot_count - 1)) != 0) {
+        return FIDO_ERR_INVALID_ARGUMENT;
+    }
+
+    registry->rps = rps;
+    registry->max_count = max_count;
+    registry->count = 0;
+    registry->slots = slots;
+    registry->slot_mask = slot_count - 1;
+    memset(slots, 0, slot_count * sizeof(*slots));
+    return FIDO_OK;
+}
+
+fido_rp_t *fido_rp_registry_add(fido_rp_registry_t *registry, const char *rp_id, int cose_alg, const uint8_t *public_keys, size_t public_key_count) {
+    if (registry->count >= registry->max_count || !FIDO_CRYPTO_IS_SET(sha256)) {
+        return NULL;
+    }
+
+    fido_rp_t *rp = &registry->rps[registry->count];
+    rp->id = rp_id;
+    rp->id_len = strlen(rp_id);
+    FIDO_TRACE_BEGIN(FIDO_TRACE_HASH, rp->id_len);
+    FIDO_CRYPTO_CALL(sha256)((const uint8_t *)rp_id, rp->id_len, rp->id_hash);
+    FIDO_TRACE_END(FIDO_TRACE_HASH, rp->id_len);
+
+    size_t slot = rp_registry_slot(registry, rp->id_hash);
+    while (registry->slots[slot] != 0) {
+        if (memcmp(registry->rps[registry->slots[slot] - 1].id_hash, rp->id_hash, ASSERTION_AUTH_DATA_RPID_HASH_LEN) == 0) {
+            return NULL;
+        }
+        slot = (slot + 1) & registry->slot_mask;
+    }
+
+    rp->cose_alg = cose_alg;
+    rp->public_keys = public_keys;
+    rp->public_key_count = public_key_count;
+    rp->ctx = NULL;
+    registry->slots[slot] = (uint16_t)++registry->count;
+    return rp;
+}
+
+const fido_rp_t *fido_rp_registry_find(const fido_rp_registry_t *registry, const uint8_t *rp_id_hash) {
+    size_t slot = rp_registry_slot(registry, rp_id_hash);
+    while (registry->slots[slot] != 0) {
+        const fido_rp_t *rp = &registry->rps[registry->slots[slot] - 1];
+        if (memcmp(rp->id_hash, rp_id_hash, ASSERTION_AUTH_DATA_RPID_HASH_LEN) == 0) {
+            return rp;
+        }
+        slot = (slot + 1) & registry->slot_mask;
+    }
+    return NULL;
+}
+
+#endif
@@ -0,0 +1,319 @@
+/*
+ * Copyright (c) 2022 Felix Gohla, Konrad Hanff, Tobias Kantusch,
+ *                    Quentin Kuth, Felix Roth. All rights reserved.
+ *
+ * Use of this source code is governed by a BSD-style
+ * license that can be found in the LICENSE file.
+ */
+
+#include "fido.h"
+
+#include <string.h>
+
+#ifndef FIDO_NO_SIGN_COUNT
+
+static const uint8_t sign_count_magic[] = "FSC1";
+
+/**
+ * @brief Write a little endian uint32.
+ *
+ * @param buffer The buffer to write to.
+ * @param value The value to write.
+ */
+static void sign_count_write_le32(uint8_t *buffer, uint32_t value) {
+    buffer[0] = (uint8_t)value;
+    buffer[1] = (uint8_t)(value >> 8);
+    buffer[2] = (uint8_t)(value >> 16);
+    buffer[3] = (uint8_t)(value >> 24);
+}
+
+/**
+ * @brief Read a little endian uint32.
+ *
+ * @param buffer The buffer to read from.
+ * @return uint32_t The value.
+ */
+static uint32_t sign_count_read_le32(const uint8_t *buffer) {
+    return (uint32_t)buffer[0] | (uint32_t)buffer[1] << 8 | (uint32_t)buffer[2] << 16 | (uint32_t)buffer[3] << 24;
+}
+
+/**
+ * @brief Find the slot of a credential hash, or the empty slot to insert it into.
+ *
+ * @param store The store.
+ * @param hash The truncated hash of the credential ID.
+ * @return size_t The index of the slot.
+ */
+static size_t sign_count_slot(const fido_sign_count_store_t *store, const uint8_t *hash) {
+    size_t slot = sign_count_read_le32(hash) & store->slot_mask;
+    while (store->slots[slot] != 0 && memcmp(store->entries[store->slots[slot] - 1].hash, hash, FIDO_SIGN_COUNT_HASH_SIZE) != 0) {
+        slot = (slot + 1) & store->slot_mask;
+    }
+    return slot;
+}
+
+/**
+ * @brief Set the counter of a credential in the index, adding the credential if it is new.
+ *
+ * @param store The store.
+ * @param hash The truncated hash of the credential ID.
+ * @param count The counter.
+ * @return int FIDO_OK, or FIDO_ERR_BUFFER_TOO_SHORT if the index is full.
+ */
+static int sign_count_index_set(fido_sign_count_store_t *store, const uint8_t *hash, uint32_t count) {
+    const size_t slot = sign_count_slot(store, hash);
+    if (store->slots[slot] == 0) {
+        if (store->count >= store->max_count) {
+            return FIDO_ERR_BUFFER_TOO_SHORT;
+        }
+        memcpy(store->entries[store->count].hash, hash, FIDO_SIGN_COUNT_HASH_SIZE);
+        store->slots[slot] = (uint16_t)++store->count;
+    }
+    store->entries[store->slots[slot] - 1].count = count;
+    return FIDO_OK;
+}
+
+/**
+ * @brief Encode a record.
+ *
+ * @param record The buffer of FIDO_SIGN_COUNT_RECORD_SIZE bytes to encode into.
+ * @param entry The counter of a credential.
+ */
+static void sign_count_encode_record(uint8_t *record, const fido_sign_count_entry_t *entry) {
+    memcpy(record, entry->hash, FIDO_SIGN_COUNT_HASH_SIZE);
+    sign_count_write_le32(record + FIDO_SIGN_COUNT_HASH_SIZE, entry->count);
+    sign_count_write_le32(record + FIDO_SIGN_COUNT_HASH_SIZE + 4, ~entry->count);
+}
+
+/**
+ * @brief Check whether a record is erased flash, which ends the records of a page.
+ *
+ * @param record The record of FIDO_SIGN_COUNT_RECORD_SIZE bytes.
+ * @return bool true if all bytes are 0xff.
+ */
+static bool sign_count_is_erased(const uint8_t *record) {
+    uint8_t erased = 0xff;
+    for (size_t i = 0; i < FIDO_SIGN_COUNT_RECORD_SIZE; i++) {
+        erased &= record[i];
+    }
+    return erased == 0xff;
+}
+
+/**
+ * @brief Read the header of a page.
+ *
+ * @param store The store.
+ * @param page The index of the page.
+ * @param sequence A pointer to store the sequence number of the page to.
+ * @return int FIDO_OK if the page has a valid header, FIDO_ERR_NOTFOUND if not, FIDO_ERR_INTERNAL if it cannot be read.
+ */
+static int sign_count_read_header(const fido_sign_count_store_t *store, size_t page, uint32_t *sequence) {
+    const fido_sign_count_flash_t *flash = store->flash;
+    uint8_t header[FIDO_SIGN_COUNT_HEADER_SIZE];
+
+    if (flash->read(flash->ctx, page * flash->page_size, header, sizeof(header)) != 0) {
+        return FIDO_ERR_INTERNAL;
+    }
+    if (memcmp(header, sign_count_magic, sizeof(sign_count_magic) - 1) != 0 ||
+        sign_count_read_le32(header + 4) != (uint32_t)~sign_count_read_le32(header + 8)) {
+        return FIDO_ERR_NOTFOUND;
+    }
+    *sequence = sign_count_read_le32(header + 4);
+    return FIDO_OK;
+}
+
+/**
+ * @brief Erase the next page, write the latest counters to it and make it the active page.
+ *
+ * @param store The store.
+ * @return int FIDO_OK, or FIDO_ERR_INTERNAL if the flash cannot be accessed.
+ */
+static int sign_count_compact(fido_sign_count_store_t *store) {
+    const fido_sign_count_flash_t *flash = store->flash;
+    const size_t page = (store->page + 1) % flash->page_count;
+    const size_t address = page * flash->page_size;
+    uint8_t buffer[FIDO_SIGN_COUNT_RECORD_SIZE];
+
+    if (flash->erase(flash->ctx, address) != 0) {
+        fido_log_debug("%s: erase", __func__);
+        return FIDO_ERR_INTERNAL;
+    }
+    for (size_t i = 0; i < store->count; i++) {
+        sign_count_encode_record(buffer, &store->entries[i]);
+        if (flash->write(flash->ctx, address + FIDO_SIGN_COUNT_HEADER_SIZE + i * FIDO_SIGN_COUNT_RECORD_SIZE, buffer, sizeof(buffer)) != 0) {
+            fido_log_debug("%s: write", __func__);
+            return FIDO_ERR_INTERNAL;
+        }
+    }
+
+    // The page only becomes valid with its header, the previous one stays active until then.
+    memset(buffer, 0xff, sizeof(buffer));
+    memcpy(buffer, sign_count_magic, sizeof(sign_count_magic) - 1);
+    sign_count_write_le32(buffer + 4, store->sequence + 1);
+    sign_count_write_le32(buffer + 8, ~(store->sequence + 1));
+    if (flash->write(flash->ctx, address, buffer, FIDO_SIGN_COUNT_HEADER_SIZE) != 0) {
+        fido_log_debug("%s: write header", __func__);
+        return FIDO_ERR_INTERNAL;
+    }
+
+    store->page = page;
+    store->sequence++;
+    store->write_offset = FIDO_SIGN_COUNT_HEADER_SIZE + store->count * FIDO_SIGN_COUNT_RECORD_SIZE;
+    return FIDO_OK;
+}
+
+/**
+ * @brief Rebuild the index from the records of the active page.
+ *
+ * @param store The store.
+ * @return int FIDO_OK, FIDO_ERR_INVALID_ARGUMENT if there are more credentials than entries,
+ *             or FIDO_ERR_INTERNAL if the flash cannot be read.
+ */
+static int sign_count_load(fido_sign_count_store_t *store) {
+    const fido_sign_count_flash_t *flash = store->flash;
+    const size_t address = store->page * flash->page_size;
+    uint8_t record[FIDO_SIGN_COUNT_RECORD_SIZE];
+
+    store->write_offset = FIDO_SIGN_COUNT_HEADER_SIZE;
+    while (store->write_offset + FIDO_SIGN_COUNT_RECORD_SIZE <= flash->page_size) {
+        if (flash->read(flash->ctx, address + store->write_offset, record, sizeof(record)) != 0) {
+            return FIDO_ERR_INTERNAL;
+        }
+        if (sign_count_is_erased(record)) {
+            break;
+        }
+        store->write_offset += FIDO_SIGN_COUNT_RECORD_SIZE;
+
+        const uint32_t count = sign_count_read_le32(record + FIDO_SIGN_COUNT_HASH_SIZE);
+        if (count != (uint32_t)~sign_count_read_le32(record + FIDO_SIGN_COUNT_HASH_SIZE + 4)) {
+            // A record torn by a power loss or a failed write is skipped, the records after it are still valid.
+            fido_log_debug("%s: torn record", __func__);
+            continue;
+        }
+        if (sign_count_index_set(store, record, count) != FIDO_OK) {
+            return FIDO_ERR_INVALID_ARGUMENT;
+        }
+    }
+    return FIDO_OK;
+}
+
+int fido_sign_count_store_init(fido_sign_count_store_t *store, const fido_sign_count_flash_t *flash, fido_sign_count_entry_t *entries, size_t max_count, uint16_t *slots, size_t slot_count) {
+    // At least one slot stays empty, so that lookups of unknown credentials terminate.
+    // A compaction has to fit all credentials into a page, with room for at least one more record.
+    if (flash->page_count < 2 || flash->page_size % FIDO_SIGN_COUNT_RECORD_SIZE != 0 ||
+        max_count > UINT16_MAX || slot_count <= max_count || (slot_count & (slot_count - 1)) != 0 ||
+        max_count >= (flash->page_size - FIDO_SIGN_COUNT_HEADER_SIZE) / FIDO_SIGN_COUNT_RECORD_SIZE) {
+        return FIDO_ERR_INVALID_ARGUMENT;
+    }
+
+    store->flash = flash;
+    store->entries = entries;
+    store->max_count = max_count;
+    store->count = 0;
+    store->slots = slots;
+    store->slot_mask = slot_count - 1;
+    memset(slots, 0, slot_count * sizeof(*slots));
+
+    // The active page is the valid one with the largest sequence number.
+    bool found = false;
+    for (size_t page = 0; page < flash->page_count; page++) {
+        uint32_t sequence;
+        const int r = sign_count_read_header(store, page, &sequence);
+        if (r == FIDO_ERR_INTERNAL) {
+            return r;
+        }
+        if (r == FIDO_OK && (!found || (int32_t)(sequence - store->sequence) > 0)) {
+            store->page = page;
+            store->sequence = sequence;
+            found = true;
+        }
+    }
+
+    if (!found) {
+        // Format the flash, compacting the empty index into the first page.
+        store->page = flash->page_count - 1;
+        store->sequence = 0;
+        return sign_count_compact(store);
+    }
+    return sign_count_load(store);
+}
+
+int fido_sign_count_store_update(fido_sign_count_store_t *store, const uint8_t *id, size_t id_len, uint32_t count) {
+    uint8_t hash[SHA256_DIGEST_SIZE];
+    uint8_t record[FIDO_SIGN_COUNT_RECORD_SIZE];
+
+    if (!FIDO_CRYPTO_IS_SET(sha256)) {
+        return FIDO_ERR_INTERNAL;
+    }
+    FIDO_TRACE_BEGIN(FIDO_TRACE_HASH, id_len);
+    FIDO_CRYPTO_CALL(sha256)(id, id_len, hash);
+    FIDO_TRACE_END(FIDO_TRACE_HASH, id_len);
+
+    const size_t slot = sign_count_slot(store, hash);
+    fido_sign_count_entry_t *entry = store->slots[slot] != 0 ? &store->entries[store->slots[slot] - 1] : NULL;
+    const uint32_t previous = entry != NULL ? entry->count : 0;
+
+    if (count == 0 && previous == 0) {
+        // The authenticator does not count signatures.
+        return FIDO_OK;
+    }
+    if (count <= previous) {
+        fido_log_debug("%s: count %lu <= %lu", __func__, (unsigned long)count, (unsigned long)previous);
+        return FIDO_ERR_SIGN_COUNT;
+    }
+
+    int r;
+    if ((r = sign_count_index_set(store, hash, count)) != FIDO_OK) {
+        return r;
+    }
+    entry = &store->entries[store->slots[slot] - 1];
+
+    if (store->write_offset + FIDO_SIGN_COUNT_RECORD_SIZE > store->flash->page_size) {
+        // The compaction writes the new counter as well.
+        r = sign_count_compact(store);
+    } else {
+        const fido_sign_count_flash_t *flash = store->flash;
+        sign_count_encode_record(record, entry);
+        const size_t address = store->page * flash->page_size + store->write_offset;
+        if (flash->write(flash->ctx, address, record, sizeof(record)) != 0) {
+            fido_log_debug("%s: write", __func__);
+            r = FIDO_ERR_INTERNAL;
+            // A failed write may have programmed part of the record, which is then skipped as torn.
+            // If it left the record erased, it is reused, as the log ends at the first erased record.
+            if (flash->read(flash->ctx, address, record, sizeof(record)) == 0 && sign_count_is_erased(record)) {
+                store->write_offset -= FIDO_SIGN_COUNT_RECORD_SIZE;
+            }
+        }
+        store->write_offset += FIDO_SIGN_COUNT_RECORD_SIZE;
+    }
+    if (r != FIDO_OK) {
+        // The index has to match the flash. A credential that was added last is kept with the old counter.
+        entry->count = previous;
+    }
+    return r;
+}
+
+int fido_sign_count_store_compact(fido_sign_count_store_t *store) {
+    return sign_count_compact(store);
+}
+
+size_t fido_sign_count_store_free(const fido_sign_count_store_t *store) {
+    return (store->flash->page_size - store->write_offset) / FIDO_SIGN_COUNT_RECORD_SIZE;
+}
+
+#ifndef FIDO_NO_ASSERT_VERIFY
+int fido_assert_verify_sign_count(const fido_assert_t *assert, const int cose_alg, const uint8_t *pk, fido_sign_count_store_t *store) {
+    int r;
+
+    // Only counters of authentic assertions are stored.
+    if ((r = fido_assert_verify(assert, cose_alg, pk)) != FIDO_OK) {
+        return r;
+    }
+    if (fido_assert_id_ptr(assert) == NULL) {
+        return FIDO_ERR_INVALID_ARGUMENT;
+    }
+    return fido_sign_count_store_update(store, fido_assert_id_ptr(assert), fido_assert_id_len(assert), assert->reply.auth_data.sign_count);
+}
+#endif
+
+#endif
@@ -0,0 +1,127 @@
+/*
+ * Copyright (c) 2022 Felix Gohla, Konrad Hanff, Tobias Kantusch,
+ *                    Quentin Kuth, Felix Roth. All rights reserved.
+ *
+ * Use of this source code is governed by a BSD-style
+ * license that can be found in the LICENSE file.
+ */
+
+#include "fido.h"
+
+#ifdef FIDO_TRACING
+
+#include <stdio.h>
+#include <string.h>
+
+static const char * const trace_names[FIDO_TRACE_ID_COUNT] = {
+    [FIDO_TRACE_TX]      = "tx",
+    [FIDO_TRACE_RX]      = "rx",
+    [FIDO_TRACE_APDU_TX] = "apdu_tx",
+    [FIDO_TRACE_APDU_RX] = "apdu_rx",
+    [FIDO_TRACE_CBOR]    = "cbor",
+    [FIDO_TRACE_HASH]    = "hash",
+    [FIDO_TRACE_AES_GCM] = "aes_gcm",
+    [FIDO_TRACE_INFLATE] = "inflate",
+    [FIDO_TRACE_VERIFY]  = "verify",
+};
+
+static fido_trace_clock_t trace_clock = NULL;
+static uint32_t trace_ticks_per_us = 1;
+
+// The ring buffer. trace_next counts all recorded events, the slot of an event is trace_next % FIDO_TRACE_BUFFER_SIZE.
+static fido_trace_event_t trace_events[FIDO_TRACE_BUFFER_SIZE];
+static size_t trace_next = 0;
+
+void fido_trace_set_clock(fido_trace_clock_t clock, uint32_t ticks_per_us) {
+    trace_clock = clock;
+    trace_ticks_per_us = ticks_per_us == 0 ? 1 : ticks_per_us;
+}
+
+void fido_trace_reset(void) {
+    trace_next = 0;
+}
+
+void fido_trace_record(uint8_t id, uint8_t phase, uint32_t arg) {
+    fido_trace_clock_t clock = trace_clock;
+    size_t slot;
+
+    if (clock == NULL) {
+        return;
+    }
+
+#ifdef FIDO_PARALLEL_LARGEBLOB
+    // Workers decrypting large-blob entries record concurrently.
+    slot = __atomic_fetch_add(&trace_next, 1, __ATOMIC_RELAXED);
+#else
+    slot = trace_next++;
+#endif
+    slot %= FIDO_TRACE_BUFFER_SIZE;
+
+    trace_events[slot].timestamp = clock();
+    trace_events[slot].arg = arg;
+    trace_events[slot].id = id;
+    trace_events[slot].phase = phase;
+}
+
+size_t fido_trace_count(void) {
+    return trace_next < FIDO_TRACE_BUFFER_SIZE ? trace_next : FIDO_TRACE_BUFFER_SIZE;
+}
+
+const fido_trace_event_t *fido_trace_get(size_t index) {
+    size_t count = fido_trace_count();
+
+    if (index >= count) {
+        return NULL;
+    }
+
+    return &trace_events[(trace_next - count + index) % FIDO_TRACE_BUFFER_SIZE];
+}
+
+const char *fido_trace_name(uint8_t id) {
+    if (id >= FIDO_TRACE_ID_COUNT) {
+        return "unknown";
+    }
+    return trace_names[id];
+}
+
+int fido_trace_export_chrome(fido_trace_write_t write, void *ctx) {
+    char line[160];
+    size_t count = fido_trace_count();
+    int len, r;
+
+    if (write == NULL) {
+        return FIDO_ERR_INVALID_ARGUMENT;
+    }
+
+    len = snprintf(line, sizeof(line), "{\"traceEvents\":[");
+    if ((r = write(line, (size_t)len, ctx)) != FIDO_OK) {
+        return r;
+    }
+
+    for (size_t i = 0; i < count; i++) {
+        const fido_trace_event_t *event = fido_trace_get(i);
+        // Timestamps are in microseconds, keep nanosecond precision for cycle counters.
+        uint64_t us = event->timestamp / trace_ticks_per_us;
+        uint64_t ns = (event->timestamp % trace_ticks_per_us) * 1000 / trace_ticks_per_us;
+
+        len = snprintf(line, sizeof(line),
+            "%s\n{\"name\":\"%s\",\"cat\":\"fido\",\"ph\":\"%c\",\"ts\":%llu.%03llu,\"pid\":0,\"tid\":0,\"args\":{\"arg\":%lu}}",
+            i == 0 ? "" : ",",
+            fido_trace_name(event->id),
+            event->phase,
+            (unsigned long long)us,
+            (unsigned long long)ns,
+            (unsigned long)event->arg);
+        if (len < 0 || (size_t)len >= sizeof(line)) {
+            return FIDO_ERR_INTERNAL;
+        }
+        if ((r = write(line, (size_t)len, ctx)) != FIDO_OK) {
+            return r;
+        }
+    }
+
+    len = snprintf(line, sizeof(line), "\n]}\n");
+    return write(line, (size_t)len, ctx);
+}
+
+#endif
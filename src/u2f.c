@@ -0,0 +1,168 @@
+/*
+ * Copyright (c) 2018-2022 Yubico AB. All rights reserved.
+ * Copyright (c) 2022 Felix Gohla, Konrad Hanff, Tobias Kantusch,
+ *                    Quentin Kuth, Felix Roth. All rights reserved.
+ *
+ * Use of this source code is governed by a BSD-style
+ * license that can be found in the LICENSE file.
+ */
+
+#include "fido.h"
+#include "iso7816.h"
+#include "u2f.h"
+#include <stddef.h>
+#include <string.h>
+
+#ifndef FIDO_NO_U2F
+
+// The authenticator data of U2F: application parameter, user presence flags and counter.
+#define U2F_AUTH_DATA_LENGTH (ASSERTION_AUTH_DATA_RPID_HASH_LEN + 1 + 4)
+
+// User presence flags + counter + signature + status word.
+#define U2F_AUTH_RESPONSE_MAX_LENGTH (1 + 4 + U2F_MAX_SIGNATURE_LENGTH + 2)
+
+/**
+ * The U2F authenticate request, sent as APDU without the length fields, which the transport adds.
+ * Only the first key_handle_len bytes of key_handle are sent.
+ */
+typedef struct __attribute__((packed)) u2f_auth_request {
+    iso7816_header_t header;
+    uint8_t          challenge[ASSERTION_CLIENT_DATA_HASH_LEN];
+    uint8_t          application[ASSERTION_AUTH_DATA_RPID_HASH_LEN];
+    uint8_t          key_handle_len;
+    uint8_t          key_handle[ASSERTION_MAX_KEY_HANDLE_LENGTH];
+} u2f_auth_request_t;
+
+/**
+ * @brief Transmit the U2F authenticate request.
+ *
+ * @param dev The device to communicate to.
+ * @param assert The assertion request data. The application parameter is taken from its reply.
+ * @return int FIDO_OK if the operation was successful.
+ */
+static int u2f_authenticate_tx(fido_dev_t *dev, const fido_assert_t *assert) {
+    u2f_auth_request_t request;
+    int ret;
+
+    request.header.cla = 0;
+    request.header.ins = U2F_CMD_AUTH;
+    request.header.p1 = (assert->opt & FIDO_ASSERT_OPTION_UP) ? U2F_AUTH_SIGN : U2F_AUTH_DONT_ENFORCE;
+    request.header.p2 = 0;
+    memcpy(request.challenge, assert->cdh, sizeof(request.challenge));
+    memcpy(request.application, assert->reply.auth_data.rp_id_hash, sizeof(request.application));
+    request.key_handle_len = (uint8_t)assert->allow_cred.len;
+    memcpy(request.key_handle, assert->allow_cred.ptr, assert->allow_cred.len);
+
+    if (fido_tx(dev, CTAP_CMD_MSG, &request, offsetof(u2f_auth_request_t, key_handle) + assert->allow_cred.len) != FIDO_OK) {
+        fido_log_debug("%s: fido_tx", __func__);
+        ret = FIDO_ERR_TX;
+    } else {
+        ret = FIDO_OK;
+    }
+
+    memset(&request, 0, sizeof(request));
+    return ret;
+}
+
+/**
+ * @brief Receive the U2F authenticate response and store it in the reply of the assertion.
+ *
+ * @param dev The device to communicate to.
+ * @param assert The assertion request data.
+ * @return int FIDO_OK if the operation was successful.
+ */
+static int u2f_authenticate_rx(fido_dev_t *dev, fido_assert_t *assert) {
+    fido_assert_reply_t *reply = &assert->reply;
+    uint8_t msg[U2F_AUTH_RESPONSE_MAX_LENGTH];
+    int msglen;
+    int ret;
+
+    if ((msglen = fido_rx(dev, CTAP_CMD_MSG, msg, sizeof(msg))) < 2) {
+        fido_log_debug("%s: fido_rx", __func__);
+        ret = FIDO_ERR_RX;
+        goto out;
+    }
+
+    switch (msg[msglen - 2] << 8 | msg[msglen - 1]) {
+        case SW_NO_ERROR:
+            break;
+        case SW_CONDITIONS_NOT_SATISFIED:
+            ret = FIDO_ERR_USER_PRESENCE_REQUIRED;
+            goto out;
+        case SW_WRONG_DATA:
+            ret = FIDO_ERR_NO_CREDENTIALS;
+            goto out;
+        default:
+            fido_log_debug("%s: sw", __func__);
+            ret = FIDO_ERR_RX;
+            goto out;
+    }
+    msglen -= 2;
+
+    if (msglen < 1 + 4) {
+        fido_log_debug("%s: msglen=%d", __func__, msglen);
+        ret = FIDO_ERR_RX;
+        goto out;
+    }
+
+    // The signed data is application parameter, flags, counter and challenge,
+    // i.e. the authenticator data of CTAP2 followed by the client data hash.
+    memcpy(reply->auth_data_raw + ASSERTION_AUTH_DATA_RPID_HASH_LEN, msg, 1 + 4);
+    reply->auth_data_length = U2F_AUTH_DATA_LENGTH;
+    reply->auth_data.flags = msg[0];
+    reply->auth_data.sign_count = (uint32_t)msg[1] << 24 | (uint32_t)msg[2] << 16 | (uint32_t)msg[3] << 8 | msg[4];
+
+    // The signature is kept DER encoded, like the ES256 signatures of CTAP2.
+    if (msglen - 1 - 4 > (int)sizeof(reply->signature)) {
+        fido_log_debug("%s: msglen=%d", __func__, msglen);
+        ret = FIDO_ERR_RX;
+        goto out;
+    }
+    memcpy(reply->signature, msg + 1 + 4, msglen - 1 - 4);
+    reply->signature_length = msglen - 1 - 4;
+
+    memcpy(reply->credential.id, assert->allow_cred.ptr, assert->allow_cred.len);
+    reply->credential.id_length = (uint8_t)assert->allow_cred.len;
+    reply->credential.type = FIDO_CREDENTIAL_TYPE_PUBLIC_KEY;
+
+    ret = FIDO_OK;
+out:
+    memset(msg, 0, sizeof(msg));
+    return ret;
+}
+
+int fido_dev_u2f_authenticate(fido_dev_t *dev, fido_assert_t *assert) {
+    int r;
+
+    if (assert->rp_id.ptr == NULL || assert->allow_cred.ptr == NULL) {
+        fido_log_debug("%s: rp_id=%p, allow_cred=%p", __func__,
+            (void *)assert->rp_id.ptr, (void *)assert->allow_cred.ptr);
+        return FIDO_ERR_INVALID_ARGUMENT;
+    }
+
+    if ((assert->opt & FIDO_ASSERT_OPTION_UV) || assert->ext != 0) {
+        fido_log_debug("%s: opt=%02x, ext=%02x", __func__, assert->opt, assert->ext);
+        return FIDO_ERR_UNSUPPORTED_OPTION;
+    }
+
+    if (!FIDO_CRYPTO_IS_SET(sha256)) {
+        return FIDO_ERR_INTERNAL;
+    }
+
+    memset(&assert->reply, 0, sizeof(assert->reply));
+
+    // The application parameter, which also starts the authenticator data.
+    FIDO_TRACE_BEGIN(FIDO_TRACE_HASH, assert->rp_id.len);
+    FIDO_CRYPTO_CALL(sha256)(assert->rp_id.ptr, assert->rp_id.len, assert->reply.auth_data.rp_id_hash);
+    FIDO_TRACE_END(FIDO_TRACE_HASH, assert->rp_id.len);
+    memcpy(assert->reply.auth_data_raw, assert->reply.auth_data.rp_id_hash, ASSERTION_AUTH_DATA_RPID_HASH_LEN);
+
+    if ((r = u2f_authenticate_tx(dev, assert)) != FIDO_OK ||
+        (r = u2f_authenticate_rx(dev, assert)) != FIDO_OK) {
+        return r;
+    }
+
+    return FIDO_OK;
+}
+
+#endif
@@ -0,0 +1,149 @@
+/*
+ * Copyright (c) 2022 Felix Gohla, Konrad Hanff, Tobias Kantusch,
+ *                    Quentin Kuth, Felix Roth. All rights reserved.
+ *
+ * Use of this source code is governed by a BSD-style
+ * license that can be found in the LICENSE file.
+ */
+
+#include "fido.h"
+
+#include <string.h>
+
+#ifndef FIDO_NO_VERIFY_CACHE
+
+// Bits of fido_verify_cache_table_t.state.
+#define VERIFY_CACHE_VALID(way) BITFIELD(way)
+#define VERIFY_CACHE_VICTIM     BITFIELD(FIDO_VERIFY_CACHE_WAYS) // set if way 1 is replaced next
+
+// The public key and the signature, followed by the message, are hashed into the tag.
+#define VERIFY_CACHE_KEY_LENGTH 32
+#define VERIFY_CACHE_SIGNATURE_LENGTH 64
+
+void fido_verify_cache_init(fido_verify_cache_t *cache, fido_verify_cache_load_t load, fido_verify_cache_save_t save, void *ctx) {
+    cache->save = save;
+    cache->ctx = ctx;
+    if (load == NULL || load(&cache->table, ctx) != 0) {
+        memset(&cache->table, 0, sizeof(cache->table));
+    }
+}
+
+void fido_verify_cache_clear(fido_verify_cache_t *cache) {
+    memset(&cache->table, 0, sizeof(cache->table));
+    if (cache->save != NULL) {
+        cache->save(&cache->table, cache->ctx);
+    }
+}
+
+void fido_dev_set_verify_cache(fido_dev_t *dev, fido_verify_cache_t *cache) {
+    dev->verify_cache = cache;
+}
+
+/**
+ * @brief Compute the tag and the set of a signature.
+ *
+ * @param signature The signature (64 bytes).
+ * @param public_key The public key (32 bytes).
+ * @param message The signed message.
+ * @param message_len The length of the message.
+ * @param tag The buffer to write the tag to.
+ * @return size_t The index of the set.
+ */
+static size_t verify_cache_tag(const uint8_t *signature, const uint8_t *public_key, const uint8_t *message, size_t message_len, uint8_t tag[FIDO_VERIFY_CACHE_TAG_SIZE]) {
+    fido_sha256_ctx_t ctx;
+    uint8_t hash[SHA256_DIGEST_SIZE];
+
+    // The pieces are hashed one after another, the message may be too large to copy onto the stack.
+    FIDO_TRACE_BEGIN(FIDO_TRACE_HASH, VERIFY_CACHE_KEY_LENGTH + VERIFY_CACHE_SIGNATURE_LENGTH + message_len);
+    FIDO_CRYPTO_CALL(sha256_init)(&ctx);
+    FIDO_CRYPTO_CALL(sha256_update)(&ctx, public_key, VERIFY_CACHE_KEY_LENGTH);
+    FIDO_CRYPTO_CALL(sha256_update)(&ctx, signature, VERIFY_CACHE_SIGNATURE_LENGTH);
+    FIDO_CRYPTO_CALL(sha256_update)(&ctx, message, message_len);
+    FIDO_CRYPTO_CALL(sha256_final)(&ctx, hash);
+    FIDO_TRACE_END(FIDO_TRACE_HASH, VERIFY_CACHE_KEY_LENGTH + VERIFY_CACHE_SIGNATURE_LENGTH + message_len);
+
+    // The tag and the index of the set are taken from different bytes of the hash.
+    memcpy(tag, hash, FIDO_VERIFY_CACHE_TAG_SIZE);
+    return ((size_t)hash[FIDO_VERIFY_CACHE_TAG_SIZE] << 8 | hash[FIDO_VERIFY_CACHE_TAG_SIZE + 1]) % FIDO_VERIFY_CACHE_SETS;
+}
+
+/**
+ * @brief Look up a tag in its set and mark the way it was found in as recently used.
+ *
+ * @param table The table to search.
+ * @param set The index of the set.
+ * @param tag The tag to look up.
+ * @return bool true if the tag is in the set.
+ */
+static bool verify_cache_lookup(fido_verify_cache_table_t *table, size_t set, const uint8_t tag[FIDO_VERIFY_CACHE_TAG_SIZE]) {
+    uint8_t *state = &table->state[set];
+    for (uint8_t way = 0; way < FIDO_VERIFY_CACHE_WAYS; way++) {
+        if ((*state & VERIFY_CACHE_VALID(way)) && memcmp(table->tags[set][way], tag, FIDO_VERIFY_CACHE_TAG_SIZE) == 0) {
+            // The other way is replaced next.
+            *state = way == 0 ? (*state | VERIFY_CACHE_VICTIM) : (*state & ~VERIFY_CACHE_VICTIM);
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief Insert a tag into its set, into an empty way or else the least recently used one.
+ *
+ * @param table The table to insert into.
+ * @param set The index of the set.
+ * @param tag The tag to insert.
+ */
+static void verify_cache_insert(fido_verify_cache_table_t *table, size_t set, const uint8_t tag[FIDO_VERIFY_CACHE_TAG_SIZE]) {
+    uint8_t *state = &table->state[set];
+    uint8_t way;
+    if (!(*state & VERIFY_CACHE_VALID(0))) {
+        way = 0;
+    } else if (!(*state & VERIFY_CACHE_VALID(1))) {
+        way = 1;
+    } else {
+        way = (*state & VERIFY_CACHE_VICTIM) ? 1 : 0;
+    }
+    memcpy(table->tags[set][way], tag, FIDO_VERIFY_CACHE_TAG_SIZE);
+    *state |= VERIFY_CACHE_VALID(way);
+    *state = way == 0 ? (*state | VERIFY_CACHE_VICTIM) : (*state & ~VERIFY_CACHE_VICTIM);
+}
+
+#endif
+
+int fido_dev_ed25519_verify(fido_dev_t *dev, const uint8_t *signature, const uint8_t *public_key, const uint8_t *message, size_t message_len) {
+    if (!FIDO_CRYPTO_IS_SET(ed25519_verify)) {
+        return -1;
+    }
+
+#ifndef FIDO_NO_VERIFY_CACHE
+    fido_verify_cache_t *cache = dev->verify_cache;
+    uint8_t tag[FIDO_VERIFY_CACHE_TAG_SIZE];
+    size_t set = 0;
+
+    if (cache != NULL && FIDO_CRYPTO_IS_SET(sha256_stream)) {
+        set = verify_cache_tag(signature, public_key, message, message_len, tag);
+        if (verify_cache_lookup(&cache->table, set, tag)) {
+            FIDO_STATS_INC(dev, cache_hits);
+            return 0;
+        }
+        FIDO_STATS_INC(dev, cache_misses);
+    } else {
+        cache = NULL;
+    }
+#endif
+
+    FIDO_TRACE_BEGIN(FIDO_TRACE_VERIFY, COSE_ALGORITHM_EdDSA);
+    int r = FIDO_CRYPTO_CALL(ed25519_verify)(signature, public_key, message, message_len);
+    FIDO_TRACE_END(FIDO_TRACE_VERIFY, COSE_ALGORITHM_EdDSA);
+
+#ifndef FIDO_NO_VERIFY_CACHE
+    if (r == 0 && cache != NULL) {
+        verify_cache_insert(&cache->table, set, tag);
+        if (cache->save != NULL) {
+            cache->save(&cache->table, cache->ctx);
+        }
+    }
+#endif
+    return r;
+}
@@ -0,0 +1,145 @@
+/*
+ * Copyright (c) 2022 Felix Gohla, Konrad Hanff, Tobias Kantusch,
+ *                    Quentin Kuth, Felix Roth. All rights reserved.
+ *
+ * Use of this source code is governed by a BSD-style
+ * license that can be found in the LICENSE file.
+ */
+
+/**
+ * Tests of the store of signature counters against torn records, on a simulated NOR flash in RAM.
+ */
+
+#include <fido.h>
+
+#include <stdio.h>
+#include <string.h>
+
+#define TEST_PAGE_SIZE   512
+#define TEST_PAGE_COUNT  2
+#define TEST_CREDENTIALS 4
+
+typedef struct test_flash {
+    uint8_t pages[TEST_PAGE_COUNT * TEST_PAGE_SIZE];
+    // The number of bytes the next write programs before it fails, or SIZE_MAX if it succeeds.
+    size_t tear_after;
+} test_flash_t;
+
+static int test_flash_read(void *ctx, size_t address, uint8_t *data, size_t len) {
+    memcpy(data, ((test_flash_t *)ctx)->pages + address, len);
+    return 0;
+}
+
+static int test_flash_write(void *ctx, size_t address, const uint8_t *data, size_t len) {
+    test_flash_t *flash = (test_flash_t *)ctx;
+    const size_t programmed = flash->tear_after < len ? flash->tear_after : len;
+    // NOR flash only clears bits.
+    for (size_t i = 0; i < programmed; i++) {
+        flash->pages[address + i] &= data[i];
+    }
+    if (flash->tear_after != SIZE_MAX) {
+        flash->tear_after = SIZE_MAX;
+        return -1;
+    }
+    return 0;
+}
+
+static int test_flash_erase(void *ctx, size_t address) {
+    memset(((test_flash_t *)ctx)->pages + address, 0xff, TEST_PAGE_SIZE);
+    return 0;
+}
+
+static test_flash_t flash_memory;
+static const fido_sign_count_flash_t flash = {
+    test_flash_read, test_flash_write, test_flash_erase, &flash_memory, TEST_PAGE_SIZE, TEST_PAGE_COUNT
+};
+static fido_sign_count_entry_t entries[TEST_CREDENTIALS];
+static uint16_t slots[2 * TEST_CREDENTIALS];
+
+static const uint8_t credential_a[] = "credential a";
+static const uint8_t credential_b[] = "credential b";
+
+static int failures = 0;
+
+#define TEST_EXPECT(expression, expected) do { \
+        const int _r = (expression); \
+        if (_r != (expected)) { \
+            fprintf(stderr, "%s:%d: %s returned %d, expected %d\n", __FILE__, __LINE__, #expression, _r, (expected)); \
+            failures++; \
+        } \
+    } while (0)
+
+static int test_update(fido_sign_count_store_t *store, const uint8_t *id, uint32_t count) {
+    return fido_sign_count_store_update(store, id, sizeof(credential_a) - 1, count);
+}
+
+static int test_reload(fido_sign_count_store_t *store) {
+    return fido_sign_count_store_init(store, &flash, entries, TEST_CREDENTIALS, slots, 2 * TEST_CREDENTIALS);
+}
+
+/**
+ * @brief A record torn in the middle of the log is skipped, the records after it are loaded
+ *        and new records are appended after the last one.
+ */
+static void test_torn_record_in_the_middle(void) {
+    fido_sign_count_store_t store;
+
+    memset(flash_memory.pages, 0xff, sizeof(flash_memory.pages));
+    flash_memory.tear_after = SIZE_MAX;
+    TEST_EXPECT(test_reload(&store), FIDO_OK);
+
+    TEST_EXPECT(test_update(&store, credential_a, 1), FIDO_OK);
+    TEST_EXPECT(test_update(&store, credential_b, 1), FIDO_OK);
+    // The write of this record fails after its hash and part of its counter.
+    flash_memory.tear_after = 10;
+    TEST_EXPECT(test_update(&store, credential_b, 5), FIDO_ERR_INTERNAL);
+    TEST_EXPECT(test_update(&store, credential_a, 6), FIDO_OK);
+    TEST_EXPECT(test_update(&store, credential_b, 2), FIDO_OK);
+    const size_t free_records = fido_sign_count_store_free(&store);
+
+    TEST_EXPECT(test_reload(&store), FIDO_OK);
+    TEST_EXPECT((int)fido_sign_count_store_free(&store), (int)free_records);
+    // The counters after the torn record are not rolled back.
+    TEST_EXPECT(test_update(&store, credential_a, 6), FIDO_ERR_SIGN_COUNT);
+    TEST_EXPECT(test_update(&store, credential_b, 2), FIDO_ERR_SIGN_COUNT);
+    TEST_EXPECT(test_update(&store, credential_a, 7), FIDO_OK);
+    TEST_EXPECT((int)fido_sign_count_store_free(&store), (int)free_records - 1);
+
+    // The new record did not overwrite an old one.
+    TEST_EXPECT(test_reload(&store), FIDO_OK);
+    TEST_EXPECT(test_update(&store, credential_a, 7), FIDO_ERR_SIGN_COUNT);
+    TEST_EXPECT(test_update(&store, credential_b, 2), FIDO_ERR_SIGN_COUNT);
+    TEST_EXPECT(test_update(&store, credential_b, 3), FIDO_OK);
+}
+
+/**
+ * @brief A failed write that left the record erased does not leave a gap, which would end the log.
+ */
+static void test_failed_write_without_data(void) {
+    fido_sign_count_store_t store;
+
+    memset(flash_memory.pages, 0xff, sizeof(flash_memory.pages));
+    flash_memory.tear_after = SIZE_MAX;
+    TEST_EXPECT(test_reload(&store), FIDO_OK);
+
+    TEST_EXPECT(test_update(&store, credential_a, 1), FIDO_OK);
+    const size_t free_records = fido_sign_count_store_free(&store);
+    flash_memory.tear_after = 0;
+    TEST_EXPECT(test_update(&store, credential_a, 2), FIDO_ERR_INTERNAL);
+    TEST_EXPECT((int)fido_sign_count_store_free(&store), (int)free_records);
+    TEST_EXPECT(test_update(&store, credential_a, 3), FIDO_OK);
+
+    TEST_EXPECT(test_reload(&store), FIDO_OK);
+    TEST_EXPECT(test_update(&store, credential_a, 3), FIDO_ERR_SIGN_COUNT);
+    TEST_EXPECT(test_update(&store, credential_a, 4), FIDO_OK);
+}
+
+int main(void) {
+    test_torn_record_in_the_middle();
+    test_failed_write_without_data();
+    if (failures != 0) {
+        fprintf(stderr, "%d checks failed\n", failures);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,114 @@
+#!/bin/env python
+#
+# Builds the image of a credential store, see include/cred_store.h.
+#
+# The input is a JSON list of the enrolled credentials, with the binary fields in hex:
+#
+#   [{"id": "<credential ID>", "alg": -8, "public_key": "<32 bytes for EdDSA, 64 (x | y) for ES256>", "metadata": "<optional>"}]
+#
+# The metadata of every record is padded with zeros to the longest one or to --metadata-size.
+#
+# Usage: python tools/build_cred_store.py credentials.json -o cred_store.bin
+#        python tools/build_cred_store.py credentials.json --c-array cred_store -o cred_store.c
+
+import argparse
+import hashlib
+import json
+import struct
+import sys
+
+from image_c_array import c_array
+
+MAGIC = b'FCS1'
+ID_HASH_SIZE = 16
+PUBLIC_KEY_SIZE = 64
+SLOT_SIZE = 2
+MAX_RECORDS = 0xffff
+
+COSE_ALGORITHM_EdDSA = -8
+COSE_ALGORITHM_ES256 = -7
+PUBLIC_KEY_LENGTHS = {COSE_ALGORITHM_EdDSA: 32, COSE_ALGORITHM_ES256: 64}
+
+
+def parse_credential(credential):
+    credential_id = bytes.fromhex(credential['id'])
+    alg = int(credential['alg'])
+    public_key = bytes.fromhex(credential['public_key'])
+    metadata = bytes.fromhex(credential.get('metadata', ''))
+    if not credential_id:
+        raise ValueError('empty credential ID')
+    if alg not in PUBLIC_KEY_LENGTHS:
+        raise ValueError(f'unsupported algorithm {alg} of credential {credential["id"]}')
+    if len(public_key) != PUBLIC_KEY_LENGTHS[alg]:
+        raise ValueError(f'public key of credential {credential["id"]} has {len(public_key)} bytes')
+    return hashlib.sha256(credential_id).digest(), alg, public_key, metadata
+
+
+def slot_count_for(record_count, load_factor):
+    # A power of two with at least one empty slot, so that lookups of unknown IDs terminate.
+    slot_count = 1
+    while slot_count <= record_count or record_count > slot_count * load_factor:
+        slot_count *= 2
+    return slot_count
+
+
+def build(credentials, metadata_size, load_factor):
+    records = [parse_credential(credential) for credential in credentials]
+    if len(records) > MAX_RECORDS:
+        raise ValueError(f'at most {MAX_RECORDS} credentials are supported')
+    longest = max((len(metadata) for _, _, _, metadata in records), default=0)
+    if metadata_size is None:
+        metadata_size = longest
+    elif longest > metadata_size:
+        raise ValueError(f'metadata of {longest} bytes exceeds --metadata-size {metadata_size}')
+
+    # Truncated hashes must be unique, as the library compares only those.
+    hashes = set()
+    for digest, _, _, _ in records:
+        if digest[:ID_HASH_SIZE] in hashes:
+            raise ValueError('duplicate credential ID')
+        hashes.add(digest[:ID_HASH_SIZE])
+
+    slot_count = slot_count_for(len(records), load_factor)
+    slots = [0] * slot_count
+    for index, (digest, _, _, _) in enumerate(records):
+        slot = struct.unpack('<I', digest[:4])[0] & (slot_count - 1)
+        while slots[slot] != 0:
+            slot = (slot + 1) & (slot_count - 1)
+        slots[slot] = index + 1
+
+    image = bytearray(MAGIC)
+    image += struct.pack('<III', slot_count, len(records), metadata_size)
+    image += struct.pack(f'<{slot_count}H', *slots)
+    for digest, alg, public_key, metadata in records:
+        image += digest[:ID_HASH_SIZE]
+        image += struct.pack('<hxx', alg)
+        image += public_key.ljust(PUBLIC_KEY_SIZE, b'\0')
+        image += metadata.ljust(metadata_size, b'\0')
+    return bytes(image)
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Build the image of a credential store.')
+    parser.add_argument('credentials', help='JSON list of credentials, - for stdin')
+    parser.add_argument('-o', '--output', required=True, help='file to write the image to')
+    parser.add_argument('--c-array', metavar='NAME', help='write a C source defining the image as NAME and NAME_len instead of a binary')
+    parser.add_argument('--metadata-size', type=int, help='size of the metadata of each record, defaults to the longest metadata')
+    parser.add_argument('--load-factor', type=float, default=0.5, help='maximum ratio of records to slots (default 0.5)')
+    args = parser.parse_args()
+
+    with (sys.stdin if args.credentials == '-' else open(args.credentials)) as f:
+        credentials = json.load(f)
+    image = build(credentials, args.metadata_size, args.load_factor)
+
+    if args.c_array:
+        with open(args.output, 'w') as f:
+            f.write(c_array(args.c_array, image, 'build_cred_store.py'))
+    else:
+        with open(args.output, 'wb') as f:
+            f.write(image)
+    print(f'{len(credentials)} credentials, {len(image)} bytes', file=sys.stderr)
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,107 @@
+#!/bin/env python
+#
+# Builds and signs the image of a list of revoked credential public keys, see include/revocation.h.
+#
+# The input lists the revoked Ed25519 public keys in hex, one per line. The image is signed with
+# the Ed25519 private key of the updater (32 bytes in hex), whose public key the doors trust.
+# Each new list needs a larger --version, so that doors can reject older lists.
+#
+# Usage: python tools/build_revocation.py revoked.txt --version 2 --key updater_key.hex -o revocation.bin
+#        python tools/build_revocation.py revoked.txt --version 2 --key updater_key.hex --c-array revocation -o revocation.c
+
+import argparse
+import hashlib
+import os
+import struct
+import sys
+
+from cryptography.hazmat.primitives.asymmetric import ed25519
+
+from image_c_array import c_array
+
+MAGIC = b'FRV1'
+BLOCK_SIZE = 64
+BLOCK_BITS = BLOCK_SIZE * 8
+KEY_SIZE = 32
+SALT_SIZE = 12
+MAX_HASHES = 14
+
+
+def positions(salt, key, block_count, hash_count):
+    """Return the block and the bits in it that a key sets, as src/revocation.c computes them."""
+    digest = hashlib.sha256(salt + key).digest()
+    block = struct.unpack('<I', digest[:4])[0] & (block_count - 1)
+    bits = [struct.unpack('<H', digest[4 + 2 * i:6 + 2 * i])[0] % BLOCK_BITS for i in range(hash_count)]
+    return block, bits
+
+
+def block_count_for(key_count, bits_per_key):
+    block_count = 1
+    while block_count * BLOCK_BITS < key_count * bits_per_key:
+        block_count *= 2
+    return block_count
+
+
+def build(keys, version, bits_per_key, hash_count, private_key):
+    keys = sorted(set(keys))
+    salt = os.urandom(SALT_SIZE)
+    block_count = block_count_for(len(keys), bits_per_key)
+    blocks = bytearray(block_count * BLOCK_SIZE)
+    for key in keys:
+        block, bits = positions(salt, key, block_count, hash_count)
+        for bit in bits:
+            blocks[block * BLOCK_SIZE + bit // 8] |= 1 << (bit % 8)
+
+    image = bytearray(MAGIC)
+    image += struct.pack('<IIIB3x', version, len(keys), block_count, hash_count)
+    image += salt
+    image += blocks
+    for key in keys:
+        image += key
+    image += private_key.sign(bytes(image))
+    return bytes(image)
+
+
+def read_keys(path):
+    keys = []
+    with (sys.stdin if path == '-' else open(path)) as f:
+        for line in f:
+            line = line.strip()
+            if not line or line.startswith('#'):
+                continue
+            key = bytes.fromhex(line)
+            if len(key) != KEY_SIZE:
+                raise ValueError(f'public key {line} has {len(key)} bytes')
+            keys.append(key)
+    return keys
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Build and sign a list of revoked credential public keys.')
+    parser.add_argument('keys', help='file with one revoked public key in hex per line, - for stdin')
+    parser.add_argument('-o', '--output', required=True, help='file to write the image to')
+    parser.add_argument('--version', type=int, required=True, help='version of the list, larger than the one of the previous list')
+    parser.add_argument('--key', required=True, help='file with the Ed25519 private key of the updater in hex')
+    parser.add_argument('--c-array', metavar='NAME', help='write a C source defining the image as NAME and NAME_len instead of a binary')
+    parser.add_argument('--bits-per-key', type=int, default=16, help='size of the filter per key (default 16)')
+    parser.add_argument('--hashes', type=int, default=8, help=f'bits set per key, at most {MAX_HASHES} (default 8)')
+    args = parser.parse_args()
+
+    if not 1 <= args.hashes <= MAX_HASHES:
+        parser.error(f'--hashes must be between 1 and {MAX_HASHES}')
+    with open(args.key) as f:
+        private_key = ed25519.Ed25519PrivateKey.from_private_bytes(bytes.fromhex(f.read().strip()))
+    keys = read_keys(args.keys)
+    image = build(keys, args.version, args.bits_per_key, args.hashes, private_key)
+
+    if args.c_array:
+        with open(args.output, 'w') as f:
+            f.write(c_array(args.c_array, image, 'build_revocation.py'))
+    else:
+        with open(args.output, 'wb') as f:
+            f.write(image)
+    print(f'{len(set(keys))} keys, {len(image)} bytes', file=sys.stderr)
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,96 @@
+#!/bin/env python
+#
+# Generates include/inflate_tables.h, the decoding tables of the fixed Huffman codes of DEFLATE (RFC 1951, 3.2.6).
+# The layout has to match the one that src/inflate.c builds at runtime for dynamic codes.
+#
+# Usage: python tools/gen_inflate_tables.py > include/inflate_tables.h
+
+MAX_BITS = 15
+LITLEN_ROOT_BITS = 9
+DIST_ROOT_BITS = 6
+
+ENTRY_SYMBOL = 0
+ENTRY_INVALID = 2
+
+
+def fixed_lengths():
+    litlen = [8] * 144 + [9] * (256 - 144) + [7] * (280 - 256) + [8] * (288 - 280)
+    dist = [5] * 30
+    return litlen, dist
+
+
+def canonical(lengths):
+    """Return the number of codes per length and the symbols ordered by code."""
+    counts = [0] * (MAX_BITS + 1)
+    for length in lengths:
+        counts[length] += 1
+    counts[0] = 0
+    symbols = [symbol for length in range(1, MAX_BITS + 1) for symbol, l in enumerate(lengths) if l == length]
+    return counts, symbols
+
+
+def entry(type, bits, value):
+    return (value << 6) | (type << 4) | bits
+
+
+def reverse(code, length):
+    return int(format(code, f'0{length}b')[::-1], 2)
+
+
+def table(lengths, root_bits):
+    """Single level lookup table, the fixed codes are never longer than the root bits."""
+    counts, symbols = canonical(lengths)
+    assert max(lengths) <= root_bits
+    entries = [entry(ENTRY_INVALID, 0, 0)] * (1 << root_bits)
+    code = 0
+    index = 0
+    for length in range(1, MAX_BITS + 1):
+        for _ in range(counts[length]):
+            for fill in range(reverse(code, length), 1 << root_bits, 1 << length):
+                entries[fill] = entry(ENTRY_SYMBOL, length, symbols[index])
+            code += 1
+            index += 1
+        code <<= 1
+    return entries
+
+
+def c_array(name, values, per_line=16):
+    lines = []
+    for i in range(0, len(values), per_line):
+        lines.append('    ' + ', '.join(str(v) for v in values[i:i + per_line]) + ',')
+    return f'static const uint16_t {name}[{len(values)}] PROGMEM_MARKER = {{\n' + '\n'.join(lines) + '\n};\n'
+
+
+def main():
+    litlen, dist = fixed_lengths()
+    litlen_counts, litlen_symbols = canonical(litlen)
+    dist_counts, dist_symbols = canonical(dist)
+
+    print('''/*
+ * Copyright (c) 2022 Felix Gohla, Konrad Hanff, Tobias Kantusch,
+ *                    Quentin Kuth, Felix Roth. All rights reserved.
+ *
+ * Use of this source code is governed by a BSD-style
+ * license that can be found in the LICENSE file.
+ */
+
+// Generated by tools/gen_inflate_tables.py, do not edit.
+// Decoding tables of the fixed Huffman codes, only to be included by src/inflate.c.
+
+#pragma once
+
+#include "utils.h"
+#include <stdint.h>
+''')
+    print(c_array('inflate_fixed_litlen_counts', litlen_counts))
+    print(c_array('inflate_fixed_litlen_symbols', litlen_symbols))
+    print(c_array('inflate_fixed_dist_counts', dist_counts))
+    print(c_array('inflate_fixed_dist_symbols', dist_symbols))
+    print('#ifdef FIDO_FAST_INFLATE')
+    print(c_array('inflate_fixed_litlen_table', table(litlen, LITLEN_ROOT_BITS)))
+    print(c_array('inflate_fixed_dist_table', table(dist, DIST_ROOT_BITS)), end='')
+    print('#endif')
+
+
+if __name__ == '__main__':
+    main()
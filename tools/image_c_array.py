@@ -0,0 +1,22 @@
+#!/bin/env python
+#
+# Writes an image, e.g. of tools/build_cred_store.py or tools/build_revocation.py, as a C source,
+# which keeps it in program memory on the AVR.
+
+
+def c_array(name, image, generator, per_line=16):
+    """Return a C source defining the image as NAME and its length as NAME_len."""
+    lines = []
+    for i in range(0, len(image), per_line):
+        lines.append('    ' + ', '.join(f'0x{b:02x}' for b in image[i:i + per_line]) + ',')
+    return f'''// Generated by tools/{generator}, do not edit.
+
+#include "utils.h"
+#include <stddef.h>
+#include <stdint.h>
+
+const uint8_t {name}[{len(image)}] PROGMEM_MARKER = {{
+''' + '\n'.join(lines) + f'''
+}};
+const size_t {name}_len = {len(image)};
+'''